@@ -54,6 +54,11 @@ enum class DestinationType : int {
 
 typedef std::function<void(std::string)> ResponseFunctor;
 
+// Decides whether two responses to a group request agree with each other, for the quorum form of
+// Routing::SendGroup.
+typedef std::function<bool(const std::string& /*lhs*/,
+                           const std::string& /*rhs*/)> ResponseMatchFunctor;
+
 // They are passed as a parameter by MessageReceivedFunctor and should be called for responding to
 // the received message. Passing an empty message will mean you don't want to reply.
 typedef std::function<void(const std::string& /*message*/)> ReplyFunctor;
@@ -83,6 +88,10 @@ typedef std::function<void(std::shared_ptr<CloseNodesChange> /*close_nodes_chang
 // This functor fires when a clinet close node is inserted or removed from clinet routing table.
 using ClientNodesChangeFunctor = std::function<void(std::shared_ptr<ClientNodesChange>)>;
 
+// This functor fires when a send may succeed again after one was refused with
+// CommonErrors::cannot_exceed_limit, i.e. once enough earlier messages have been acked.
+typedef std::function<void()> SendReadyFunctor;
+
 template <typename T>
 struct MessageAndCachingFunctorsType {
   std::function<void(const T& /*message*/)> message_received;
@@ -120,7 +129,8 @@ struct Functors {
         network_status(),
         close_nodes_change(),
         set_public_key(),
-        request_public_key() {}
+        request_public_key(),
+        send_ready() {}
 
   MessageAndCachingFunctors message_and_caching;
   TypedMessageAndCachingFunctor typed_message_and_caching;
@@ -129,6 +139,7 @@ struct Functors {
   ClientNodesChangeFunctor client_nodes_change;
   GivePublicKeyFunctor set_public_key;
   RequestPublicKeyFunctor request_public_key;
+  SendReadyFunctor send_ready;
 };
 
 }  // namespace routing
@@ -28,6 +28,8 @@
 #include "maidsafe/common/node_id.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/routing/routing_config.h"
+
 namespace maidsafe {
 
 namespace routing {
@@ -38,9 +40,9 @@ class SingleCloseNodesChangeTest_BEH_ChoosePmidNode_Test;
 }
 
 enum class GroupRangeStatus {
-  kInRange,   // become in range (Parameter::group_size = 4)
-  kInProximalRange,   // factor of holders' range (Parameter::group_size = 4)
-  kOutwithRange   // become out of range (Parameter::group_size = 4)
+  kInRange,   // become in range (RoutingConfig::group_size = 4)
+  kInProximalRange,   // factor of holders' range (RoutingConfig::group_size = 4)
+  kOutwithRange   // become out of range (RoutingConfig::group_size = 4)
 };
 
 struct CheckHoldersResult {
@@ -59,6 +61,7 @@ class ConnectionsChange {
                     const std::vector<NodeId>& new_close_nodes);
 
  public:
+  // If a change lost or gained several close nodes, these return the closest of them.
   NodeId lost_node() const { return lost_node_; }
   NodeId new_node() const { return new_node_; }
   NodeId node_id() const { return node_id_; }
@@ -83,7 +86,8 @@ class ClientNodesChange : public ConnectionsChange {
   ClientNodesChange& operator=(const ClientNodesChange& other);
   ClientNodesChange& operator=(ClientNodesChange&& other);
   ClientNodesChange(NodeId this_node_id, const std::vector<NodeId>& old_close_nodes,
-                    const std::vector<NodeId>& new_close_nodes);
+                    const std::vector<NodeId>& new_close_nodes,
+                    const RoutingConfig& config = RoutingConfig());
   std::string ReportConnection() const;
 
   friend void swap(ClientNodesChange& lhs, ClientNodesChange& rhs) MAIDSAFE_NOEXCEPT;
@@ -91,13 +95,15 @@ class ClientNodesChange : public ConnectionsChange {
 
 class CloseNodesChange : public ConnectionsChange {
  public:
-  CloseNodesChange() = default;
+  CloseNodesChange();
   CloseNodesChange(const CloseNodesChange& other) = default;
   CloseNodesChange(CloseNodesChange&& other);
   CloseNodesChange& operator=(const CloseNodesChange& other);
   CloseNodesChange& operator=(CloseNodesChange&& other);
+  // The holders of a target are the config.group_size nodes closest to it.
   CloseNodesChange(const NodeId& this_node_id, const std::vector<NodeId>& old_close_nodes,
-                   const std::vector<NodeId>& new_close_nodes);
+                   const std::vector<NodeId>& new_close_nodes,
+                   const RoutingConfig& config = RoutingConfig());
 
   CheckHoldersResult CheckHolders(const NodeId& target) const;
   bool CheckIsHolder(const NodeId& target, const NodeId& node_id) const;
@@ -110,6 +116,7 @@ class CloseNodesChange : public ConnectionsChange {
 
  private:
   crypto::BigInt radius_;
+  unsigned int group_size_;
 };
 
 void swap(ConnectionsChange& lhs, ConnectionsChange& rhs) MAIDSAFE_NOEXCEPT;
@@ -47,6 +47,8 @@ struct NodeInfo {
   NodeId id;
   NodeId connection_id;  // Id of a node as far as rudp is concerned
   asymm::PublicKey public_key;
+  // Hash of the encoded public_key, set by RoutingTable when the node is added.  Not serialised.
+  uint64_t public_key_fingerprint;
   int32_t rank;
   int32_t bucket;
   rudp::NatType nat_type;
@@ -57,9 +57,27 @@ struct Parameters {
   static boost::posix_time::time_duration connect_rpc_prune_timeout;
   static unsigned int max_send_retry;
   static unsigned int ack_timeout;
+  static std::chrono::milliseconds min_ack_timeout;
   static unsigned int firewall_history_cleanup_factor;
   static std::chrono::seconds firewall_message_life;
+  static unsigned int firewall_max_history;
   static unsigned int public_key_holding_time;
+  static unsigned int max_retries_in_flight;
+  static std::chrono::milliseconds retry_base_delay;
+  static std::chrono::milliseconds retry_max_delay;
+  static unsigned int retry_budget;
+  static std::chrono::milliseconds coalescing_window;
+  static unsigned int max_coalesced_message_size;
+  static unsigned int max_batch_size;
+  static std::chrono::milliseconds ack_batch_window;
+  static unsigned int max_batched_acks;
+  static bool end_to_end_acks;
+  static bool hedged_direct_sends;
+  static std::chrono::milliseconds hedge_min_delay;
+  static std::chrono::milliseconds hedge_max_delay;
+  static unsigned int max_messages_in_flight;
+  static unsigned int max_messages_in_flight_per_hop;
+  static unsigned int priority_starvation_limit;
   static bool caching;
 
  private:
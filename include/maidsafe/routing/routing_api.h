@@ -32,6 +32,7 @@
 #define MAIDSAFE_ROUTING_ROUTING_API_H_
 
 #include <condition_variable>
+#include <cstdint>
 #include <future>
 #include <memory>
 #include <mutex>
@@ -47,6 +48,7 @@
 #include "maidsafe/passport/types.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/routing_config.h"
 
 namespace maidsafe {
 
@@ -69,10 +71,32 @@ struct is_client<const passport::Pmid> : public std::false_type {};
 
 }  // namespace detail
 
+// Handle to a request made by Routing::SendDirectAsync or SendGroupAsync.
+class PendingResponse {
+ public:
+  PendingResponse(PendingResponse&& other);
+  PendingResponse& operator=(PendingResponse&& other);
+  // Becomes ready with the response, or with an empty string if waiting time
+  // (Parameters::default_response_timeout) expires or the request is cancelled.
+  std::future<std::string>& response() { return response_; }
+
+  friend class Routing;
+
+ private:
+  PendingResponse();
+  PendingResponse(const PendingResponse&);
+  PendingResponse& operator=(const PendingResponse&);
+
+  int32_t task_id_, ack_id_;
+  std::future<std::string> response_;
+};
+
 class Routing {
  public:
   // create a non-mutating client
   Routing();
+  // create a non-mutating client with non-default parameters
+  explicit Routing(const RoutingConfig& config);
 
   // Providing :
   // pmid as a paramater will create a non client routing object(vault).
@@ -84,7 +108,19 @@ class Routing {
     asymm::Keys keys;
     keys.private_key = fob.private_key();
     keys.public_key = fob.public_key();
-    InitialisePimpl(detail::is_client<FobType>::value, NodeId(fob.name()->string()), keys);
+    InitialisePimpl(detail::is_client<FobType>::value, NodeId(fob.name()->string()), keys,
+                    RoutingConfig());
+  }
+
+  // As above, with tunables (group sizes, timeouts, retry limits, ...) taken from 'config' rather
+  // than the process-wide defaults.  Several instances in one process may use different configs.
+  template <typename FobType>
+  Routing(const FobType& fob, const RoutingConfig& config)
+      : pimpl_() {
+    asymm::Keys keys;
+    keys.private_key = fob.private_key();
+    keys.public_key = fob.public_key();
+    InitialisePimpl(detail::is_client<FobType>::value, NodeId(fob.name()->string()), keys, config);
   }
 
   ~Routing();
@@ -97,7 +133,8 @@ class Routing {
                     const boost::asio::ip::udp::endpoint& peer_endpoint, const NodeInfo& peer_info);
 
   // Sends message to a known destnation. (Typed Message API)
-  // Throws on invalid paramaters
+  // Throws on invalid paramaters, or with CommonErrors::cannot_exceed_limit if too many messages
+  // sent are awaiting acks (Functors::send_ready fires once that changes)
   template <typename T>
   void Send(const T& message);
 
@@ -105,7 +142,7 @@ class Routing {
   // If a valid response functor is provided, it will be called when:
   // a) the response is receieved or,
   // b) waiting time (Parameters::default_response_timeout) for receiving the response expires
-  // Throws on invalid paramaters
+  // Throws on invalid paramaters, or with CommonErrors::cannot_exceed_limit as for Send
   void SendDirect(const NodeId& destination_id,                       // ID of final destination
                   const std::string& message, bool cacheable,  // to cache message content
                   ResponseFunctor response_functor);                  // Called on response
@@ -116,11 +153,36 @@ class Routing {
   // If a valid response functor is provided, it will be called when:
   // a) for each response receieved (Parameters::group_size responses expected) or,
   // b) waiting time (Parameters::default_response_timeout) for receiving the response expires
-  // Throws on invalid paramaters
+  // Throws on invalid paramaters, or with CommonErrors::cannot_exceed_limit as for Send
   void SendGroup(const NodeId& destination_id,  // ID of final destination or group centre
                  const std::string& message, bool cacheable,  // to cache message content
                  ResponseFunctor response_functor);                  // Called on each response
 
+  // As above, but 'response_functor' is called just once:
+  // a) with the response as soon as 'quorum' of the group's responses agree under
+  //    'response_match' (byte-wise equality if it is null), without waiting for the others or,
+  // b) with an empty string if the group can no longer reach 'quorum', or waiting time
+  //    (Parameters::default_response_timeout) for receiving the responses expires
+  // Throws with CommonErrors::invalid_parameter unless 1 <= quorum <= Parameters::group_size
+  void SendGroup(const NodeId& destination_id, const std::string& message, bool cacheable,
+                 int quorum, ResponseFunctor response_functor,
+                 ResponseMatchFunctor response_match = ResponseMatchFunctor());
+
+  // As SendDirect above, but the response is delivered through the returned handle's future
+  // rather than to a functor, which avoids the cost of one per request.
+  PendingResponse SendDirectAsync(const NodeId& destination_id, const std::string& message,
+                                  bool cacheable);
+
+  // As the quorum form of SendGroup above, delivering the response as for SendDirectAsync
+  PendingResponse SendGroupAsync(const NodeId& destination_id, const std::string& message,
+                                 bool cacheable, int quorum,
+                                 ResponseMatchFunctor response_match = ResponseMatchFunctor());
+
+  // Abandons a request: its future is made ready with an empty string before this returns, and
+  // the state held for its response and for the ack of its message is released.  Does nothing if
+  // the request has already completed.
+  void CancelRequest(const PendingResponse& pending_response);
+
   // Compares own closeness to target against other known nodes' closeness to the target
   bool ClosestToId(const NodeId& target_id);
 
@@ -152,7 +214,8 @@ class Routing {
   Routing(const Routing&);
   Routing(const Routing&&);
   Routing& operator=(const Routing&);
-  void InitialisePimpl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys);
+  void InitialisePimpl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                       const RoutingConfig& config);
 
   class Impl;
   std::shared_ptr<Impl> pimpl_;
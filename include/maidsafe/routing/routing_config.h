@@ -0,0 +1,145 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ROUTING_CONFIG_H_
+#define MAIDSAFE_ROUTING_ROUTING_CONFIG_H_
+
+#include <chrono>
+#include <cstdint>
+
+namespace maidsafe {
+
+namespace routing {
+
+// Compile-time defaults for the values in RoutingConfig.  Parameters is initialised from these, and
+// code which needs a value fixed at build time can use them directly.
+namespace defaults {
+
+const unsigned int kClosestNodesSize(16);
+const unsigned int kGroupSize(4);
+const unsigned int kProximityFactor(2);
+const unsigned int kMaxRoutingTableSize(64);
+const unsigned int kRoutingTableSizeThreshold(kMaxRoutingTableSize / 4);
+const unsigned int kMaxRoutingTableSizeForClient(8);
+const unsigned int kRoutingTableReadyToResponse(kMaxRoutingTableSize / 2);
+const unsigned int kUnidirectionalInterestRange(kClosestNodesSize * 2);
+const unsigned int kMaxRouteHistory(3);
+const unsigned int kHopsToLive(50);
+const unsigned int kMaxSendRetry(3);
+const unsigned int kAckTimeoutSeconds(5);
+const unsigned int kMinAckTimeoutMilliseconds(200);
+const unsigned int kFirewallHistoryCleanupFactor(5000);
+const unsigned int kFirewallMessageLifeSeconds(300);
+const unsigned int kFirewallMaxHistory(256 * 1024);
+const unsigned int kDefaultResponseTimeoutSeconds(20);
+const unsigned int kFindNodeIntervalSeconds(10);
+const unsigned int kRecoveryTimeLagSeconds(5);
+const unsigned int kReBootstrapTimeLagSeconds(10);
+const unsigned int kFindCloseNodeIntervalSeconds(3);
+const unsigned int kMaxRetriesInFlight(64);
+const unsigned int kRetryBaseDelayMilliseconds(50);
+const unsigned int kRetryMaxDelayMilliseconds(2000);
+const unsigned int kRetryBudget(20);
+const unsigned int kCoalescingWindowMilliseconds(0);
+const unsigned int kMaxCoalescedMessageSize(1024);
+const unsigned int kMaxBatchSize(16 * 1024);
+const unsigned int kAckBatchWindowMilliseconds(0);
+const unsigned int kMaxBatchedAcks(64);
+const bool kEndToEndAcks(false);
+const bool kHedgedDirectSends(false);
+const unsigned int kHedgeMinDelayMilliseconds(25);
+const unsigned int kHedgeMaxDelayMilliseconds(1000);
+const unsigned int kMaxMessagesInFlight(1024);
+const unsigned int kMaxMessagesInFlightPerHop(256);
+const unsigned int kPriorityStarvationLimit(16);
+
+}  // namespace defaults
+
+// Tuning for a single Routing instance, allowing nodes in one process to differ, e.g. vaults and
+// clients.  A default-constructed config takes every value from Parameters as they stand at that
+// point, so code which adjusts Parameters before creating its nodes is unaffected.
+struct RoutingConfig {
+  RoutingConfig();
+
+  unsigned int closest_nodes_size;
+  unsigned int group_size;
+  unsigned int proximity_factor;  // multiple of the close nodes' radius deemed proximal
+  unsigned int max_routing_table_size;  // max size of RoutingTable owned by vault
+  unsigned int routing_table_size_threshold;
+  unsigned int max_routing_table_size_for_client;  // max size of RoutingTable in client
+  unsigned int routing_table_ready_to_response;
+  unsigned int unidirectional_interest_range;
+  unsigned int max_route_history;
+  unsigned int hops_to_live;
+  unsigned int max_send_retry;
+  // The longest a hop waits for an ack before resending, and the wait for peers whose round-trip
+  // time is not yet known.  Once rudp sends to a peer have been timed, the wait for it is derived
+  // from its smoothed round-trip time and deviation, no less than min_ack_timeout.
+  unsigned int ack_timeout;  // seconds
+  std::chrono::milliseconds min_ack_timeout;
+  // No longer used: the firewall drops its history a generation at a time rather than after this
+  // many additions.  Kept so existing configs still build.
+  unsigned int firewall_history_cleanup_factor;
+  // The least time for which the firewall remembers a processed message, unless it is holding
+  // firewall_max_history messages, in which case the oldest are forgotten early.
+  std::chrono::seconds firewall_message_life;
+  unsigned int firewall_max_history;  // messages; bounds the firewall's memory
+  std::chrono::steady_clock::duration default_response_timeout;
+  std::chrono::seconds find_node_interval;
+  std::chrono::seconds recovery_time_lag;
+  std::chrono::seconds re_bootstrap_time_lag;
+  std::chrono::seconds find_close_node_interval;
+  unsigned int max_retries_in_flight;  // send retries waiting on a backoff timer at once
+  std::chrono::milliseconds retry_base_delay;  // backoff before the first retry to a peer
+  std::chrono::milliseconds retry_max_delay;
+  unsigned int retry_budget;  // send retries which may be started per second
+  // How long a small message may wait for others to the same peer to share its rudp send.  Zero
+  // disables coalescing, and is the default: peers predating MessageBatch can't parse batches, so
+  // only enable it on a network where every node can.
+  std::chrono::milliseconds coalescing_window;
+  unsigned int max_coalesced_message_size;  // bytes; larger messages are sent alone
+  unsigned int max_batch_size;  // bytes; a batch reaching this is sent without waiting
+  // How long an ack may wait to be batched with others to the same node, or piggybacked on a
+  // message to it.  Zero sends every ack at once, and is the default: peers predating acked_ids
+  // drop batched and piggybacked acks, so only enable it on a network where every node has it.
+  std::chrono::milliseconds ack_batch_window;
+  unsigned int max_batched_acks;  // acks to one node which are sent at once, without waiting
+  // Whether messages this node originates are acked by their destination to this node only, rather
+  // than by every hop to the one before.  rudp already makes each hop reliable, so this saves an
+  // ack timer and an ack message per hop, at the cost of a whole-route resend on a lost message.
+  bool end_to_end_acks;
+  // Whether a direct message this node originates is also sent via the second closest next hop if
+  // the first has not acked it in time.  The deadline adapts to the estimated round trip to the
+  // first hop, within the bounds below; duplicates are dropped by the destination's firewall.
+  bool hedged_direct_sends;
+  std::chrono::milliseconds hedge_min_delay;
+  std::chrono::milliseconds hedge_max_delay;
+  // Messages sent by the application and not yet acked, beyond which Send is refused; in total and
+  // via any one next hop.  Zero is no limit.
+  unsigned int max_messages_in_flight;
+  unsigned int max_messages_in_flight_per_hop;
+  // Received messages handled in a row from higher priority classes while one of a lower class
+  // waits, before that one is handled regardless.  Zero lets lower classes wait indefinitely.
+  unsigned int priority_starvation_limit;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ROUTING_CONFIG_H_
@@ -20,6 +20,7 @@
 #define MAIDSAFE_ROUTING_TESTS_ROUTING_NETWORK_H_
 
 #include <chrono>
+#include <cstdint>
 #include <future>
 #include <map>
 #include <string>
@@ -84,6 +85,7 @@ class GenericNode {
   GenericNode(bool client_mode, const rudp::NatType& nat_type);
   explicit GenericNode(bool has_symmetric_nat = false);
   GenericNode(const passport::Pmid& pmid, bool has_symmetric_nat = false);
+  GenericNode(const passport::Pmid& pmid, const RoutingConfig& config);
   GenericNode(const passport::Maid& maid, bool has_symmetric_nat = false);
   virtual ~GenericNode();
   int GetStatus() const;
@@ -113,6 +115,8 @@ class GenericNode {
 
   template <typename T>
   void Send(const T& message);
+  // The message which Send puts on the wire for 'message'.
+  protobuf::Message CreateNodeLevelMessage(const SingleToSingleMessage& message);
 
   void AddTask(const ResponseFunctor& response_functor, int expected_response_count,
                TaskId task_id);
@@ -146,6 +150,7 @@ class GenericNode {
 
   static size_t next_node_id_;
   size_t MessagesSize() const;
+  uint64_t MessagesSent() const;
   void ClearMessages();
   asymm::PublicKey public_key();
   int Health();
@@ -19,17 +19,20 @@
 #ifndef MAIDSAFE_ROUTING_TIMER_H_
 #define MAIDSAFE_ROUTING_TIMER_H_
 
+#include <algorithm>
 #include <condition_variable>
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
-#include "boost/asio/steady_timer.hpp"
 #include "boost/asio/error.hpp"
 
 #include "maidsafe/common/asio_service.h"
@@ -37,6 +40,8 @@
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/routing/timing_wheel.h"
+
 namespace maidsafe {
 
 namespace routing {
@@ -51,7 +56,11 @@ template <typename Response>
 class Timer {
  public:
   typedef std::function<void(Response)> ResponseFunctor;
+  typedef std::function<bool(const Response&, const Response&)> MatchFunctor;
+  // Keeps its deadlines on a timing wheel of its own.
   explicit Timer(BoostAsioService& asio_service);
+  // Keeps its deadlines on 'timing_wheel', which must outlive this.
+  Timer(BoostAsioService& asio_service, TimingWheel& timing_wheel);
   // Cancels all tasks and blocks until all functors have been executed and all tasks removed.
   ~Timer();
   // Adds a task with a deadline, and returns a unique ID for the task.  'response_functor' will be
@@ -62,12 +71,31 @@ class Timer {
   void AddTask(const std::chrono::steady_clock::duration& timeout,
                  const ResponseFunctor& response_functor, int expected_response_count,
                  TaskId task_id);
+  // Adds a task which aggregates up to 'expected_response_count' responses into a single
+  // invocation of 'response_functor'.  As soon as 'quorum' responses agree under 'match' (or
+  // operator== if 'match' is null), the functor is invoked once with the latest of them and the
+  // task is finished without waiting for the rest.  If the task times out or is cancelled first, or
+  // once the outstanding responses can no longer make up a quorum, the functor is invoked once with
+  // a default-constructed Response.  Throws if 'response_functor' is null or if 'quorum' is not in
+  // the range [1, 'expected_response_count'].
+  void AddQuorumTask(const std::chrono::steady_clock::duration& timeout,
+                     const ResponseFunctor& response_functor, int expected_response_count,
+                     int quorum, const MatchFunctor& match, TaskId task_id);
+  // As the two above, but the task's single result is set on the returned future, on the thread
+  // calling 'AddResponse', 'CancelTask' or the timeout, rather than passed to a functor.
+  std::future<Response> AddTask(const std::chrono::steady_clock::duration& timeout,
+                                TaskId task_id);
+  std::future<Response> AddQuorumTask(const std::chrono::steady_clock::duration& timeout,
+                                      int expected_response_count, int quorum,
+                                      const MatchFunctor& match, TaskId task_id);
   // Removes the task and invokes its functor once per "missing" expected Response, with a
-  // default-constructed Response each time.  Throws if the indicated task doesn't exist.
-  void CancelTask(TaskId task_id);
-  // Invokes the response functor for the indicated task.  Throws if the indicated task doesn't
+  // default-constructed Response each time.  The future of a task added without a functor is set
+  // to a default-constructed Response before this returns.  Throws if the indicated task doesn't
   // exist.
-  void AddResponse(TaskId task_id, const Response& response);
+  void CancelTask(TaskId task_id);
+  // Invokes the response functor for the indicated task, moving 'response' to it rather than
+  // copying.  Throws if the indicated task doesn't exist.
+  void AddResponse(TaskId task_id, Response response);
   void CancelAll();
 
   TaskId NewTaskId();
@@ -86,14 +114,21 @@ class Timer {
 
  private:
   struct Task {
-    Task(boost::asio::io_service& io_service, const std::chrono::steady_clock::duration& timeout,
-         ResponseFunctor functor_in, int expected_response_count);
+    Task(ResponseFunctor functor_in, int expected_response_count);
     Task(Task&& other);
     Task& operator=(Task&& other);
 
-    std::unique_ptr<boost::asio::steady_timer> timer;
+    TimingWheel::TimerId timer_id;
     ResponseFunctor functor;
     int outstanding_response_count;
+    // Non-zero for a task added via 'AddQuorumTask', in which case 'responses' holds those received
+    // so far and 'best_match_count' the size of the largest set of them which agree.
+    int quorum;
+    MatchFunctor match;
+    std::vector<Response> responses;
+    int best_match_count;
+    // Set in place of 'functor' for a task whose result is delivered through a future.
+    std::unique_ptr<std::promise<Response>> promise;
 
    private:
     Task() = delete;
@@ -106,8 +141,16 @@ class Timer {
   Timer& operator=(Timer);
 
   void FinishTask(TaskId task_id, const boost::system::error_code& error);
+  void InsertTask(const std::chrono::steady_clock::duration& timeout, Task&& task, TaskId task_id);
+  // Called with 'mutex_' locked.  Returns true if the task has just completed, with 'response'
+  // left holding its result.
+  bool AddQuorumResponse(Task& task, Response& response);
+  // Called with 'mutex_' locked.  Releases the state held for a quorum task's responses.
+  void ReleaseResponses(Task& task);
 
   BoostAsioService& asio_service_;
+  std::unique_ptr<TimingWheel> own_timing_wheel_;
+  TimingWheel& timing_wheel_;
   TaskId new_task_id_;
   std::mutex mutex_;
   std::condition_variable cond_var_;
@@ -116,30 +159,59 @@ class Timer {
 
 // ==================== Implementation =============================================================
 template <typename Response>
-Timer<Response>::Task::Task(boost::asio::io_service& io_service,
-                            const std::chrono::steady_clock::duration& timeout,
-                            ResponseFunctor functor_in, int expected_response_count)
-    : timer(new boost::asio::steady_timer(io_service, timeout)),
+Timer<Response>::Task::Task(ResponseFunctor functor_in, int expected_response_count)
+    : timer_id(0),
       functor(std::move(functor_in)),
-      outstanding_response_count(expected_response_count) {}
+      outstanding_response_count(expected_response_count),
+      quorum(0),
+      match(),
+      responses(),
+      best_match_count(0),
+      promise() {}
 
 template <typename Response>
 Timer<Response>::Task::Task(Task&& other)
-    : timer(std::move(other.timer)),
+    : timer_id(other.timer_id),
       functor(std::move(other.functor)),
-      outstanding_response_count(std::move(other.outstanding_response_count)) {}
+      outstanding_response_count(std::move(other.outstanding_response_count)),
+      quorum(other.quorum),
+      match(std::move(other.match)),
+      responses(std::move(other.responses)),
+      best_match_count(other.best_match_count),
+      promise(std::move(other.promise)) {}
 
 template <typename Response>
 typename Timer<Response>::Task& Timer<Response>::Task::operator=(Task&& other) {
-  timer = std::move(other.timer);
+  timer_id = other.timer_id;
   functor = std::move(other.functor);
   outstanding_response_count = std::move(other.outstanding_response_count);
+  quorum = other.quorum;
+  match = std::move(other.match);
+  responses = std::move(other.responses);
+  best_match_count = other.best_match_count;
+  promise = std::move(other.promise);
   return *this;
 }
 
 template <typename Response>
 Timer<Response>::Timer(BoostAsioService& asio_service)
-    : asio_service_(asio_service), new_task_id_(RandomInt32()), mutex_(), cond_var_(), tasks_() {}
+    : asio_service_(asio_service),
+      own_timing_wheel_(new TimingWheel(asio_service)),
+      timing_wheel_(*own_timing_wheel_),
+      new_task_id_(RandomInt32()),
+      mutex_(),
+      cond_var_(),
+      tasks_() {}
+
+template <typename Response>
+Timer<Response>::Timer(BoostAsioService& asio_service, TimingWheel& timing_wheel)
+    : asio_service_(asio_service),
+      own_timing_wheel_(),
+      timing_wheel_(timing_wheel),
+      new_task_id_(RandomInt32()),
+      mutex_(),
+      cond_var_(),
+      tasks_() {}
 
 template <typename Response>
 Timer<Response>::~Timer() {
@@ -150,7 +222,7 @@ template <typename Response>
 void Timer<Response>::CancelAll() {
   std::unique_lock<std::mutex> lock(mutex_);
   for (const auto& task : tasks_)
-    task.second.timer->cancel();
+    timing_wheel_.Cancel(task.second.timer_id);
   cond_var_.wait(lock, [&] { return tasks_.empty(); });
 }
 
@@ -164,20 +236,71 @@ void Timer<Response>::AddTask(const std::chrono::steady_clock::duration& timeout
                 << " incorrect expected_response_count";
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
   }
+  InsertTask(timeout, Task(response_functor, expected_response_count), task_id);
+}
+
+template <typename Response>
+void Timer<Response>::AddQuorumTask(const std::chrono::steady_clock::duration& timeout,
+                                    const ResponseFunctor& response_functor,
+                                    int expected_response_count, int quorum,
+                                    const MatchFunctor& match, TaskId task_id) {
+  if (!response_functor || quorum < 1 || quorum > expected_response_count) {
+    LOG(kError) << "Timer<Response>::AddQuorumTask response_functor not initialised or "
+                << " incorrect quorum";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  Task task(response_functor, expected_response_count);
+  task.quorum = quorum;
+  task.match = match ? match : [](const Response& lhs, const Response& rhs) { return lhs == rhs; };
+  task.responses.reserve(expected_response_count);
+  InsertTask(timeout, std::move(task), task_id);
+}
+
+template <typename Response>
+std::future<Response> Timer<Response>::AddTask(const std::chrono::steady_clock::duration& timeout,
+                                               TaskId task_id) {
+  Task task(ResponseFunctor(), 1);
+  task.promise.reset(new std::promise<Response>());
+  auto future(task.promise->get_future());
+  InsertTask(timeout, std::move(task), task_id);
+  return future;
+}
+
+template <typename Response>
+std::future<Response> Timer<Response>::AddQuorumTask(
+    const std::chrono::steady_clock::duration& timeout, int expected_response_count, int quorum,
+    const MatchFunctor& match, TaskId task_id) {
+  if (quorum < 1 || quorum > expected_response_count) {
+    LOG(kError) << "Timer<Response>::AddQuorumTask incorrect quorum";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  Task task(ResponseFunctor(), expected_response_count);
+  task.quorum = quorum;
+  task.match = match ? match : [](const Response& lhs, const Response& rhs) { return lhs == rhs; };
+  task.responses.reserve(expected_response_count);
+  task.promise.reset(new std::promise<Response>());
+  auto future(task.promise->get_future());
+  InsertTask(timeout, std::move(task), task_id);
+  return future;
+}
+
+template <typename Response>
+void Timer<Response>::InsertTask(const std::chrono::steady_clock::duration& timeout, Task&& task,
+                                 TaskId task_id) {
   std::lock_guard<std::mutex> lock(mutex_);
-  auto result(tasks_.insert(std::move(
-      std::make_pair(task_id, std::move(Task(asio_service_.service(), timeout, response_functor,
-                                             expected_response_count))))));
+  auto result(tasks_.insert(std::make_pair(task_id, std::move(task))));
   assert(result.second);
-  result.first->second.timer->async_wait([this, task_id](const boost::system::error_code & error) {
-    this->FinishTask(task_id, error);
-  });
+  result.first->second.timer_id = timing_wheel_.Schedule(
+      timeout, [this, task_id](const boost::system::error_code & error) {
+        this->FinishTask(task_id, error);
+      });
 }
 
 template <typename Response>
 void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code& error) {
   int outstanding_response_count(0);
   ResponseFunctor functor;
+  std::unique_ptr<std::promise<Response>> promise;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     auto itr(tasks_.find(task_id));
@@ -187,8 +310,14 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
     }
     assert(itr->second.outstanding_response_count >= 0);
     if (itr->second.outstanding_response_count != 0) {
-      outstanding_response_count = itr->second.outstanding_response_count;
-      functor = itr->second.functor;
+      if (itr->second.promise) {
+        promise = std::move(itr->second.promise);
+      } else {
+        // A quorum task which is still waiting reports its failure just once.
+        outstanding_response_count =
+            itr->second.quorum == 0 ? itr->second.outstanding_response_count : 1;
+        functor = itr->second.functor;
+      }
     }
 
     tasks_.erase(itr);
@@ -203,6 +332,8 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
         LOG(kError) << "Error waiting for task " << task_id << " - " << error.message();
     }
   }
+  if (promise)
+    promise->set_value(Response());
   for (int i(0); i != outstanding_response_count; ++i)
     asio_service_.service().dispatch([=] { functor(Response()); });
   cond_var_.notify_one();
@@ -210,18 +341,29 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
 
 template <typename Response>
 void Timer<Response>::CancelTask(TaskId task_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto itr(tasks_.find(task_id));
-  if (itr == std::end(tasks_)) {
-    LOG(kError) << "Task " << task_id << " not held by Timer.";
-    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  std::unique_ptr<std::promise<Response>> promise;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itr(tasks_.find(task_id));
+    if (itr == std::end(tasks_)) {
+      LOG(kError) << "Task " << task_id << " not held by Timer.";
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+    }
+    if (itr->second.promise) {
+      promise = std::move(itr->second.promise);
+      itr->second.outstanding_response_count = 0;
+      ReleaseResponses(itr->second);
+    }
+    timing_wheel_.Cancel(itr->second.timer_id);
   }
-  itr->second.timer->cancel();
+  if (promise)
+    promise->set_value(Response());
 }
 
 template <typename Response>
-void Timer<Response>::AddResponse(TaskId task_id, const Response& response) {
+void Timer<Response>::AddResponse(TaskId task_id, Response response) {
   ResponseFunctor functor;
+  std::unique_ptr<std::promise<Response>> promise;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     auto itr(tasks_.find(task_id));
@@ -233,12 +375,51 @@ void Timer<Response>::AddResponse(TaskId task_id, const Response& response) {
       LOG(kError) << "outstanding_response_count already reached zero";
       return;
     }
-    --(itr->second.outstanding_response_count);
-    functor = itr->second.functor;
+    if (itr->second.quorum != 0) {
+      if (!AddQuorumResponse(itr->second, response))
+        return;
+    } else {
+      --(itr->second.outstanding_response_count);
+    }
+    if (itr->second.promise)
+      promise = std::move(itr->second.promise);
+    else
+      functor = itr->second.functor;
     if (itr->second.outstanding_response_count == 0)
-      itr->second.timer->cancel();  // Invokes 'FinishTask'
+      timing_wheel_.Cancel(itr->second.timer_id);  // Invokes 'FinishTask'
+  }
+  if (promise)
+    return promise->set_value(std::move(response));
+  auto shared_response(std::make_shared<Response>(std::move(response)));
+  asio_service_.service().dispatch([=] { functor(*shared_response); });
+}
+
+template <typename Response>
+bool Timer<Response>::AddQuorumResponse(Task& task, Response& response) {
+  --task.outstanding_response_count;
+  int match_count(1);
+  for (const auto& held : task.responses) {
+    if (task.match(held, response))
+      ++match_count;
   }
-  asio_service_.service().dispatch([=] { functor(response); });
+  task.best_match_count = std::max(task.best_match_count, match_count);
+  if (match_count < task.quorum) {
+    if (task.best_match_count + task.outstanding_response_count >= task.quorum) {
+      task.responses.push_back(std::move(response));
+      return false;
+    }
+    response = Response();  // Quorum can no longer be reached
+  }
+  task.outstanding_response_count = 0;
+  ReleaseResponses(task);
+  return true;
+}
+
+template <typename Response>
+void Timer<Response>::ReleaseResponses(Task& task) {
+  // Done now rather than when 'FinishTask' runs.
+  std::vector<Response>().swap(task.responses);
+  task.match = MatchFunctor();
 }
 
 template <typename Response>
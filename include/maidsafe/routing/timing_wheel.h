@@ -0,0 +1,76 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_TIMING_WHEEL_H_
+#define MAIDSAFE_ROUTING_TIMING_WHEEL_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "boost/system/error_code.hpp"
+
+#include "maidsafe/common/asio_service.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Deadlines for many timers, kept in a hierarchical timing wheel and driven by a single asio
+// timer, so that scheduling or cancelling one costs O(1) rather than a timer of its own in asio's
+// heap.  Deadlines are rounded up to the wheel's resolution.  As with an asio timer, each handler
+// is invoked exactly once on an io thread: with success once its deadline has passed, or with
+// operation_aborted if cancelled first.
+class TimingWheel {
+ public:
+  typedef uint64_t TimerId;  // never 0, so 0 can stand for "no timer"
+  typedef std::function<void(const boost::system::error_code& error)> Handler;
+
+  explicit TimingWheel(BoostAsioService& asio_service,
+                       std::chrono::steady_clock::duration resolution =
+                           std::chrono::milliseconds(1));
+  // Cancels all pending timers.
+  ~TimingWheel();
+
+  // Throws if 'handler' is null.
+  TimerId Schedule(const std::chrono::steady_clock::duration& timeout, Handler handler);
+  // Returns false if 'timer_id' has already fired or been cancelled.
+  bool Cancel(TimerId timer_id);
+  void CancelAll();
+  size_t size() const;
+
+ private:
+  struct State;
+
+  TimingWheel(const TimingWheel&);
+  TimingWheel(const TimingWheel&&);
+  TimingWheel& operator=(const TimingWheel&);
+
+  static void Advance(std::weak_ptr<State> state);
+
+  BoostAsioService& asio_service_;
+  // Shared with the pending asio handler so that it outliving the wheel is harmless.
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_TIMING_WHEEL_H_
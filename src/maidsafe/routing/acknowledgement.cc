@@ -31,9 +31,41 @@ namespace maidsafe {
 
 namespace routing {
 
-Acknowledgement::Acknowledgement(const NodeId& local_node_id, BoostAsioService& io_service)
-    : kNodeId_(local_node_id), ack_id_(RandomInt32()), mutex_(), stop_handling_(false),
-      io_service_(io_service), queue_() {}
+Acknowledgement::Acknowledgement(const NodeId& local_node_id, BoostAsioService& io_service,
+                                 const RoutingConfig& config)
+    : kNodeId_(local_node_id),
+      kMaxSendRetry_(config.max_send_retry),
+      kEndToEndAcks_(config.end_to_end_acks),
+      kMaxAckTimeout_(std::chrono::seconds(config.ack_timeout)),
+      kAckBatchWindow_(config.ack_batch_window.count()),
+      kMaxBatchedAcks_(std::max(config.max_batched_acks, 1U)),
+      ack_id_(RandomInt32()),
+      mutex_(),
+      stop_handling_(false),
+      io_service_(io_service),
+      own_timing_wheel_(new TimingWheel(io_service)),
+      timing_wheel_(*own_timing_wheel_),
+      ack_timers_(),
+      queued_acks_(),
+      ack_done_functor_() {}
+
+Acknowledgement::Acknowledgement(const NodeId& local_node_id, BoostAsioService& io_service,
+                                 TimingWheel& timing_wheel, const RoutingConfig& config)
+    : kNodeId_(local_node_id),
+      kMaxSendRetry_(config.max_send_retry),
+      kEndToEndAcks_(config.end_to_end_acks),
+      kMaxAckTimeout_(std::chrono::seconds(config.ack_timeout)),
+      kAckBatchWindow_(config.ack_batch_window.count()),
+      kMaxBatchedAcks_(std::max(config.max_batched_acks, 1U)),
+      ack_id_(RandomInt32()),
+      mutex_(),
+      stop_handling_(false),
+      io_service_(io_service),
+      own_timing_wheel_(),
+      timing_wheel_(timing_wheel),
+      ack_timers_(),
+      queued_acks_(),
+      ack_done_functor_() {}
 
 Acknowledgement::~Acknowledgement() {
   stop_handling_ = true;
@@ -44,9 +76,11 @@ void Acknowledgement::RemoveAll() {
   std::vector<AckId> ack_ids;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto& timer : queue_) {
-      ack_ids.push_back(timer.ack_id);
-    }
+    for (const auto& timer : ack_timers_)
+      ack_ids.push_back(timer.first);
+    for (const auto& queued : queued_acks_)
+      timing_wheel_.Cancel(queued.second.timer);
+    queued_acks_.clear();
   }
   for (const auto& ack_id : ack_ids) {
     Remove(ack_id);
@@ -58,50 +92,188 @@ AckId Acknowledgement::GetId() {
   return ++ack_id_;
 }
 
+void Acknowledgement::SetAckId(protobuf::Message& message) {
+  message.set_ack_id(GetId());
+  if (kEndToEndAcks_)
+    message.set_end_to_end_ack(true);
+  else
+    message.clear_end_to_end_ack();
+}
+
 void Acknowledgement::Add(protobuf::Message message, Handler handler, int timeout) {
+  Add(OutboundMessage(std::move(message)), handler, std::chrono::seconds(timeout));
+}
+
+void Acknowledgement::Add(const OutboundMessage& message, Handler handler,
+                          std::chrono::milliseconds timeout) {
   std::lock_guard<std::mutex> lock(mutex_);
-  assert(message.has_ack_id() && "non-existing ack id");
-  assert((message.ack_id() != 0) && "invalid ack id");
-
-  AckId ack_id(message.ack_id());
-
-  const auto it(std::find_if(std::begin(queue_), std::end(queue_),
-                             [ack_id](const AckTimer& timer) {
-                               return ack_id == timer.ack_id;
-                             }));
-  if (it == std::end(queue_)) {
-    TimerPointer timer(new boost::asio::deadline_timer(io_service_.service(),
-                                                boost::posix_time::seconds(timeout)));
-    timer->async_wait(handler);
-    queue_.emplace_back(AckTimer(ack_id, message, timer, 0));
+  assert(message.message().has_ack_id() && "non-existing ack id");
+  assert((message.message().ack_id() != 0) && "invalid ack id");
+
+  AckId ack_id(message.message().ack_id());
+
+  auto it(ack_timers_.find(ack_id));
+  if (it == std::end(ack_timers_)) {
+    ack_timers_.emplace(ack_id,
+                        AckTimer(ack_id, message, timing_wheel_.Schedule(timeout, handler), 0));
   } else {
-    it->quantity++;
-    it->timer->expires_from_now(boost::posix_time::seconds(timeout));
-    if (it->quantity == Parameters::max_send_retry) {
-      it->timer->async_wait([=](const boost::system::error_code&) {
-                              Remove(ack_id);
-                            });
-     } else {
-       it->timer->async_wait(handler);
-     }
+    it->second.quantity++;
+    for (unsigned int i(0); i != it->second.quantity && timeout < kMaxAckTimeout_; ++i)
+      timeout *= 2;
+    timeout = std::max(std::min(timeout, kMaxAckTimeout_), std::chrono::milliseconds(1));
+    timing_wheel_.Cancel(it->second.timer);
+    if (it->second.quantity == kMaxSendRetry_) {
+      it->second.timer = timing_wheel_.Schedule(timeout, [=](const boost::system::error_code&) {
+                                                  Remove(ack_id);
+                                                });
+    } else {
+      it->second.timer = timing_wheel_.Schedule(timeout, handler);
+    }
   }
 }
 
 void Acknowledgement::Remove(AckId ack_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto const it(std::find_if(std::begin(queue_), std::end(queue_),
-                             [ack_id] (const AckTimer& timer)->bool {
-                               return ack_id == timer.ack_id;
-                             }));
-  if (it != std::end(queue_)) {
-    it->timer->cancel();
-    queue_.erase(it);
+  std::function<void(AckId)> ack_done_functor;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto const it(ack_timers_.find(ack_id));
+    if (it == std::end(ack_timers_))
+      return;
+    timing_wheel_.Cancel(it->second.timer);
+    if (it->second.hedge_timer)
+      timing_wheel_.Cancel(it->second.hedge_timer);
+    ack_timers_.erase(it);
+    ack_done_functor = ack_done_functor_;
   }
+  if (ack_done_functor)
+    ack_done_functor(ack_id);
+}
+
+bool Acknowledgement::Hedge(AckId ack_id, const boost::posix_time::time_duration& delay,
+                            std::function<void()> hedge) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stop_handling_)
+    return false;
+  const auto it(ack_timers_.find(ack_id));
+  if (it == std::end(ack_timers_))
+    return false;
+  if (it->second.hedge_timer)
+    timing_wheel_.Cancel(it->second.hedge_timer);
+  it->second.hedge_timer = timing_wheel_.Schedule(
+      std::chrono::microseconds(delay.total_microseconds()),
+      [this, ack_id, hedge](const boost::system::error_code& error) {
+        if (error == boost::asio::error::operation_aborted)
+          return;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          const auto it(ack_timers_.find(ack_id));
+          if (it != std::end(ack_timers_))
+            it->second.hedged = true;
+        }
+        hedge();
+      });
+  return true;
 }
 
 void Acknowledgement::HandleMessage(AckId ack_id) {
   assert((ack_id != 0) && "Invalid acknowledgement id");
-  Remove(ack_id);
+  HandleMessage(std::vector<AckId>(1, ack_id));
+}
+
+void Acknowledgement::HandleMessage(const std::vector<AckId>& ack_ids) {
+  std::vector<AckId> done_ack_ids;
+  std::function<void(AckId)> ack_done_functor;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& ack_id : ack_ids) {
+      auto const it(ack_timers_.find(ack_id));
+      if (it != std::end(ack_timers_)) {
+        timing_wheel_.Cancel(it->second.timer);
+        if (it->second.hedge_timer)
+          timing_wheel_.Cancel(it->second.hedge_timer);
+        ack_timers_.erase(it);
+        done_ack_ids.push_back(ack_id);
+      }
+    }
+    ack_done_functor = ack_done_functor_;
+  }
+  if (ack_done_functor) {
+    for (const auto& ack_id : done_ack_ids)
+      ack_done_functor(ack_id);
+  }
+}
+
+bool Acknowledgement::IsAwaited(AckId ack_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ack_timers_.count(ack_id) != 0;
+}
+
+void Acknowledgement::SetAckDoneFunctor(std::function<void(AckId)> functor) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ack_done_functor_ = std::move(functor);
+}
+
+bool Acknowledgement::IsSentOnce(AckId ack_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it(ack_timers_.find(ack_id));
+  return it == std::end(ack_timers_) || (it->second.quantity == 0 && !it->second.hedged);
+}
+
+void Acknowledgement::QueueAck(const NodeId& node_id, AckId ack_id, AckSender sender) {
+  assert((ack_id != 0) && "Invalid acknowledgement id");
+  if (kAckBatchWindow_.total_milliseconds() == 0)
+    return sender(node_id, std::vector<AckId>(1, ack_id));
+
+  AckId full_batch(0);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stop_handling_)
+      return;
+    auto& queued(queued_acks_[node_id]);
+    if (queued.ack_ids.empty()) {
+      queued.timer = timing_wheel_.Schedule(
+          std::chrono::milliseconds(kAckBatchWindow_.total_milliseconds()),
+          [=](const boost::system::error_code& error) {
+            if (error != boost::asio::error::operation_aborted)
+              SendQueuedAcks(node_id, ack_id, sender);
+          });
+    }
+    queued.ack_ids.push_back(ack_id);
+    if (queued.ack_ids.size() >= kMaxBatchedAcks_)
+      full_batch = queued.ack_ids.front();
+  }
+  if (full_batch != 0)
+    SendQueuedAcks(node_id, full_batch, sender);
+}
+
+void Acknowledgement::SendQueuedAcks(const NodeId& node_id, AckId first_ack_id,
+                                     const AckSender& sender) {
+  std::vector<AckId> ack_ids;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itr(queued_acks_.find(node_id));
+    // The batch starting with 'first_ack_id' may have been piggybacked or sent already.
+    if (itr == std::end(queued_acks_) || itr->second.ack_ids.empty() ||
+        itr->second.ack_ids.front() != first_ack_id) {
+      return;
+    }
+    timing_wheel_.Cancel(itr->second.timer);
+    ack_ids.swap(itr->second.ack_ids);
+    queued_acks_.erase(itr);
+  }
+  sender(node_id, ack_ids);
+}
+
+std::vector<AckId> Acknowledgement::TakeQueuedAcks(const NodeId& node_id) {
+  std::vector<AckId> ack_ids;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(queued_acks_.find(node_id));
+  if (itr != std::end(queued_acks_)) {
+    timing_wheel_.Cancel(itr->second.timer);
+    ack_ids.swap(itr->second.ack_ids);
+    queued_acks_.erase(itr);
+  }
+  return ack_ids;
 }
 
 bool Acknowledgement::IsSendingAckRequired(const protobuf::Message& message,
@@ -133,11 +305,15 @@ bool Acknowledgement::NeedsAck(const protobuf::Message& message, const NodeId& /
 
   if (message.source_id().empty())
     return false;
+
+// Only the source waits on an end-to-end ack; hops in between rely on rudp's delivery.
+  if (message.end_to_end_ack() && (message.source_id() != kNodeId_.string()))
+    return false;
   return true;
 }
 
 void Acknowledgement::AdjustAckHistory(protobuf::Message& message) {
-  if (message.relay_id() == kNodeId_.string())
+  if (message.relay_id() == kNodeId_.string() || message.end_to_end_ack())
     return;
   assert((message.ack_node_ids_size() <= 2) && "size of ack list must be smaller than 3");
   if ((message.ack_node_ids_size() == 0) ||
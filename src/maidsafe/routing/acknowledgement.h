@@ -21,8 +21,12 @@
 #define MAIDSAFE_ROUTING_ACKNOWLEDGEMENT_H_
 
 #include<mutex>
+#include <chrono>
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -31,7 +35,10 @@
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/outbound_message.h"
+#include "maidsafe/routing/routing_config.h"
 #include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/timing_wheel.h"
 #include "maidsafe/rudp/managed_connections.h"
 #include "maidsafe/common/asio_service.h"
 #include "maidsafe/common/utils.h"
@@ -48,8 +55,8 @@ namespace test {
   class GenericNode;
 }
 
-typedef std::shared_ptr<boost::asio::deadline_timer> TimerPointer;
 typedef std::function<void(const boost::system::error_code& error)> Handler;
+typedef std::function<void(const NodeId& node_id, const std::vector<AckId>& ack_ids)> AckSender;
 
 enum class GroupMessageAckStatus {
   kPending = 0,
@@ -58,18 +65,26 @@ enum class GroupMessageAckStatus {
 };
 
 struct AckTimer {
-  AckTimer(AckId ack_id_in, const protobuf::Message message_in, TimerPointer timer_in,
+  AckTimer(AckId ack_id_in, const OutboundMessage& message_in, TimingWheel::TimerId timer_in,
            unsigned int quantity_in)
-    : ack_id(ack_id_in), message(message_in), timer(timer_in), quantity(quantity_in) {}
+    : ack_id(ack_id_in), message(message_in), timer(timer_in), quantity(quantity_in),
+      hedge_timer(0), hedged(false) {}
   AckId ack_id;
-  protobuf::Message message;
-  TimerPointer timer;
+  OutboundMessage message;  // shares the sent message's serialised body
+  TimingWheel::TimerId timer;
   unsigned int quantity;
+  TimingWheel::TimerId hedge_timer;  // 0 if not hedged
+  bool hedged;  // whether the hedge has been sent
 };
 
 class Acknowledgement {
  public:
-  Acknowledgement(const NodeId& local_node_id, BoostAsioService& io_service);
+  // Keeps its timers on a timing wheel of its own.
+  Acknowledgement(const NodeId& local_node_id, BoostAsioService& io_service,
+                  const RoutingConfig& config = RoutingConfig());
+  // Keeps its timers on 'timing_wheel', which must outlive this.
+  Acknowledgement(const NodeId& local_node_id, BoostAsioService& io_service,
+                  TimingWheel& timing_wheel, const RoutingConfig& config = RoutingConfig());
   Acknowledgement& operator=(const Acknowledgement&) = delete;
   Acknowledgement& operator=(const Acknowledgement&&) = delete;
   Acknowledgement(const Acknowledgement&) = delete;
@@ -77,9 +92,31 @@ class Acknowledgement {
 
   ~Acknowledgement();
   AckId GetId();
+  // Gives 'message' a new ack ID, marking it to be acked end to end if so configured.
+  void SetAckId(protobuf::Message& message);
   void Add(protobuf::Message message, Handler handler, int timeout);
+  // As above, with a finer timeout.  Each resend doubles 'timeout', up to ack_timeout.
+  void Add(const OutboundMessage& message, Handler handler, std::chrono::milliseconds timeout);
   void Remove(AckId ack_id);
+  // Calls 'hedge' if the ack for 'ack_id', which must have been added, has not arrived within
+  // 'delay'.  Returns false if it is not awaited.
+  bool Hedge(AckId ack_id, const boost::posix_time::time_duration& delay,
+             std::function<void()> hedge);
   void HandleMessage(AckId ack_id);
+  void HandleMessage(const std::vector<AckId>& ack_ids);
+  // Whether a message with 'ack_id' is waiting on its ack.
+  bool IsAwaited(AckId ack_id);
+  // 'functor' is called, outside any lock, with the ID of every ack no longer awaited, whether it
+  // arrived or was given up on.
+  void SetAckDoneFunctor(std::function<void(AckId)> functor);
+  // Whether the message with 'ack_id' has so far been sent only once and not hedged, so that the
+  // round trip of that send may be sampled (Karn's rule).  True if it is not awaited.
+  bool IsSentOnce(AckId ack_id);
+  // Queues an ack of 'ack_id' to 'node_id'.  Acks to one node queued within ack_batch_window are
+  // passed together to 'sender' once the window has elapsed or max_batched_acks are queued, unless
+  // taken first by TakeQueuedAcks to be piggybacked on a message to that node.
+  void QueueAck(const NodeId& node_id, AckId ack_id, AckSender sender);
+  std::vector<AckId> TakeQueuedAcks(const NodeId& node_id);
   bool NeedsAck(const protobuf::Message& message, const NodeId& node_id);
   bool IsSendingAckRequired(const protobuf::Message& message, const NodeId& local_node_id);
   void SetAsFailedPeer(AckId ack_id, const NodeId& node_id);
@@ -89,12 +126,30 @@ class Acknowledgement {
   friend class test::GenericNode;
 
  private:
+  struct QueuedAcks {
+    QueuedAcks() : ack_ids(), timer(0) {}
+    std::vector<AckId> ack_ids;
+    TimingWheel::TimerId timer;
+  };
+
+  // Sends the acks queued for 'node_id', if they are still the batch starting with 'first_ack_id'.
+  void SendQueuedAcks(const NodeId& node_id, AckId first_ack_id, const AckSender& sender);
+
   const NodeId kNodeId_;
+  const unsigned int kMaxSendRetry_;
+  const bool kEndToEndAcks_;
+  const std::chrono::milliseconds kMaxAckTimeout_;
+  const boost::posix_time::milliseconds kAckBatchWindow_;
+  const size_t kMaxBatchedAcks_;
   AckId ack_id_;
   std::mutex mutex_;
   bool stop_handling_;
   BoostAsioService& io_service_;
-  std::vector<AckTimer> queue_;
+  std::unique_ptr<TimingWheel> own_timing_wheel_;
+  TimingWheel& timing_wheel_;
+  std::unordered_map<AckId, AckTimer> ack_timers_;
+  std::map<NodeId, QueuedAcks> queued_acks_;
+  std::function<void(AckId)> ack_done_functor_;
 };
 
 }  // namespace routing
@@ -0,0 +1,197 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/bucket_index.h"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <utility>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// Bit 'bit' of a raw id, counted from the least significant end as bucket numbers are.
+bool BitIsSet(const std::string& raw_id, int32_t bit) {
+  return (static_cast<unsigned char>(raw_id[NodeId::kSize - 1 - bit / 8]) &
+          (1U << (bit % 8))) != 0;
+}
+
+}  // unnamed namespace
+
+BucketIndex::BucketIndex(const NodeId& holder_id)
+    : kHolderId_(holder_id), buckets_(), size_(0) {}
+
+int32_t BucketIndex::Bucket(const NodeId& holder_id, const NodeId& node_id) {
+  std::string holder_raw_id(holder_id.string());
+  std::string node_raw_id(node_id.string());
+  for (int32_t byte_index(0); byte_index != NodeId::kSize; ++byte_index) {
+    unsigned char difference(static_cast<unsigned char>(holder_raw_id[byte_index]) ^
+                             static_cast<unsigned char>(node_raw_id[byte_index]));
+    if (difference != 0) {
+      int32_t bit_index(0);
+      while ((difference & (0x80U >> bit_index)) == 0)
+        ++bit_index;
+      return (8 * (NodeId::kSize - byte_index)) - bit_index - 1;
+    }
+  }
+  return 0;
+}
+
+void BucketIndex::Insert(int32_t bucket, size_t slot) {
+  assert(slot <= size_);
+  if (slot != size_) {
+    for (auto& entry : buckets_) {
+      for (auto& other_slot : entry.second.slots) {
+        if (other_slot >= slot)
+          ++other_slot;
+      }
+      if (entry.second.highest_slot >= slot)
+        ++entry.second.highest_slot;
+    }
+  }
+  auto& members(buckets_[bucket]);
+  if (members.slots.empty() || slot > members.highest_slot)
+    members.highest_slot = slot;
+  members.slots.push_back(slot);
+  ++size_;
+}
+
+void BucketIndex::Remove(int32_t bucket, size_t slot) {
+  auto bucket_itr(buckets_.find(bucket));
+  assert(bucket_itr != std::end(buckets_));
+  if (bucket_itr == std::end(buckets_))
+    return;
+  auto& members(bucket_itr->second);
+  auto slot_itr(std::find(std::begin(members.slots), std::end(members.slots), slot));
+  assert(slot_itr != std::end(members.slots));
+  if (slot_itr == std::end(members.slots))
+    return;
+  members.slots.erase(slot_itr);
+  if (members.slots.empty())
+    buckets_.erase(bucket_itr);
+  else if (members.highest_slot == slot)
+    members.highest_slot = *std::max_element(std::begin(members.slots), std::end(members.slots));
+  --size_;
+  for (auto& entry : buckets_) {
+    for (auto& other_slot : entry.second.slots) {
+      if (other_slot > slot)
+        --other_slot;
+    }
+    if (entry.second.highest_slot > slot)
+      --entry.second.highest_slot;
+  }
+}
+
+void BucketIndex::Clear() {
+  buckets_.clear();
+  size_ = 0;
+}
+
+// For a target at XOR distance d from the holder, with h the highest set bit of d, every node
+// in bucket b is at distance:
+//   < 2^h from the target if b == h,
+//   in [2^h, 2^(h+1)) if b < h, with bit b of the distance equal to the inverse of bit b of d,
+//   in [2^b, 2^(b+1)) if b > h.
+// So bucket h comes first, then lower buckets whose bit is set in d (highest first), then lower
+// buckets whose bit is clear in d (lowest first), then higher buckets (lowest first).
+std::vector<int32_t> BucketIndex::BucketsInDistanceOrder(const NodeId& target) const {
+  std::vector<int32_t> ordered;
+  ordered.reserve(buckets_.size());
+  if (target == kHolderId_) {
+    for (const auto& entry : buckets_)
+      ordered.push_back(entry.first);
+    return ordered;
+  }
+
+  int32_t highest_bit(Bucket(kHolderId_, target));
+  std::string distance((kHolderId_ ^ target).string());
+  auto equal_itr(buckets_.find(highest_bit));
+  if (equal_itr != std::end(buckets_))
+    ordered.push_back(highest_bit);
+
+  std::vector<int32_t> lower_set, lower_clear;
+  auto lower_end(buckets_.lower_bound(highest_bit));
+  for (auto itr(std::begin(buckets_)); itr != lower_end; ++itr) {
+    if (BitIsSet(distance, itr->first))
+      lower_set.push_back(itr->first);
+    else
+      lower_clear.push_back(itr->first);
+  }
+  ordered.insert(std::end(ordered), lower_set.rbegin(), lower_set.rend());
+  ordered.insert(std::end(ordered), std::begin(lower_clear), std::end(lower_clear));
+  for (auto itr(buckets_.upper_bound(highest_bit)); itr != std::end(buckets_); ++itr)
+    ordered.push_back(itr->first);
+  return ordered;
+}
+
+std::vector<size_t> BucketIndex::ClosestSlots(const NodeId& target, size_t count,
+                                              const NodeIdStore& node_ids) const {
+  assert(node_ids.size() == size_);
+  std::vector<size_t> candidates;
+  count = std::min(count, size_);
+  if (count == 0)
+    return candidates;
+
+  // Every member of a later bucket is further from the target than every member of an earlier
+  // one, so the closest 'count' are among the buckets needed to collect 'count' candidates.
+  for (auto bucket : BucketsInDistanceOrder(target)) {
+    const auto& slots(buckets_.at(bucket).slots);
+    candidates.insert(std::end(candidates), std::begin(slots), std::end(slots));
+    if (candidates.size() >= count)
+      break;
+  }
+  return node_ids.ClosestSlots(target, count, std::move(candidates));
+}
+
+std::vector<size_t> BucketIndex::SortedSlots(const NodeId& target,
+                                             const NodeIdStore& node_ids) const {
+  return ClosestSlots(target, size_, node_ids);
+}
+
+size_t BucketIndex::BucketSize(int32_t bucket) const {
+  auto itr(buckets_.find(bucket));
+  return (itr == std::end(buckets_)) ? 0 : itr->second.slots.size();
+}
+
+size_t BucketIndex::HighestSlot(int32_t bucket) const {
+  assert(BucketSize(bucket) != 0);
+  return buckets_.at(bucket).highest_slot;
+}
+
+std::pair<int32_t, size_t> BucketIndex::FullestBucketFrom(size_t first_slot) const {
+  std::pair<int32_t, size_t> fullest(0, 0);
+  // Higher buckets hold higher slots, so walk down from the top until reaching 'first_slot'.
+  for (auto itr(buckets_.rbegin()); itr != buckets_.rend(); ++itr) {
+    const auto& members(itr->second);
+    if (members.highest_slot < first_slot)
+      break;
+    size_t lowest_slot(members.highest_slot + 1 - members.slots.size());
+    size_t count(members.highest_slot + 1 - std::max(lowest_slot, first_slot));
+    if (count > fullest.second)
+      fullest = std::make_pair(itr->first, count);
+  }
+  return fullest;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,90 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_BUCKET_INDEX_H_
+#define MAIDSAFE_ROUTING_BUCKET_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/node_id_store.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Groups the slots of a routing table's node container by XOR bucket relative to the holder's
+// id.  Bucket numbering matches RoutingTable::SetBucketIndex (bucket 511 is the furthest half of
+// the address space).  Since every member of a bucket lies in a disjoint XOR distance band from
+// any target, the k closest nodes to a target can be found by visiting buckets in distance order
+// and only ranking the members of the buckets actually consumed.  The index never reorders the
+// node container it refers to.
+class BucketIndex {
+ public:
+  explicit BucketIndex(const NodeId& holder_id);
+
+  // Returns the index of the highest bit in which the two ids differ, or 0 if they are equal.
+  static int32_t Bucket(const NodeId& holder_id, const NodeId& node_id);
+
+  // Records that a node belonging to 'bucket' was inserted at 'slot' of the container and
+  // renumbers every slot at or above it, mirroring a vector insert.
+  void Insert(int32_t bucket, size_t slot);
+  // Forgets the node at 'slot' and renumbers every slot above it, mirroring a vector erase.
+  void Remove(int32_t bucket, size_t slot);
+  void Clear();
+
+  // Returns up to 'count' slots of 'node_ids', ordered by increasing distance to 'target'.
+  std::vector<size_t> ClosestSlots(const NodeId& target, size_t count,
+                                   const NodeIdStore& node_ids) const;
+  // Returns every slot of 'node_ids', ordered by increasing distance to 'target'.
+  std::vector<size_t> SortedSlots(const NodeId& target, const NodeIdStore& node_ids) const;
+
+  size_t BucketSize(int32_t bucket) const;
+  // Returns the highest slot held in 'bucket', which must not be empty.  In a container ordered by
+  // distance from the holder this is the bucket's furthest member.
+  size_t HighestSlot(int32_t bucket) const;
+  // Returns the bucket with the most members at or above 'first_slot' and that number, preferring
+  // the higher bucket on a tie, or (0, 0) if there are none.  Only valid for a container ordered by
+  // distance from the holder, in which each bucket occupies a contiguous run of slots.
+  std::pair<int32_t, size_t> FullestBucketFrom(size_t first_slot) const;
+  size_t size() const { return size_; }
+
+ private:
+  struct Members {
+    Members() : slots(), highest_slot(0) {}
+    std::vector<size_t> slots;
+    size_t highest_slot;
+  };
+
+  std::vector<int32_t> BucketsInDistanceOrder(const NodeId& target) const;
+
+  const NodeId kHolderId_;
+  std::map<int32_t, Members> buckets_;
+  size_t size_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_BUCKET_INDEX_H_
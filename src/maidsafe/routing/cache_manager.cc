@@ -30,9 +30,11 @@ namespace maidsafe {
 
 namespace routing {
 
-CacheManager::CacheManager(const NodeId& node_id, Network& network)
+CacheManager::CacheManager(const NodeId& node_id, Network& network,
+                           const RoutingConfig& config)
     : kNodeId_(node_id),
       network_(network),
+      kConfig_(config),
       message_and_caching_functors_(),
       typed_message_and_caching_functors_() {}
 
@@ -110,7 +112,7 @@ bool CacheManager::HandleGetFromCache(protobuf::Message& message) {
           protobuf::Message message_out;
           message_out.set_request(false);
           message_out.set_ack_id(RandomInt32());
-          message_out.set_hops_to_live(Parameters::hops_to_live);
+          message_out.set_hops_to_live(kConfig_.hops_to_live);
           message_out.set_destination_id(message.source_id());
           message_out.set_type(message.type());
           message_out.set_direct(true);
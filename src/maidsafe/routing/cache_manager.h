@@ -22,6 +22,7 @@
 #include <string>
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/routing_config.h"
 
 namespace maidsafe {
 
@@ -35,7 +36,7 @@ class Network;
 
 class CacheManager {
  public:
-  CacheManager(const NodeId& node_id, Network& network);
+  CacheManager(const NodeId& node_id, Network& network, const RoutingConfig& config);
 
   void InitialiseFunctors(const MessageAndCachingFunctors& message_and_caching_functors);
   void InitialiseFunctors(const TypedMessageAndCachingFunctor& typed_message_and_caching_functors);
@@ -52,6 +53,7 @@ class CacheManager {
 
   const NodeId kNodeId_;
   Network& network_;
+  const RoutingConfig kConfig_;
   MessageAndCachingFunctors message_and_caching_functors_;
   TypedMessageAndCachingFunctor typed_message_and_caching_functors_;
 };
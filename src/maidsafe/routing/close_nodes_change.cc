@@ -26,7 +26,7 @@
 #include "cereal/archives/json.hpp"
 #include "cereal/types/vector.hpp"
 
-#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/node_id_store.h"
 #include "maidsafe/routing/utils.h"
 
 namespace maidsafe {
@@ -69,8 +69,9 @@ ConnectionsChange::ConnectionsChange(NodeId this_node_id,
                            }))
             lost_nodes.emplace_back(old_node);
         }
-        assert(lost_nodes.size() <= 1);
-        return (lost_nodes.empty()) ? NodeId() : lost_nodes.at(0);
+        // A batch of additions may displace several nodes; report the closest.
+        return (lost_nodes.empty()) ? NodeId()
+                                    : ClosestByDistance(node_id_, lost_nodes, 1).front();
       }()),
       new_node_([&]() -> NodeId {
         std::vector<NodeId> new_nodes;
@@ -81,21 +82,15 @@ ConnectionsChange::ConnectionsChange(NodeId this_node_id,
                          }))
           new_nodes.emplace_back(new_node);
         }
-        assert(new_nodes.size() <= 1);
-        return (new_nodes.empty()) ? NodeId() : new_nodes.at(0);
+        return (new_nodes.empty()) ? NodeId()
+                                   : ClosestByDistance(node_id_, new_nodes, 1).front();
       }()),
       old_close_nodes_([this](std::vector<NodeId> old_close_nodes_in) -> std::vector<NodeId> {
-        std::sort(std::begin(old_close_nodes_in), std::end(old_close_nodes_in),
-                  [this](const NodeId& lhs, const NodeId& rhs) {
-                    return NodeId::CloserToTarget(lhs, rhs, node_id_);
-                  });
+        SortByDistance(node_id_, old_close_nodes_in);
         return old_close_nodes_in;
       }(old_close_nodes)),
       new_close_nodes_([this](std::vector<NodeId> new_close_nodes_in)-> std::vector<NodeId> {
-        std::sort(std::begin(new_close_nodes_in), std::end(new_close_nodes_in),
-                  [this](const NodeId& lhs, const NodeId& rhs) {
-                    return NodeId::CloserToTarget(lhs, rhs, node_id_);
-                  });
+        SortByDistance(node_id_, new_close_nodes_in);
         return new_close_nodes_in;
       }(new_close_nodes)) {}
 
@@ -143,10 +138,12 @@ ClientNodesChange& ClientNodesChange::operator=(const ClientNodesChange& other)
 
 ClientNodesChange::ClientNodesChange(NodeId this_node_id,
                                      const std::vector<NodeId>& old_close_nodes,
-                                     const std::vector<NodeId>& new_close_nodes)
+                                     const std::vector<NodeId>& new_close_nodes,
+                                     const RoutingConfig& config)
     : ConnectionsChange(this_node_id, old_close_nodes, new_close_nodes) {
-  assert(old_close_nodes.size() <= Parameters::max_routing_table_size);
-  assert(new_close_nodes.size() <= Parameters::max_routing_table_size);
+  assert(old_close_nodes.size() <= config.max_routing_table_size);
+  assert(new_close_nodes.size() <= config.max_routing_table_size);
+  static_cast<void>(config);
 }
 
 std::string ClientNodesChange::ReportConnection() const {
@@ -170,8 +167,11 @@ void swap(ClientNodesChange& lhs, ClientNodesChange& rhs) MAIDSAFE_NOEXCEPT {
 
 // ========================== non-client client close nodes change =================================
 
+CloseNodesChange::CloseNodesChange() : ConnectionsChange(), radius_(), group_size_(0) {}
+
 CloseNodesChange::CloseNodesChange(CloseNodesChange&& other)
-    : ConnectionsChange(std::move(other)), radius_(std::move(other.radius_)) {}
+    : ConnectionsChange(std::move(other)), radius_(std::move(other.radius_)),
+      group_size_(other.group_size_) {}
 
 CloseNodesChange& CloseNodesChange::operator=(CloseNodesChange&& other) {
   node_id_ = std::move(other.node_id_);
@@ -180,80 +180,71 @@ CloseNodesChange& CloseNodesChange::operator=(CloseNodesChange&& other) {
   old_close_nodes_ = std::move(other.old_close_nodes_);
   new_close_nodes_ = std::move(other.new_close_nodes_);
   radius_ = std::move(other.radius_);
+  group_size_ = other.group_size_;
   return *this;
 }
 
 CloseNodesChange& CloseNodesChange::operator=(const CloseNodesChange& other) {
   ConnectionsChange::operator=(other);
   radius_ = other.radius_;
+  group_size_ = other.group_size_;
   return *this;
 }
 
 CloseNodesChange::CloseNodesChange(const NodeId& this_node_id,
                                    const std::vector<NodeId>& old_close_nodes,
-                                   const std::vector<NodeId>& new_close_nodes)
+                                   const std::vector<NodeId>& new_close_nodes,
+                                   const RoutingConfig& config)
     : ConnectionsChange(this_node_id, old_close_nodes, new_close_nodes),
-      radius_([this]() -> crypto::BigInt {
+      radius_([&]() -> crypto::BigInt {
         NodeId fcn_distance;
-        if (new_close_nodes_.size() >= Parameters::closest_nodes_size)
-          fcn_distance = node_id_ ^ new_close_nodes_[Parameters::closest_nodes_size - 1];
+        if (new_close_nodes_.size() >= config.closest_nodes_size)
+          fcn_distance = node_id_ ^ new_close_nodes_[config.closest_nodes_size - 1];
         else
-          fcn_distance = NodeInNthBucket(node_id_, Parameters::closest_nodes_size);
+          fcn_distance = NodeInNthBucket(node_id_, config.closest_nodes_size);
         return (crypto::BigInt(
                     (fcn_distance.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str()) *
-                Parameters::proximity_factor);
-      }()) {
-    assert(old_close_nodes.size() <= Parameters::closest_nodes_size);
-    assert(new_close_nodes.size() <= Parameters::closest_nodes_size);
+                config.proximity_factor);
+      }()),
+      group_size_(config.group_size) {
+    assert(old_close_nodes.size() <= config.closest_nodes_size);
+    assert(new_close_nodes.size() <= config.closest_nodes_size);
 }
 
 CheckHoldersResult CloseNodesChange::CheckHolders(const NodeId& target) const {
   // Handle cases of lower number of group close_nodes nodes
-  size_t group_size_adjust(Parameters::group_size + 1U);
-  size_t old_holders_size = std::min(old_close_nodes_.size(), group_size_adjust);
-  size_t new_holders_size = std::min(new_close_nodes_.size(), group_size_adjust);
-
-  std::vector<NodeId> old_holders(old_holders_size), new_holders(new_holders_size);
-
-  std::partial_sort_copy(std::begin(old_close_nodes_), std::end(old_close_nodes_),
-                         std::begin(old_holders), std::end(old_holders),
-                         [target](const NodeId& lhs, const NodeId& rhs) {
-                           return NodeId::CloserToTarget(lhs, rhs, target);
-                         });
-  std::partial_sort_copy(std::begin(new_close_nodes_), std::end(new_close_nodes_),
-                         std::begin(new_holders), std::end(new_holders),
-                         [target](const NodeId& lhs, const NodeId& rhs) {
-                           return NodeId::CloserToTarget(lhs, rhs, target);
-                         });
+  size_t group_size_adjust(group_size_ + 1U);
+  std::vector<NodeId> old_holders(ClosestByDistance(target, old_close_nodes_, group_size_adjust));
+  std::vector<NodeId> new_holders(ClosestByDistance(target, new_close_nodes_, group_size_adjust));
 
   // Remove target == node ids and adjust holder size
   old_holders.erase(std::remove(std::begin(old_holders), std::end(old_holders), target),
                     std::end(old_holders));
-  if (old_holders.size() > Parameters::group_size) {
-    old_holders.resize(Parameters::group_size);
-    assert(old_holders.size() == Parameters::group_size);
+  if (old_holders.size() > group_size_) {
+    old_holders.resize(group_size_);
+    assert(old_holders.size() == group_size_);
   }
 
   new_holders.erase(std::remove(std::begin(new_holders), std::end(new_holders), target),
                     std::end(new_holders));
-  if (new_holders.size() > Parameters::group_size) {
-    new_holders.resize(Parameters::group_size);
-    assert(new_holders.size() == Parameters::group_size);
+  if (new_holders.size() > group_size_) {
+    new_holders.resize(group_size_);
+    assert(new_holders.size() == group_size_);
   }
 
   CheckHoldersResult holders_result;
   holders_result.proximity_status = GroupRangeStatus::kOutwithRange;
-  if (!new_holders.empty() && ((new_holders.size() < Parameters::group_size) ||
+  if (!new_holders.empty() && ((new_holders.size() < group_size_) ||
                                NodeId::CloserToTarget(node_id_, new_holders.back(), target))) {
     holders_result.proximity_status = GroupRangeStatus::kInRange;
-    if (new_holders.size() == Parameters::group_size)
+    if (new_holders.size() == group_size_)
       new_holders.pop_back();
     new_holders.push_back(node_id_);
   }
 
   if (!old_holders.empty() && NodeId::CloserToTarget(node_id_, old_holders.back(), target)) {
     old_holders.pop_back();
-    if (old_holders.size() == Parameters::group_size)
+    if (old_holders.size() == group_size_)
       old_holders.pop_back();
     old_holders.push_back(node_id_);
   }
@@ -273,15 +264,11 @@ CheckHoldersResult CloseNodesChange::CheckHolders(const NodeId& target) const {
 }
 
 bool CloseNodesChange::CheckIsHolder(const NodeId& target, const NodeId& node_id) const {
-  if (new_close_nodes_.size() < Parameters::group_size)
+  if (new_close_nodes_.size() < group_size_)
     return true;
 
-  std::vector<NodeId> holders(Parameters::group_size);
-  std::partial_sort_copy(std::begin(new_close_nodes_), std::end(new_close_nodes_),
-                         std::begin(holders), std::end(holders),
-                         [target](const NodeId& lhs, const NodeId& rhs) {
-                           return NodeId::CloserToTarget(lhs, rhs, target);
-                         });
+  std::vector<NodeId> holders(ClosestByDistance(target, new_close_nodes_,
+                                                group_size_));
   return (std::find(std::begin(holders), std::end(holders), node_id) != std::end(holders));
 }
 
@@ -297,17 +284,13 @@ std::string CloseNodesChange::ReportConnection() const {
                                new_node_.ToStringEncoded(NodeId::EncodingType::kHex)));
 
     size_t closest_size_adjust(std::min(new_close_nodes_.size(),
-                                        static_cast<size_t>(Parameters::group_size + 1U)));
+                                        static_cast<size_t>(group_size_ + 1U)));
     if (closest_size_adjust != 0) {
-      std::vector<NodeId> closest_nodes(closest_size_adjust);
-      std::partial_sort_copy(std::begin(new_close_nodes_), std::end(new_close_nodes_),
-                             std::begin(closest_nodes), std::end(closest_nodes),
-                             [&](const NodeId& lhs, const NodeId& rhs) {
-                               return NodeId::CloserToTarget(lhs, rhs, this->node_id_);
-                             });
+      std::vector<NodeId> closest_nodes(ClosestByDistance(node_id_, new_close_nodes_,
+                                                          closest_size_adjust));
       if (node_id_ == closest_nodes.front())
         closest_nodes.erase(std::begin(closest_nodes));
-      else if (closest_nodes.size() > Parameters::group_size)
+      else if (closest_nodes.size() > group_size_)
         closest_nodes.pop_back();
 
       if (closest_nodes.size() != 0) {
@@ -325,6 +308,7 @@ void swap(CloseNodesChange& lhs, CloseNodesChange& rhs) MAIDSAFE_NOEXCEPT {
   using std::swap;
   swap(static_cast<ConnectionsChange&>(lhs), static_cast<ConnectionsChange&>(rhs));
   swap(lhs.radius_, rhs.radius_);
+  swap(lhs.group_size_, rhs.group_size_);
 }
 
 }  // namespace routing
@@ -18,51 +18,158 @@
 
 #include "maidsafe/routing/firewall.h"
 
-#include "maidsafe/routing/parameters.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 
 namespace maidsafe {
 
 namespace routing {
 
-bool operator < (const Firewall::ProcessedEntry& lhs, const Firewall::ProcessedEntry& rhs) {
-  return (lhs.message_id == rhs.message_id) ? lhs.source < rhs.source
-                                            : lhs.message_id < rhs.message_id;
+namespace {
+
+const size_t kInitialSlotCount(16);
+
+// Ids are uniformly distributed, so their leading bytes need no mixing, but the message IDs from
+// one source are often sequential.
+uint64_t Hash(const std::string& raw_source, int32_t message_id) {
+  uint64_t hash(0);
+  std::memcpy(&hash, raw_source.data(), std::min(sizeof(hash), raw_source.size()));
+  hash ^= static_cast<uint32_t>(message_id) * 0x9E3779B97F4A7C15ULL;
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+}  // unnamed namespace
+
+Firewall::Generation::Generation()
+    : birth_time(common::Clock::now()), slots_(kInitialSlotCount), size_(0) {}
+
+bool Firewall::Generation::Contains(const std::string& raw_source, int32_t message_id,
+                                    uint64_t hash) const {
+  if (size_ == 0)
+    return false;
+  const size_t kMask(slots_.size() - 1);
+  for (size_t index(hash & kMask); slots_[index].used; index = (index + 1) & kMask) {
+    const Slot& slot(slots_[index]);
+    if (slot.hash == hash && slot.message_id == message_id &&
+        std::memcmp(slot.source, raw_source.data(), NodeId::kSize) == 0)
+      return true;
+  }
+  return false;
+}
+
+void Firewall::Generation::Insert(const std::string& raw_source, int32_t message_id,
+                                  uint64_t hash) {
+  assert(raw_source.size() == NodeId::kSize);
+  if ((size_ + 1) * 2 > slots_.size())  // Keeps the load factor at no more than a half
+    Grow();
+  const size_t kMask(slots_.size() - 1);
+  size_t index(hash & kMask);
+  while (slots_[index].used)
+    index = (index + 1) & kMask;
+  Slot& slot(slots_[index]);
+  slot.hash = hash;
+  slot.message_id = message_id;
+  slot.used = true;
+  std::memcpy(slot.source, raw_source.data(), NodeId::kSize);
+  ++size_;
+}
+
+void Firewall::Generation::Clear() {
+  // Shrinks to suit the pairs just held, so that a burst doesn't pin its memory indefinitely.
+  size_t wanted(kInitialSlotCount);
+  while (wanted < size_ * 2)
+    wanted *= 2;
+  if (slots_.size() >= wanted * 4) {
+    std::vector<Slot>(wanted).swap(slots_);
+  } else if (size_ != 0) {
+    for (auto& slot : slots_)
+      slot.used = false;
+  }
+  size_ = 0;
+}
+
+void Firewall::Generation::Grow() {
+  std::vector<Slot> old_slots(slots_.size() * 2);
+  old_slots.swap(slots_);
+  const size_t kMask(slots_.size() - 1);
+  for (const auto& old_slot : old_slots) {
+    if (!old_slot.used)
+      continue;
+    size_t index(old_slot.hash & kMask);
+    while (slots_[index].used)
+      index = (index + 1) & kMask;
+    slots_[index] = old_slot;
+  }
 }
 
-Firewall::Firewall()
-    : mutex_(), history_() {}
+Firewall::Firewall(const RoutingConfig& config)
+    : kGenerationSpan_(
+          std::chrono::duration_cast<common::Clock::duration>(config.firewall_message_life) /
+          (kGenerationCount - 1)),
+      kMaxGenerationSize_(std::max<size_t>(
+          1, config.firewall_max_history / (kShardCount * kGenerationCount))),
+      shards_() {}
 
 bool Firewall::Add(const NodeId& source_id, int32_t message_id) {
+  return Add(source_id, message_id, common::Clock::now());
+}
+
+bool Firewall::Add(const NodeId& source_id, int32_t message_id, common::Clock::time_point now) {
   if (!source_id.IsValid())
     return false;
 
-  std::unique_lock<std::mutex> lock(mutex_);
-  auto entry(ProcessedEntry(source_id, message_id));
-  auto found(history_.find(entry));
-  if (found != std::end(history_))
-    return false;
+  const std::string kRawSource(source_id.string());
+  const uint64_t kHash(Hash(kRawSource, message_id));
+  // High bits pick the shard, leaving the low bits to pick the slot.
+  Shard& shard(shards_[(kHash >> 48) % kShardCount]);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  Rotate(shard, now);
+  for (const auto& generation : shard.generations) {
+    if (generation.Contains(kRawSource, message_id, kHash))
+      return false;
+  }
+  shard.generations[shard.current].Insert(kRawSource, message_id, kHash);
+  return true;
+}
 
-  history_.insert(entry);
-  if (history_.size() % Parameters::firewall_history_cleanup_factor == 0)
-    Remove(lock);
+void Firewall::Rotate(Shard& shard, common::Clock::time_point now) {
+  // A pair is taken by the current generation within a span of its birth, and that generation is
+  // dropped only after kGenerationCount - 1 more spans, so is held for at least the message life.
+  const auto kAge(now - shard.generations[shard.current].birth_time);
+  if (kAge < kGenerationSpan_ && shard.generations[shard.current].size() < kMaxGenerationSize_)
+    return;
+  if (kAge >= kGenerationSpan_ * static_cast<int>(kGenerationCount)) {
+    // Idle for long enough that everything held has expired.
+    for (auto& generation : shard.generations)
+      generation.Clear();
+  }
+  shard.current = (shard.current + 1) % kGenerationCount;
+  shard.generations[shard.current].Clear();
+  shard.generations[shard.current].birth_time = now;
+}
 
-  return true;
+size_t Firewall::size() {
+  size_t size(0);
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto& generation : shard.generations)
+      size += generation.size();
+  }
+  return size;
 }
 
-void Firewall::Remove(std::unique_lock<std::mutex>& lock) {
-  assert(lock.owns_lock());
-  static_cast<void>(lock);
-  using  accounts_by_update_time = boost::multi_index::index<ProcessedEntrySet, BirthTimeTag>::type;
-  accounts_by_update_time& birth_time_index =
-      boost::multi_index::get<BirthTimeTag>(history_);
-  ProcessedEntry dummy(NodeId(RandomString(NodeId::kSize)), RandomInt32());
-  auto upper(std::upper_bound(
-      std::begin(birth_time_index), std::end(birth_time_index), dummy,
-      [this](const ProcessedEntry& lhs, const ProcessedEntry& rhs) {
-        return (lhs.birth_time - rhs.birth_time < Parameters::firewall_message_life);
-      }));
-  if (upper != std::end(birth_time_index))
-    birth_time_index.erase(std::begin(birth_time_index), upper);
+size_t Firewall::capacity() {
+  size_t capacity(0);
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto& generation : shard.generations)
+      capacity += generation.capacity();
+  }
+  return capacity;
 }
 
 }  // namespace routing
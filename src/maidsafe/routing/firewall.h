@@ -19,14 +19,17 @@
 #ifndef MAIDSAFE_ROUTING_FIREWALL_H_
 #define MAIDSAFE_ROUTING_FIREWALL_H_
 
-#include "boost/multi_index_container.hpp"
-#include "boost/multi_index/global_fun.hpp"
-#include "boost/multi_index/member.hpp"
-#include "boost/multi_index/ordered_index.hpp"
-#include "boost/multi_index/identity.hpp"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "maidsafe/common/clock.h"
+#include "maidsafe/common/node_id.h"
+
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/routing_config.h"
 
 namespace maidsafe {
 
@@ -35,48 +38,85 @@ namespace routing {
 
 namespace test {
   class FirewallTest_BEH_AddRemove_Test;
+  class FirewallTest_BEH_Expiry_Test;
+  class FirewallTest_BEH_BoundedMemory_Test;
 }
 
+// Remembers which (source, message ID) pairs have been processed, for at least
+// firewall_message_life.  The history is split into shards, each with its own lock, and each
+// shard into time-sliced generations; the oldest generation is dropped wholesale once the life
+// has passed, rather than entries being erased one by one.  Memory is bounded by
+// firewall_max_history: a generation reaching its share of that is retired early, so under a
+// flood pairs are forgotten sooner than the life.
 class Firewall {
  public:
-  Firewall();
+  explicit Firewall(const RoutingConfig& config = RoutingConfig());
   Firewall& operator=(const Firewall&) = delete;
   Firewall& operator=(const Firewall&&) = delete;
   Firewall(const Firewall&) = delete;
   Firewall(const Firewall&&) = delete;
 
+  // Returns false if 'source_id' is invalid or the pair has already been added, true otherwise.
   bool Add(const NodeId& source_id, int32_t message_id);
-  void Remove(std::unique_lock<std::mutex>& lock);
-
-  struct ProcessedEntry {
-    ProcessedEntry(const NodeId& source_in, int32_t messsage_id_in)
-        : source(source_in), message_id(messsage_id_in), birth_time(common::Clock::now()) {}
-    ProcessedEntry Key() const { return *this; }
-    NodeId source;
-    int32_t message_id;
-    common::Clock::time_point birth_time;
-  };
 
  private:
   friend class test::FirewallTest_BEH_AddRemove_Test;
+  friend class test::FirewallTest_BEH_Expiry_Test;
+  friend class test::FirewallTest_BEH_BoundedMemory_Test;
+
+  static const size_t kShardCount = 16;
+  static const size_t kGenerationCount = 4;
+
+  // Open-addressing (linear probing) set of pairs, which is only ever cleared as a whole, so needs
+  // no tombstones.
+  class Generation {
+   public:
+    Generation();
+    // 'raw_source' is the source's NodeId::kSize bytes.
+    bool Contains(const std::string& raw_source, int32_t message_id, uint64_t hash) const;
+    // The pair must not already be held.
+    void Insert(const std::string& raw_source, int32_t message_id, uint64_t hash);
+    // Keeps the capacity, which will be needed again by the next slice of similar traffic, unless
+    // it is far more than the pairs just held needed.
+    void Clear();
+    size_t size() const { return size_; }
+    size_t capacity() const { return slots_.size(); }
 
-  struct BirthTimeTag {};
+    common::Clock::time_point birth_time;
 
-  typedef boost::multi_index_container<
-      ProcessedEntry,
-      boost::multi_index::indexed_by<
-          boost::multi_index::ordered_unique<boost::multi_index::identity<ProcessedEntry>>,
-      boost::multi_index::ordered_non_unique<
-          boost::multi_index::tag<BirthTimeTag>,
-          BOOST_MULTI_INDEX_MEMBER(ProcessedEntry, common::Clock::time_point, birth_time)>
-    >
-  > ProcessedEntrySet;
+   private:
+    struct Slot {
+      uint64_t hash;
+      int32_t message_id;
+      bool used;
+      unsigned char source[NodeId::kSize];
+    };
 
-  std::mutex mutex_;
-  ProcessedEntrySet history_;
-};
+    void Grow();
 
-bool operator > (const Firewall::ProcessedEntry& lhs, const Firewall::ProcessedEntry& rhs);
+    std::vector<Slot> slots_;
+    size_t size_;
+  };
+
+  // 'generations' is a ring in which 'current' takes the new pairs.
+  struct Shard {
+    Shard() : mutex(), generations(), current(0) {}
+    std::mutex mutex;
+    std::array<Generation, kGenerationCount> generations;
+    size_t current;
+  };
+
+  bool Add(const NodeId& source_id, int32_t message_id, common::Clock::time_point now);
+  // Called with the shard's mutex locked.  Starts a new generation once the current one has taken
+  // pairs for a whole span, or is full, dropping the oldest.
+  void Rotate(Shard& shard, common::Clock::time_point now);
+  size_t size();
+  size_t capacity();
+
+  const common::Clock::duration kGenerationSpan_;
+  const size_t kMaxGenerationSize_;
+  std::array<Shard, kShardCount> shards_;
+};
 
 }  // namespace routing
 
@@ -0,0 +1,91 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/flow_control.h"
+
+#include <utility>
+
+namespace maidsafe {
+
+namespace routing {
+
+FlowControl::FlowControl(const RoutingConfig& config)
+    : kMaxInFlight_(config.max_messages_in_flight),
+      kMaxInFlightPerHop_(config.max_messages_in_flight_per_hop),
+      mutex_(),
+      credits_(),
+      in_flight_per_hop_(),
+      refused_(false),
+      ready_() {}
+
+bool FlowControl::Acquire(int32_t ack_id, const NodeId& next_hop) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (credits_.count(ack_id) != 0)
+    return true;
+  auto& hop_in_flight(in_flight_per_hop_[next_hop]);
+  if ((kMaxInFlight_ != 0 && credits_.size() >= kMaxInFlight_) ||
+      (kMaxInFlightPerHop_ != 0 && hop_in_flight >= kMaxInFlightPerHop_)) {
+    if (hop_in_flight == 0)
+      in_flight_per_hop_.erase(next_hop);
+    refused_ = true;
+    return false;
+  }
+  ++hop_in_flight;
+  credits_.insert(std::make_pair(ack_id, next_hop));
+  return true;
+}
+
+void FlowControl::Release(int32_t ack_id) {
+  std::function<void()> ready;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto credit(credits_.find(ack_id));
+    if (credit == std::end(credits_))
+      return;
+    auto hop(in_flight_per_hop_.find(credit->second));
+    if (--hop->second == 0)
+      in_flight_per_hop_.erase(hop);
+    credits_.erase(credit);
+    if (!refused_)
+      return;
+    refused_ = false;
+    ready = ready_;
+  }
+  if (ready)
+    ready();
+}
+
+void FlowControl::SetReadyFunctor(std::function<void()> ready) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ready_ = std::move(ready);
+}
+
+size_t FlowControl::in_flight() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return credits_.size();
+}
+
+size_t FlowControl::in_flight(const NodeId& next_hop) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto hop(in_flight_per_hop_.find(next_hop));
+  return hop == std::end(in_flight_per_hop_) ? 0 : hop->second;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,71 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_FLOW_CONTROL_H_
+#define MAIDSAFE_ROUTING_FLOW_CONTROL_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/routing_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Limits the messages sent by the application which are in flight, i.e. not yet acked or given
+// up on, both in total and via each next hop.  A send takes a credit keyed by its ack ID, which is
+// returned once the ack arrives, so a producer faster than the network is refused rather than
+// queueing without bound.  A limit of zero is no limit.
+class FlowControl {
+ public:
+  explicit FlowControl(const RoutingConfig& config = RoutingConfig());
+
+  // Takes a credit for the message with 'ack_id' to be sent via 'next_hop'.  Returns false, taking
+  // nothing, if either limit has been reached.
+  bool Acquire(int32_t ack_id, const NodeId& next_hop);
+  // Returns the credit taken for 'ack_id', if it is still held.
+  void Release(int32_t ack_id);
+  // 'ready' is called, outside any lock, when a credit is returned after Acquire has failed.
+  void SetReadyFunctor(std::function<void()> ready);
+
+  size_t in_flight() const;
+  size_t in_flight(const NodeId& next_hop) const;
+
+ private:
+  FlowControl(const FlowControl&);
+  FlowControl(const FlowControl&&);
+  FlowControl& operator=(const FlowControl&);
+
+  const unsigned int kMaxInFlight_, kMaxInFlightPerHop_;
+  mutable std::mutex mutex_;
+  std::map<int32_t, NodeId> credits_;
+  std::map<NodeId, size_t> in_flight_per_hop_;
+  bool refused_;
+  std::function<void()> ready_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_FLOW_CONTROL_H_
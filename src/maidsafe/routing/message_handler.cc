@@ -18,6 +18,8 @@
 
 #include "maidsafe/routing/message_handler.h"
 
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "maidsafe/common/log.h"
@@ -27,6 +29,7 @@
 #include "maidsafe/routing/message.h"
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/network_utils.h"
+#include "maidsafe/routing/outbound_message.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/service.h"
@@ -36,19 +39,33 @@ namespace maidsafe {
 
 namespace routing {
 
+namespace {
+
+// Copies all of 'message' but its payload.
+protobuf::Message CopyWithoutPayload(protobuf::Message& message) {
+  protobuf::Message payload;
+  payload.mutable_data()->Swap(message.mutable_data());
+  protobuf::Message copy(message);
+  message.mutable_data()->Swap(payload.mutable_data());
+  return copy;
+}
+
+}  // unnamed namespace
+
 MessageHandler::MessageHandler(RoutingTable& routing_table,
                                ClientRoutingTable& client_routing_table, Network& network,
                                Timer<std::string>& timer, NetworkUtils& network_utils,
-                               BoostAsioService& asio_service)
+                               BoostAsioService& asio_service, TimingWheel& timing_wheel)
     : routing_table_(routing_table),
       client_routing_table_(client_routing_table),
       network_utils_(network_utils),
       network_(network),
       cache_manager_(routing_table_.client_mode()
                          ? nullptr
-                         : (new CacheManager(routing_table_.kNodeId(), network_))),
+                         : (new CacheManager(routing_table_.kNodeId(), network_,
+                                             routing_table_.config()))),
       timer_(timer),
-      public_key_holder_(asio_service, network),
+      public_key_holder_(asio_service, timing_wheel, network),
       response_handler_(new ResponseHandler(routing_table, client_routing_table, network_,
                                             public_key_holder_)),
       service_(new Service(routing_table, client_routing_table, network_, public_key_holder_)),
@@ -78,10 +95,13 @@ void MessageHandler::HandleRoutingMessage(protobuf::Message& message) {
       message.request() ? service_->GetGroup(message)
                         : response_handler_->GetGroup(timer_, message);
       break;
-    case MessageType::kAcknowledgement:
-      network_utils_.acknowledgement_.HandleMessage(message.ack_id());
+    case MessageType::kAcknowledgement: {
+      std::vector<AckId> ack_ids(1, message.ack_id());
+      ack_ids.insert(std::end(ack_ids), message.acked_ids().begin(), message.acked_ids().end());
+      network_utils_.acknowledgement_.HandleMessage(ack_ids);
       message.Clear();
       break;
+    }
     case MessageType::kInformClientOfNewCloseNode:
       assert(message.request());
       response_handler_->InformClientOfNewCloseNode(message);
@@ -93,7 +113,7 @@ void MessageHandler::HandleRoutingMessage(protobuf::Message& message) {
   if (!request || !message.IsInitialized())
     return;
 
-  message.set_ack_id(network_utils_.acknowledgement_.GetId());
+  network_utils_.acknowledgement_.SetAckId(message);
 
   if (message.destination_id() == routing_table_.kNodeId().string())
     if (RelayDirectMessageIfNeeded(message))
@@ -113,39 +133,41 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
                   << "] rcvd : " << MessageTypeString(message) << " from "
                   << HexSubstr(message.source_id()) << "   (id: " << message.id()
                   << ")  --NodeLevel--";
+    // The reply needs only the request's header, so the payload is not copied into the functor.
+    const protobuf::Message request(CopyWithoutPayload(message));
     ReplyFunctor response_functor = [=](const std::string& reply_message) {
       if (reply_message.empty()) {
         return;
       }
       LOG(kSuccess) << " [" << routing_table_.kNodeId() << "] repl : "
-                    << MessageTypeString(message) << " from " << HexSubstr(message.source_id())
-                    << "   (id: " << message.id() << ")  --NodeLevel Replied--";
+                    << MessageTypeString(request) << " from " << HexSubstr(request.source_id())
+                    << "   (id: " << request.id() << ")  --NodeLevel Replied--";
       protobuf::Message message_out;
       message_out.set_request(false);
       message_out.set_ack_id(RandomUint32());
-      message_out.set_hops_to_live(Parameters::hops_to_live);
-      message_out.set_destination_id(message.source_id());
-      message_out.set_type(message.type());
+      message_out.set_hops_to_live(routing_table_.config().hops_to_live);
+      message_out.set_destination_id(request.source_id());
+      message_out.set_type(request.type());
       message_out.set_direct(true);
       message_out.clear_data();
       message_out.set_client_node(routing_table_.client_mode());
-      message_out.set_routing_message(message.routing_message());
+      message_out.set_routing_message(request.routing_message());
       message_out.add_data(reply_message);
-      if (IsCacheableGet(message))
+      if (IsCacheableGet(request))
         message_out.set_cacheable(static_cast<int32_t>(Cacheable::kPut));
       message_out.set_last_id(routing_table_.kNodeId().string());
       message_out.set_source_id(routing_table_.kNodeId().string());
-      message_out.set_ack_id(network_utils_.acknowledgement_.GetId());
-      if (message.has_id())
-        message_out.set_id(message.id());
+      network_utils_.acknowledgement_.SetAckId(message_out);
+      if (request.has_id())
+        message_out.set_id(request.id());
       else
         LOG(kWarning) << "Message to be sent back had no ID.";
 
-      if (message.has_relay_id())
-        message_out.set_relay_id(message.relay_id());
+      if (request.has_relay_id())
+        message_out.set_relay_id(request.relay_id());
 
-      if (message.has_relay_connection_id()) {
-        message_out.set_relay_connection_id(message.relay_connection_id());
+      if (request.has_relay_connection_id()) {
+        message_out.set_relay_connection_id(request.relay_connection_id());
       }
       if (routing_table_.client_mode() &&
           routing_table_.kNodeId().string() == message_out.destination_id()) {
@@ -162,7 +184,7 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
       message_received_functor_(message.data(0), response_functor);
     } else {
       try {
-        InvokeTypedMessageReceivedFunctor(message);  // typed message received
+        InvokeTypedMessageReceivedFunctor(message);  // typed message received; takes the payload
       } catch (...) {
         LOG(kError) << "InvokeTypedMessageReceivedFunctor error";
       }
@@ -171,7 +193,7 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
     try {
       if (!message.has_id() || message.data_size() != 1)
         BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
-      timer_.AddResponse(message.id(), message.data(0));
+      timer_.AddResponse(message.id(), std::move(*message.mutable_data(0)));
     }
     catch (const maidsafe_error& e) {
       LOG(kError) << e.what();
@@ -210,8 +232,9 @@ void MessageHandler::HandleDirectMessageAsClosestNode(protobuf::Message& message
   // Dropping direct messages if this node is closest and destination node is not in routing_table_
   // or client_routing_table_.
   NodeId destination_node_id(message.destination_id());
-  if (routing_table_.IsThisNodeClosestTo(destination_node_id)) {
-    if (routing_table_.Contains(destination_node_id) ||
+  auto snapshot(routing_table_.Snapshot());
+  if (snapshot->IsThisNodeClosestTo(destination_node_id)) {
+    if (snapshot->Contains(destination_node_id) ||
         client_routing_table_.Contains(destination_node_id)) {
       return network_.SendToClosestNode(message);
     } else if (!message.has_visited() || !message.visited()) {
@@ -242,19 +265,21 @@ void MessageHandler::HandleGroupMessageAsCloseNode(protobuf::Message& message) {
   assert(!message.direct());
 
   NodeId destination_id(message.destination_id());
-  auto close_nodes(routing_table_.GetClosestNodes(destination_id, Parameters::group_size + 1));
+  const unsigned int kGroupSize(routing_table_.config().group_size);
+  auto snapshot(routing_table_.Snapshot());
+  auto close_nodes(snapshot->GetClosestNodes(destination_id, kGroupSize + 1));
   close_nodes.erase(std::remove_if(std::begin(close_nodes), std::end(close_nodes),
                                    [&destination_id](const NodeInfo& node_info) {
                                      return node_info.id == destination_id;
                                    }), std::end(close_nodes));
-  while (close_nodes.size() > Parameters::group_size)
+  while (close_nodes.size() > kGroupSize)
     close_nodes.pop_back();
 
   std::string group_members;
-  if (close_nodes.size() == Parameters::group_size &&
+  if (close_nodes.size() == kGroupSize &&
       routing_table_.kNodeId() != destination_id &&
       NodeId::CloserToTarget(routing_table_.kNodeId(),
-                             close_nodes.at(Parameters::group_size - 1).id, destination_id)) {
+                             close_nodes.at(kGroupSize - 1).id, destination_id)) {
     close_nodes.erase(--close_nodes.rbegin().base());
     group_members += "[" + DebugId(routing_table_.kNodeId()) + "]";
   }
@@ -263,15 +288,22 @@ void MessageHandler::HandleGroupMessageAsCloseNode(protobuf::Message& message) {
   for (const auto& i : close_nodes)
     group_members += std::string("[" + DebugId(i.id) + "]");
 
+  // Every group member gets the same message bar its per-hop fields, so it is serialised once.
+  // 'message' itself is left as received, as its ack fields are needed for the ack sent below.
+  const OutboundMessage kOutbound(message);
   for (const auto& i : close_nodes) {
-    message.clear_ack_node_ids();
-    message.set_ack_id(0);
-    message.set_destination_id(i.id.string());
+    auto set_hop_fields([&i](protobuf::Message& hop_fields) {
+      hop_fields.clear_ack_node_ids();
+      hop_fields.set_ack_id(0);
+      hop_fields.set_destination_id(i.id.string());
+    });
     NodeInfo node;
-    if (routing_table_.GetNodeInfo(i.id, node)) {
-      network_.SendToDirect(message, node.id, node.connection_id);
+    if (snapshot->GetNodeInfo(i.id, node)) {
+      network_.SendToDirect(kOutbound.WithHopFields(set_hop_fields), node.id, node.connection_id);
     } else {
-      network_.SendToClosestNode(message);
+      protobuf::Message copy(message);
+      set_hop_fields(copy);
+      network_.SendToClosestNode(copy);
     }
   }
 
@@ -280,10 +312,12 @@ void MessageHandler::HandleGroupMessageAsCloseNode(protobuf::Message& message) {
     return;
   }
 
+  // Acks the previous hop, or the source if it asked for an end-to-end ack.
   network_.SendAck(message);
 
-  if (close_nodes.size() < Parameters::group_size) {
+  if (close_nodes.size() < kGroupSize) {
     message.clear_ack_node_ids();
+    message.set_ack_id(0);
     message.set_destination_id(routing_table_.kNodeId().string());
 
     if (IsRoutingMessage(message)) {
@@ -368,7 +402,7 @@ void MessageHandler::HandleMessage(protobuf::Message& message) {
 
   // This node is in closest proximity to this message
   if (routing_table_.IsThisNodeInRange(NodeId(message.destination_id()),
-                                       Parameters::closest_nodes_size)) {
+                                       routing_table_.config().closest_nodes_size)) {
     return HandleMessageAsClosestNode(message);
   } else {
     return HandleMessageAsFarNode(message);
@@ -411,7 +445,7 @@ void MessageHandler::HandleRelayRequest(protobuf::Message& message) {
     return HandleDirectRelayRequestMessageAsClosestNode(message);
   } else if (!message.direct() &&
              routing_table_.IsThisNodeInRange(NodeId(message.destination_id()),
-                                              Parameters::closest_nodes_size)) {
+                                              routing_table_.config().closest_nodes_size)) {
     return HandleGroupRelayRequestMessageAsCloseNode(message);
   }
 
@@ -425,8 +459,9 @@ void MessageHandler::HandleDirectRelayRequestMessageAsClosestNode(protobuf::Mess
   // Dropping direct messages if this node is closest and destination node is not in routing_table_
   // or client_routing_table_.
   NodeId destination_node_id(message.destination_id());
-  if (routing_table_.IsThisNodeClosestTo(destination_node_id)) {
-    if (routing_table_.Contains(destination_node_id) ||
+  auto snapshot(routing_table_.Snapshot());
+  if (snapshot->IsThisNodeClosestTo(destination_node_id)) {
+    if (snapshot->Contains(destination_node_id) ||
         client_routing_table_.Contains(destination_node_id)) {
       message.set_source_id(routing_table_.kNodeId().string());
       return network_.SendToClosestNode(message);
@@ -516,25 +551,33 @@ void MessageHandler::HandleGroupMessageToSelfId(protobuf::Message& message) {
   HandleGroupMessageAsCloseNode(message);
 }
 
-void MessageHandler::InvokeTypedMessageReceivedFunctor(const protobuf::Message& proto_message) {
+void MessageHandler::InvokeTypedMessageReceivedFunctor(protobuf::Message& proto_message) {
+  if (proto_message.data_size() != 1) {
+    LOG(kWarning) << "Dropping typed message with " << proto_message.data_size() << " payloads.";
+    return;
+  }
   if ((!proto_message.has_group_source() && !proto_message.has_group_destination()) &&
       typed_message_received_functors_.single_to_single) {  // Single to Single
-    typed_message_received_functors_.single_to_single(CreateSingleToSingleMessage(proto_message));
+    typed_message_received_functors_.single_to_single(
+        TakeTypedMessage(proto_message, &CreateSingleToSingleMessage));
   } else if ((!proto_message.has_group_source() && proto_message.has_group_destination()) &&
              typed_message_received_functors_.single_to_group) {
     // Single to Group
     if (proto_message.has_relay_id() && proto_message.has_relay_connection_id()) {
       typed_message_received_functors_.single_to_group_relay(
-          CreateSingleToGroupRelayMessage(proto_message));
+          TakeTypedMessage(proto_message, &CreateSingleToGroupRelayMessage));
     } else {
-      typed_message_received_functors_.single_to_group(CreateSingleToGroupMessage(proto_message));
+      typed_message_received_functors_.single_to_group(
+          TakeTypedMessage(proto_message, &CreateSingleToGroupMessage));
     }
   } else if ((proto_message.has_group_source() && !proto_message.has_group_destination()) &&
              typed_message_received_functors_.group_to_single) {
-    typed_message_received_functors_.group_to_single(CreateGroupToSingleMessage(proto_message));
+    typed_message_received_functors_.group_to_single(
+        TakeTypedMessage(proto_message, &CreateGroupToSingleMessage));
   } else if ((proto_message.has_group_source() && proto_message.has_group_destination()) &&
              typed_message_received_functors_.group_to_group) {  // Group to Group
-    typed_message_received_functors_.group_to_group(CreateGroupToGroupMessage(proto_message));
+    typed_message_received_functors_.group_to_group(
+        TakeTypedMessage(proto_message, &CreateGroupToGroupMessage));
   } else {
     assert(false);
   }
@@ -46,6 +46,7 @@ class MessageHandlerTest_BEH_HandleInvalidMessage_Test;
 class MessageHandlerTest_BEH_HandleRelay_Test;
 class MessageHandlerTest_DISABLED_BEH_HandleGroupMessage_Test;
 class MessageHandlerTest_BEH_HandleNodeLevelMessage_Test;
+class MessageHandlerTest_BEH_GroupMessageAcks_Test;
 class MessageHandlerTest_BEH_ClientRoutingTable_Test;
 }
 
@@ -83,7 +84,8 @@ class MessageHandler {
  public:
   MessageHandler(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
                  Network& network, Timer<std::string>& timer,
-                 NetworkUtils& network_utils, BoostAsioService& asio_service);
+                 NetworkUtils& network_utils, BoostAsioService& asio_service,
+                 TimingWheel& timing_wheel);
   void HandleMessage(protobuf::Message& message);
   void set_typed_message_and_caching_functor(TypedMessageAndCachingFunctor functors);
   void set_message_and_caching_functor(MessageAndCachingFunctors functors);
@@ -114,12 +116,14 @@ class MessageHandler {
   void StoreCacheCopy(const protobuf::Message& message);
   bool IsValidCacheableGet(const protobuf::Message& message);
   bool IsValidCacheablePut(const protobuf::Message& message);
-  void InvokeTypedMessageReceivedFunctor(const protobuf::Message& proto_message);
+  // Moves the payload out of 'proto_message' into the typed message.
+  void InvokeTypedMessageReceivedFunctor(protobuf::Message& proto_message);
   friend class test::MessageHandlerTest;
   friend class test::MessageHandlerTest_BEH_HandleInvalidMessage_Test;
   friend class test::MessageHandlerTest_BEH_HandleRelay_Test;
   friend class test::MessageHandlerTest_DISABLED_BEH_HandleGroupMessage_Test;
   friend class test::MessageHandlerTest_BEH_HandleNodeLevelMessage_Test;
+  friend class test::MessageHandlerTest_BEH_GroupMessageAcks_Test;
   friend class test::MessageHandlerTest_BEH_ClientRoutingTable_Test;
   friend class test::GenericNode;
 
@@ -18,6 +18,9 @@
 
 #include "maidsafe/routing/network.h"
 
+#include <chrono>
+#include <vector>
+
 #include "boost/date_time/posix_time/posix_time_config.hpp"
 #include "boost/filesystem/path.hpp"
 
@@ -29,6 +32,7 @@
 #include "maidsafe/routing/bootstrap_utils.h"
 #include "maidsafe/routing/client_routing_table.h"
 #include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/priority_scheduler.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
@@ -49,7 +53,7 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
 namespace routing {
 
 Network::Network(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
-                 Acknowledgement& acknowledgement)
+                 Acknowledgement& acknowledgement, BoostAsioService& asio_service)
     : running_(true),
       running_mutex_(),
       bootstrap_attempt_(0),
@@ -59,7 +63,20 @@ Network::Network(RoutingTable& routing_table, ClientRoutingTable& client_routing
       client_routing_table_(client_routing_table),
       acknowledgement_(acknowledgement),
       nat_type_(rudp::NatType::kUnknown),
-      rudp_() {}
+      rudp_(),
+      retry_scheduler_(asio_service, routing_table.config()),
+      messages_sent_(0),
+      send_coalescer_(asio_service,
+                      [this](const NodeId& peer_id, const std::string& serialised,
+                             const rudp::MessageSentFunctor& message_sent_functor) {
+                        {
+                          std::lock_guard<std::mutex> lock(running_mutex_);
+                          if (!running_)
+                            return;
+                        }
+                        rudp_.Send(peer_id, serialised, message_sent_functor);
+                      },
+                      routing_table.config()) {}
 
 Network::~Network() {
   std::lock_guard<std::mutex> lock(running_mutex_);
@@ -156,31 +173,43 @@ void Network::Remove(const NodeId& peer_id) {
   rudp_.Remove(peer_id);
 }
 
-void Network::RudpSend(const NodeId& peer_id, const protobuf::Message& message,
+void Network::RudpSend(const NodeId& peer_id, const OutboundMessage& message,
                             const rudp::MessageSentFunctor& message_sent_functor) {
   {
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
       return;
   }
-  rudp_.Send(peer_id, message.SerializeAsString(), message_sent_functor);
+  ++messages_sent_;
+  send_coalescer_.Send(peer_id, message.body(), message.hop_fields(), message_sent_functor);
+  // Control messages do not wait out the coalescing window; any batch for the peer goes with them.
+  if (Priority(message.message()) == MessagePriority::kControl)
+    send_coalescer_.Flush(peer_id);
 }
 
 void Network::SendToDirect(const protobuf::Message& message, const NodeId& peer_connection_id,
                            const rudp::MessageSentFunctor& message_sent_functor) {
-  RudpSend(peer_connection_id, message, message_sent_functor ? message_sent_functor : nullptr);
+  RudpSend(peer_connection_id, OutboundMessage(message),
+           message_sent_functor ? message_sent_functor : nullptr);
 }
 
 void Network::SendToDirect(protobuf::Message& message, const NodeId& peer_node_id,
                            const NodeId& peer_connection_id) {
   AdjustRouteHistory(message);
-  SendTo(message, peer_node_id, peer_connection_id);
+  SendTo(OutboundMessage(message), peer_node_id, peer_connection_id);
+}
+
+void Network::SendToDirect(const OutboundMessage& message, const NodeId& peer_node_id,
+                           const NodeId& peer_connection_id) {
+  SendTo(message.WithHopFields([this](protobuf::Message& hop_fields) {
+           AdjustRouteHistory(hop_fields);
+         }), peer_node_id, peer_connection_id);
 }
 
 void Network::SendToDirectAdjustedRoute(protobuf::Message& message, const NodeId& peer_node_id,
                                              const NodeId& peer_connection_id) {
   AdjustRouteHistory(message);
-  SendTo(message, peer_node_id, peer_connection_id);
+  SendTo(OutboundMessage(message), peer_node_id, peer_connection_id);
 }
 
 void Network::SendToClosestNode(const protobuf::Message& message) {
@@ -195,11 +224,12 @@ void Network::SendToClosestNode(const protobuf::Message& message) {
                       << PrintMessage(message);
         return;
       }
+      const OutboundMessage kOutbound(PiggybackAcks(OutboundMessage(message)));
       for (const auto& i : client_routing_nodes) {
-        SendTo(message, i.id, i.connection_id);
+        SendTo(kOutbound, i.id, i.connection_id);
       }
     } else if (routing_table_.size() > 0) {  // getting closer nodes from routing table
-      RecursiveSendOn(message);
+      RecursiveSendOn(PiggybackAcks(OutboundMessage(message)));
     } else {
       LOG(kError) << " No endpoint to send to; aborting send.  Attempt to send a type "
                   << MessageTypeString(message) << " message to " << HexSubstr(message.source_id())
@@ -212,7 +242,7 @@ void Network::SendToClosestNode(const protobuf::Message& message) {
   if (message.has_relay_id() /*&& (IsResponse(message))*/) {
     protobuf::Message relay_message(message);
     relay_message.set_destination_id(message.relay_id());  // so that peer identifies it as direct
-    SendTo(relay_message, NodeId(relay_message.relay_id()),
+    SendTo(OutboundMessage(relay_message), NodeId(relay_message.relay_id()),
            NodeId(relay_message.relay_connection_id()));
   } else {
     LOG(kError) << "Unable to work out destination; aborting send."
@@ -223,20 +253,28 @@ void Network::SendToClosestNode(const protobuf::Message& message) {
   }
 }
 
-void Network::SendTo(const protobuf::Message& message, const NodeId& peer_node_id,
+void Network::SendTo(const OutboundMessage& message, const NodeId& peer_node_id,
                           const NodeId& peer_connection_id,  bool no_ack_timer) {
   std::shared_ptr<std::string> kThisId(new std::string(routing_table_.kNodeId().string()));
+  // A message still awaiting its ack is being resent.
+  const bool kFirstSend(!acknowledgement_.IsAwaited(message.message().ack_id()));
+  const auto send_time(std::chrono::steady_clock::now());
   rudp::MessageSentFunctor message_sent_functor = [=](int message_sent) {
     if (rudp::kSuccess == message_sent) {
-      SendAck(message);
+      // rudp reports success once the peer has acknowledged receipt, giving a round-trip sample.
+      AddRttSample(peer_node_id, message.message(), kFirstSend, send_time);
+      // An end-to-end acked message is acked by its destination alone.
+      if (!message.message().end_to_end_ack())
+        SendAck(message.message());
     } else {
-      LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
+      LOG(kError) << "Sending type " << MessageTypeString(message.message()) << " message from "
                   << HexSubstr(*kThisId) << " to " << peer_node_id << " failed with code "
-                  << message_sent << " id: " << message.id();
+                  << message_sent << " id: " << message.message().id();
     }
   };
 
-  if (!no_ack_timer && acknowledgement_.NeedsAck(message, peer_connection_id)) {
+  if (!no_ack_timer && acknowledgement_.NeedsAck(message.message(), peer_connection_id)) {
+    // The resend on ack timeout reuses this message's serialised bytes.
     acknowledgement_.Add(message,
                          [=](const boost::system::error_code& error) {
                            {
@@ -246,12 +284,12 @@ void Network::SendTo(const protobuf::Message& message, const NodeId& peer_node_i
                            }
                            if (!error)
                              SendTo(message, peer_node_id, peer_connection_id);
-                         }, Parameters::ack_timeout);
+                         }, AckTimeout(message.message(), peer_node_id));
   }
   RudpSend(peer_connection_id, message, message_sent_functor);
 }
 
-void Network::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_attempted,
+void Network::RecursiveSendOn(OutboundMessage message, NodeInfo last_node_attempted,
                                    int attempt_count) {
   {
     std::lock_guard<std::mutex> lock(running_mutex_);
@@ -262,7 +300,7 @@ void Network::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_atte
     LOG(kWarning) << " Retry attempts failed to send to ["
                   << HexSubstr(last_node_attempted.id.string())
                   << "] will drop this node now and try with another node."
-                  << " id: " << message.id();
+                  << " id: " << message.message().id();
     attempt_count = 0;
     {
       std::lock_guard<std::mutex> lock(running_mutex_);
@@ -274,38 +312,44 @@ void Network::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_atte
       routing_table_.DropNode(last_node_attempted.connection_id, false);
       client_routing_table_.DropConnection(last_node_attempted.connection_id);
     }
+    retry_scheduler_.Reset(last_node_attempted.id);
   }
 
-  if (attempt_count > 0)
-    Sleep(std::chrono::milliseconds(50));
-
   const std::string kThisId(routing_table_.kNodeId().string());
-  bool ignore_exact_match(!IsDirect(message));
+  bool ignore_exact_match(!IsDirect(message.message()));
   std::vector<std::string> route_history;
   NodeInfo peer;
   {
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
       return;
-    if (message.route_history().size() > 1)
+    const protobuf::Message& kMessage(message.message());
+    if (kMessage.route_history().size() > 1)
       route_history = std::vector<std::string>(
-          message.route_history().begin(), message.route_history().end());
-    else if ((message.route_history().size() == 1) &&
-             (message.route_history(0) != routing_table_.kNodeId().string()))
-      route_history.push_back(message.route_history(0));
-
-    peer = routing_table_.GetClosestNode(NodeId(message.destination_id()), ignore_exact_match,
-                                         route_history);
-    if (peer.id == NodeId() && routing_table_.size() != 0) {
-      peer = routing_table_.GetClosestNode(NodeId(message.destination_id()), ignore_exact_match);
+          kMessage.route_history().begin(), kMessage.route_history().end());
+    else if ((kMessage.route_history().size() == 1) &&
+             (kMessage.route_history(0) != routing_table_.kNodeId().string()))
+      route_history.push_back(kMessage.route_history(0));
+
+    auto snapshot(routing_table_.Snapshot());
+    peer = snapshot->GetClosestNode(NodeId(kMessage.destination_id()), ignore_exact_match,
+                                    route_history);
+    if (peer.id == NodeId() && snapshot->size() != 0) {
+      peer = snapshot->GetClosestNode(NodeId(kMessage.destination_id()), ignore_exact_match);
     }
     if (peer.id == NodeId()) {
       LOG(kError) << "This node's routing table is empty now.  Need to re-bootstrap.";
       return;
     }
-    AdjustRouteHistory(message);
+    // Only the per-hop fields are reserialised; the body's bytes are shared with earlier attempts.
+    message = message.WithHopFields([this](protobuf::Message& hop_fields) {
+      AdjustRouteHistory(hop_fields);
+    });
   }
 
+  const bool kFirstSend(attempt_count == 0 &&
+                        !acknowledgement_.IsAwaited(message.message().ack_id()));
+  const auto send_time(std::chrono::steady_clock::now());
   rudp::MessageSentFunctor message_sent_functor = [=](int message_sent) {
     {
       std::lock_guard<std::mutex> lock(running_mutex_);
@@ -313,21 +357,31 @@ void Network::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_atte
         return;
     }
     if (rudp::kSuccess == message_sent) {
-      SendAck(message);
+      AddRttSample(peer.id, message.message(), kFirstSend, send_time);
+      retry_scheduler_.Reset(peer.id);
+      if (!message.message().end_to_end_ack())
+        SendAck(message.message());
     } else if (rudp::kSendFailure == message_sent) {
-      LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
+      LOG(kError) << "Sending type " << MessageTypeString(message.message()) << " message from "
                   << HexSubstr(routing_table_.kNodeId().string()) << " to "
                   << HexSubstr(peer.id.string()) << " with destination ID "
-                  << HexSubstr(message.destination_id()) << " failed with code " << message_sent
-                  << ".  Will retry to Send.  Attempt count = " << attempt_count + 1
-                  << " id: " << message.id();
-      RecursiveSendOn(message, peer, attempt_count + 1);
+                  << HexSubstr(message.message().destination_id()) << " failed with code "
+                  << message_sent << ".  Will retry to Send.  Attempt count = "
+                  << attempt_count + 1 << " id: " << message.message().id();
+      // The retry waits out the peer's backoff on a timer rather than on this io thread.
+      if (!retry_scheduler_.Schedule(peer.id, [=] {
+                                       RecursiveSendOn(message, peer, attempt_count + 1);
+                                     })) {
+        LOG(kWarning) << "Dropping type " << MessageTypeString(message.message())
+                      << " message as no retry could be scheduled. id: "
+                      << message.message().id();
+      }
     } else {
-      LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
+      LOG(kError) << "Sending type " << MessageTypeString(message.message()) << " message from "
                   << HexSubstr(kThisId) << " to " << HexSubstr(peer.id.string())
-                  << " with destination ID " << HexSubstr(message.destination_id())
+                  << " with destination ID " << HexSubstr(message.message().destination_id())
                   << " failed with code " << message_sent << "  Will remove node."
-                  << " message id: " << message.id();
+                  << " message id: " << message.message().id();
       {
         std::lock_guard<std::mutex> lock(running_mutex_);
         if (!running_)
@@ -341,31 +395,105 @@ void Network::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_atte
     }
   };
 
-  if (acknowledgement_.NeedsAck(message, peer.id)) {
+  if (acknowledgement_.NeedsAck(message.message(), peer.id)) {
     acknowledgement_.Add(message,
                         [=](const boost::system::error_code& error) {
-                          if (error.value() == boost::system::errc::success)
-                            RecursiveSendOn(message);
-                        }, Parameters::ack_timeout);
+                          if (error.value() != boost::system::errc::success)
+                            return;
+                          const protobuf::Message& kMessage(message.message());
+                          if (!kMessage.end_to_end_ack() ||
+                              peer.id.string() == kMessage.destination_id())
+                            return RecursiveSendOn(message);
+                          // The message may have been lost anywhere along the route, so the
+                          // resend avoids the first hop taken last time.
+                          RecursiveSendOn(message.WithHopFields(
+                              [&peer](protobuf::Message& hop_fields) {
+                                hop_fields.add_route_history(peer.id.string());
+                              }));
+                        }, AckTimeout(message.message(), peer.id));
+    const protobuf::Message& kMessage(message.message());
+    if (attempt_count == 0 && routing_table_.config().hedged_direct_sends && IsDirect(kMessage) &&
+        kMessage.source_id() == kThisId) {
+      acknowledgement_.Hedge(kMessage.ack_id(), HedgeDelay(kMessage, peer.id),
+                             [=] { HedgeSendOn(message, peer.id); });
+    }
   }
   RudpSend(peer.connection_id, message, message_sent_functor);
 }
 
+void Network::AddRttSample(const NodeId& peer_id, const protobuf::Message& message,
+                           bool first_send, std::chrono::steady_clock::time_point send_time) {
+  const auto kRtt(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - send_time));
+  routing_table_.AddRttSample(peer_id, kRtt);
+  // Karn's rule: a resent or hedged message's timing is not trusted for the ack timeout.
+  if (first_send && acknowledgement_.IsSentOnce(message.ack_id()))
+    routing_table_.AddAckRttSample(peer_id, kRtt);
+}
+
+std::chrono::milliseconds Network::AckTimeout(const protobuf::Message& message,
+                                              const NodeId& peer_id) const {
+  if (message.end_to_end_ack())
+    return std::chrono::seconds(routing_table_.config().ack_timeout);
+  return routing_table_.AckTimeout(peer_id);
+}
+
+boost::posix_time::time_duration Network::HedgeDelay(const protobuf::Message& message,
+                                                     const NodeId& peer_id) const {
+  const RoutingConfig& config(routing_table_.config());
+  std::chrono::milliseconds delay(config.hedge_max_delay);
+  // An end-to-end ack crosses the whole route, which the first hop's round trip says little about.
+  const auto kRtt(routing_table_.EstimateRtt(peer_id));
+  if (!message.end_to_end_ack() && kRtt.count() >= 0) {
+    // The next hop acks once it has sent the message on, and may hold the ack for a batch.
+    delay = std::chrono::duration_cast<std::chrono::milliseconds>(kRtt * 2) +
+            config.ack_batch_window;
+    delay = std::max(config.hedge_min_delay, std::min(delay, config.hedge_max_delay));
+  }
+  return bptime::milliseconds(delay.count());
+}
+
+void Network::HedgeSendOn(const OutboundMessage& message, const NodeId& first_peer_id) {
+  {
+    std::lock_guard<std::mutex> lock(running_mutex_);
+    if (!running_)
+      return;
+  }
+  const protobuf::Message& kMessage(message.message());
+  std::vector<std::string> exclude(kMessage.route_history().begin(),
+                                   kMessage.route_history().end());
+  exclude.push_back(first_peer_id.string());
+  NodeInfo peer(routing_table_.GetClosestNode(NodeId(kMessage.destination_id()), false, exclude));
+  if (peer.id == NodeId())
+    return;
+  LOG(kInfo) << "No ack from " << HexSubstr(first_peer_id.string())
+             << " in time; also sending type " << MessageTypeString(kMessage) << " message via "
+             << HexSubstr(peer.id.string()) << " id: " << kMessage.id();
+  const std::string kPeerId(peer.id.string());
+  const auto kMessageId(kMessage.id());
+  RudpSend(peer.connection_id, message, [kPeerId, kMessageId](int message_sent) {
+    if (rudp::kSuccess != message_sent)
+      LOG(kWarning) << "Hedged send of message id " << kMessageId << " via "
+                    << HexSubstr(kPeerId) << " failed with code " << message_sent;
+  });
+}
+
 void Network::AdjustRouteHistory(protobuf::Message& message) {
   if (message.source_id().empty())
     return;
 
   acknowledgement_.AdjustAckHistory(message);
 
-  if (Parameters::hops_to_live == static_cast<unsigned int>(message.hops_to_live()) &&
+  const RoutingConfig& config(routing_table_.config());
+  if (config.hops_to_live == static_cast<unsigned int>(message.hops_to_live()) &&
       NodeId(message.source_id()) == routing_table_.kNodeId())
     return;
   assert(static_cast<unsigned int>(message.route_history().size()) <=
-             Parameters::max_routing_table_size);
+             config.max_routing_table_size);
   if (std::find(message.route_history().begin(), message.route_history().end(),
                 routing_table_.kNodeId().string()) == message.route_history().end()) {
     message.add_route_history(routing_table_.kNodeId().string());
-    if (static_cast<unsigned int>(message.route_history().size()) > Parameters::max_route_history) {
+    if (static_cast<unsigned int>(message.route_history().size()) > config.max_route_history) {
       std::vector<std::string> route_history(message.route_history().begin() + 1,
                                              message.route_history().end());
       message.clear_route_history();
@@ -376,7 +504,7 @@ void Network::AdjustRouteHistory(protobuf::Message& message) {
     }
   }
   assert(static_cast<unsigned int>(message.route_history().size()) <=
-             Parameters::max_routing_table_size);
+             config.max_routing_table_size);
 }
 
 
@@ -397,7 +525,9 @@ maidsafe::NodeId Network::this_node_relay_connection_id() const {
 
 rudp::NatType Network::nat_type() const { return nat_type_; }
 
-void Network::SendAck(const protobuf::Message message) {
+uint64_t Network::messages_sent() const { return messages_sent_; }
+
+void Network::SendAck(const protobuf::Message& message) {
   if (message.ack_id() == 0)
     return;
 
@@ -410,6 +540,16 @@ void Network::SendAck(const protobuf::Message message) {
   if (message.direct() && (message.destination_id() == message.source_id()))
     return;
 
+  if (message.end_to_end_ack()) {
+    // Only the source waits on this ack, however many hops the message took.
+    if (!message.source_id().empty())
+      acknowledgement_.QueueAck(NodeId(message.source_id()), message.ack_id(),
+                                [this](const NodeId& node_id, const std::vector<AckId>& ack_ids) {
+                                  SendAcks(node_id, ack_ids);
+                                });
+    return;
+  }
+
   std::vector<std::string> ack_node_ids(message.ack_node_ids().begin(),
                                         message.ack_node_ids().end());
   if (message.ack_node_ids_size() == 0)
@@ -424,11 +564,32 @@ void Network::SendAck(const protobuf::Message message) {
     acknowledgement_.Remove(message.ack_id());
   }
 
-  protobuf::Message ack_message(rpcs::Ack(NodeId(message.ack_node_ids(0)), routing_table_.kNodeId(),
-                                          message.ack_id()));
+  // Acks to the same node are batched, or piggybacked on a message to it if one is sent first.
+  acknowledgement_.QueueAck(NodeId(message.ack_node_ids(0)), message.ack_id(),
+                            [this](const NodeId& node_id, const std::vector<AckId>& ack_ids) {
+                              SendAcks(node_id, ack_ids);
+                            });
+}
+
+void Network::SendAcks(const NodeId& node_id, const std::vector<int32_t>& ack_ids) {
+  protobuf::Message ack_message(
+      rpcs::Ack(routing_table_.config(), node_id, routing_table_.kNodeId(), ack_ids));
   SendToClosestNode(ack_message);
 }
 
+OutboundMessage Network::PiggybackAcks(const OutboundMessage& message) {
+  const protobuf::Message& kMessage(message.message());
+  if (!kMessage.direct() || kMessage.destination_id().empty())
+    return message;
+  auto ack_ids(acknowledgement_.TakeQueuedAcks(NodeId(kMessage.destination_id())));
+  if (ack_ids.empty())
+    return message;
+  return message.WithHopFields([&ack_ids](protobuf::Message& hop_fields) {
+    for (const auto& ack_id : ack_ids)
+      hop_fields.add_acked_ids(ack_id);
+  });
+}
+
 }  // namespace routing
 
 }  // namespace maidsafe
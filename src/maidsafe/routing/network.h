@@ -19,18 +19,26 @@
 #ifndef MAIDSAFE_ROUTING_NETWORK_H_
 #define MAIDSAFE_ROUTING_NETWORK_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <vector>
 
 #include "boost/asio/ip/udp.hpp"
+#include "boost/date_time/posix_time/posix_time_types.hpp"
 
+#include "maidsafe/common/asio_service.h"
 #include "maidsafe/common/node_id.h"
 #include "maidsafe/rudp/managed_connections.h"
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/bootstrap_file_operations.h"
 #include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/outbound_message.h"
+#include "maidsafe/routing/retry_scheduler.h"
+#include "maidsafe/routing/send_coalescer.h"
 #include "maidsafe/routing/timer.h"
 
 namespace maidsafe {
@@ -53,7 +61,7 @@ class MockNetwork;
 class Network {
  public:
   Network(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
-          Acknowledgement& acknowledgement);
+          Acknowledgement& acknowledgement, BoostAsioService& asio_service);
   virtual ~Network();
   int Bootstrap(const rudp::MessageReceivedFunctor& message_received_functor,
                 const rudp::ConnectionLostFunctor& connection_lost_functor);
@@ -72,10 +80,13 @@ class Network {
   // direct endpoint.
   void SendToDirect(const protobuf::Message& message, const NodeId& peer_connection_id,
                     const rudp::MessageSentFunctor& message_sent_functor);
-  void SendAck(const protobuf::Message message);
+  void SendAck(const protobuf::Message& message);
   void AdjustAckHistory(protobuf::Message& message);
   virtual void SendToDirect(protobuf::Message& message, const NodeId& peer_node_id,
                             const NodeId& peer_connection_id);
+  // As above, but for a message already serialised, e.g. one copy of a message sent to a group.
+  virtual void SendToDirect(const OutboundMessage& message, const NodeId& peer_node_id,
+                            const NodeId& peer_connection_id);
   void SendToDirectAdjustedRoute(protobuf::Message& message, const NodeId& peer_node_id,
                                  const NodeId& peer_connection_id);
   // Handles relay response messages.  Also leave destination ID empty if needs to send as a relay
@@ -87,6 +98,8 @@ class Network {
   NodeId bootstrap_connection_id() const;
   NodeId this_node_relay_connection_id() const;
   rudp::NatType nat_type() const;
+  // The number of messages sent, counting each message in a coalesced batch.
+  uint64_t messages_sent() const;
 
   friend class test::GenericNode;
   friend class test::MockNetwork;
@@ -101,13 +114,30 @@ class Network {
                   const rudp::ConnectionLostFunctor& connection_lost_functor,
                   const BootstrapContacts& bootstrap_contacts,
                   boost::asio::ip::udp::endpoint local_endpoint = boost::asio::ip::udp::endpoint());
-  void RudpSend(const NodeId& peer_id, const protobuf::Message& message,
+  void RudpSend(const NodeId& peer_id, const OutboundMessage& message,
                 const rudp::MessageSentFunctor& message_sent_functor);
-  void SendTo(const protobuf::Message& message, const NodeId& peer_node_id,
+  void SendTo(const OutboundMessage& message, const NodeId& peer_node_id,
               const NodeId& peer_connection_id, bool no_ack_timer = false);
-  void RecursiveSendOn(protobuf::Message message, NodeInfo last_node_attempted = NodeInfo(),
+  void RecursiveSendOn(OutboundMessage message, NodeInfo last_node_attempted = NodeInfo(),
                        int attempt_count = 0);
   void AdjustRouteHistory(protobuf::Message& message);
+  // Adds the round trip of a send of 'message' to 'peer_id', timed from 'send_time' to rudp's
+  // report of success, to the table's estimates.  It is used for the peer's ack timeout only if
+  // this was the message's 'first_send' and it has not since been resent or hedged.
+  void AddRttSample(const NodeId& peer_id, const protobuf::Message& message, bool first_send,
+                    std::chrono::steady_clock::time_point send_time);
+  // How long to wait for 'peer_id' to ack 'message' before resending it.  An end-to-end ack crosses
+  // the whole route, so gets the longest wait rather than one adapted to the first hop.
+  std::chrono::milliseconds AckTimeout(const protobuf::Message& message,
+                                       const NodeId& peer_id) const;
+  // How long to wait for 'peer_id' to ack 'message' before hedging.
+  boost::posix_time::time_duration HedgeDelay(const protobuf::Message& message,
+                                              const NodeId& peer_id) const;
+  // Sends 'message' again via the closest next hop other than 'first_peer_id', without retries.
+  void HedgeSendOn(const OutboundMessage& message, const NodeId& first_peer_id);
+  // Adds any acks queued for the destination of a direct message to it.
+  OutboundMessage PiggybackAcks(const OutboundMessage& message);
+  void SendAcks(const NodeId& node_id, const std::vector<int32_t>& ack_ids);
 
   bool running_;
   std::mutex running_mutex_;
@@ -119,6 +149,9 @@ class Network {
   Acknowledgement& acknowledgement_;
   rudp::NatType nat_type_;
   rudp::ManagedConnections rudp_;
+  RetryScheduler retry_scheduler_;
+  std::atomic<uint64_t> messages_sent_;
+  SendCoalescer send_coalescer_;
 };
 
 }  // namespace routing
@@ -0,0 +1,139 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/network_coordinates.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "maidsafe/common/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// Weights applied to a sample when adjusting the error estimate and the position respectively.
+const double kErrorGain(0.25);
+const double kPositionGain(0.25);
+const double kMinError(0.001);
+const double kMaxError(1.0);
+// Heights below this (in microseconds) would let two nodes appear closer than any real link.
+const double kMinHeight(100.0);
+const double kErrorScale(1000.0);
+
+int32_t ToInt32(double value) {
+  return static_cast<int32_t>(std::max<double>(std::numeric_limits<int32_t>::min(),
+      std::min<double>(std::numeric_limits<int32_t>::max(), std::round(value))));
+}
+
+}  // unnamed namespace
+
+const size_t NetworkCoordinates::kDimensions;
+
+NetworkCoordinates::NetworkCoordinates()
+    : position_(), height_(kMinHeight), error_(kMaxError), valid_(true) {
+  position_.fill(0.0);
+}
+
+NetworkCoordinates::NetworkCoordinates(const std::vector<int32_t>& dimension_list)
+    : position_(), height_(kMinHeight), error_(kMaxError), valid_(false) {
+  position_.fill(0.0);
+  if (dimension_list.size() != kDimensions + 2)
+    return;
+  for (size_t i(0); i != kDimensions; ++i)
+    position_[i] = static_cast<double>(dimension_list[i]);
+  height_ = static_cast<double>(dimension_list[kDimensions]);
+  error_ = static_cast<double>(dimension_list[kDimensions + 1]) / kErrorScale;
+  if (height_ < 0.0 || error_ < 0.0 || error_ > kMaxError)
+    return;
+  height_ = std::max(height_, kMinHeight);
+  error_ = std::max(error_, kMinError);
+  valid_ = true;
+}
+
+std::vector<int32_t> NetworkCoordinates::ToDimensionList() const {
+  std::vector<int32_t> dimension_list;
+  if (!valid_)
+    return dimension_list;
+  dimension_list.reserve(kDimensions + 2);
+  for (const auto& component : position_)
+    dimension_list.push_back(ToInt32(component));
+  dimension_list.push_back(ToInt32(height_));
+  dimension_list.push_back(ToInt32(error_ * kErrorScale));
+  return dimension_list;
+}
+
+std::chrono::microseconds NetworkCoordinates::EstimateRtt(const NetworkCoordinates& other) const {
+  assert(valid_ && other.valid_);
+  return std::chrono::microseconds(static_cast<int64_t>(std::round(Distance(other))));
+}
+
+void NetworkCoordinates::Update(const NetworkCoordinates& remote, std::chrono::microseconds rtt) {
+  if (!valid_ || !remote.valid_ || rtt.count() <= 0)
+    return;
+
+  const double sample(static_cast<double>(rtt.count()));
+  // Trust the sample in proportion to how uncertain this node is relative to the remote one.
+  const double weight(error_ / (error_ + remote.error_));
+  const double distance(Distance(remote));
+  const double sample_error(std::abs(distance - sample) / sample);
+  error_ = sample_error * kErrorGain * weight + error_ * (1.0 - kErrorGain * weight);
+  error_ = std::max(kMinError, std::min(kMaxError, error_));
+
+  // Move along the unit vector from 'remote' to this node (position difference plus the sum of
+  // the heights), by an amount proportional to the prediction error.
+  const double force(kPositionGain * weight * (sample - distance));
+  std::array<double, kDimensions> direction;
+  double euclidean(0.0);
+  for (size_t i(0); i != kDimensions; ++i) {
+    direction[i] = position_[i] - remote.position_[i];
+    euclidean += direction[i] * direction[i];
+  }
+  euclidean = std::sqrt(euclidean);
+  if (euclidean < 1.0) {
+    // Coincident nodes (e.g. both still at the origin) are pushed apart in a random direction.
+    euclidean = 0.0;
+    for (auto& component : direction) {
+      component = static_cast<double>(RandomUint32() % 2001) - 1000.0;
+      euclidean += component * component;
+    }
+    euclidean = std::max(std::sqrt(euclidean), 1.0);
+    for (auto& component : direction)
+      component *= distance / euclidean;
+  }
+  for (size_t i(0); i != kDimensions; ++i)
+    position_[i] += force * direction[i] / distance;
+  height_ = std::max(kMinHeight, height_ + force * (height_ + remote.height_) / distance);
+}
+
+double NetworkCoordinates::Distance(const NetworkCoordinates& other) const {
+  double euclidean(0.0);
+  for (size_t i(0); i != kDimensions; ++i) {
+    const double difference(position_[i] - other.position_[i]);
+    euclidean += difference * difference;
+  }
+  return std::sqrt(euclidean) + height_ + other.height_;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,71 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_NETWORK_COORDINATES_H_
+#define MAIDSAFE_ROUTING_NETWORK_COORDINATES_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace maidsafe {
+
+namespace routing {
+
+// A Vivaldi network coordinate: a point in a low-dimensional Euclidean space plus a height which
+// models the node's access link, positioned such that the distance between two nodes' coordinates
+// estimates the round-trip time between them.  Each node moves its own coordinate a little
+// towards or away from a peer's whenever it measures a round trip to that peer, weighted by how
+// confident each side is in its current position.
+//
+// Coordinates travel between nodes as NodeInfo::dimension_list, holding the position and height in
+// microseconds followed by the error estimate in thousandths.
+class NetworkCoordinates {
+ public:
+  static const size_t kDimensions = 3;
+
+  NetworkCoordinates();
+  // Decodes 'dimension_list'.  The result is invalid if the list is not a well-formed coordinate.
+  explicit NetworkCoordinates(const std::vector<int32_t>& dimension_list);
+
+  std::vector<int32_t> ToDimensionList() const;
+  bool IsValid() const { return valid_; }
+  // Relative error of this coordinate's predictions, from 0 (exact) to 1 (no information yet).
+  double error() const { return error_; }
+
+  // Predicted round-trip time to the node at 'other'.  Both coordinates must be valid.
+  std::chrono::microseconds EstimateRtt(const NetworkCoordinates& other) const;
+  // Adjusts this coordinate given a measured round-trip time to the node at 'remote'.  Samples
+  // against an invalid coordinate or of zero duration are ignored.
+  void Update(const NetworkCoordinates& remote, std::chrono::microseconds rtt);
+
+ private:
+  double Distance(const NetworkCoordinates& other) const;
+
+  std::array<double, kDimensions> position_;
+  double height_;
+  double error_;
+  bool valid_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_NETWORK_COORDINATES_H_
@@ -21,34 +21,25 @@
 #include <string>
 #include <algorithm>
 
+#include "maidsafe/routing/node_id_store.h"
 #include "maidsafe/routing/parameters.h"
 
 namespace maidsafe {
 
 namespace routing {
 
-NetworkStatistics::NetworkStatistics(NodeId node_id)
-    : mutex_(), kNodeId_(std::move(node_id)), distance_(), network_distance_data_() {}
+NetworkStatistics::NetworkStatistics(NodeId node_id, const RoutingConfig& config)
+    : mutex_(),
+      kNodeId_(std::move(node_id)),
+      kGroupSize_(config.group_size),
+      distance_(),
+      network_distance_data_() {}
 
 void NetworkStatistics::UpdateLocalAverageDistance(const std::vector<NodeId>& close_nodes) {
-  std::vector<NodeId> unique_nodes(close_nodes);
-  if (unique_nodes.size() < Parameters::group_size)
+  if (close_nodes.size() < kGroupSize_)
     return;
-#ifndef __GNUC__
-  std::nth_element(unique_nodes.begin(), unique_nodes.begin() + Parameters::group_size,
-                   unique_nodes.end(), [&](const NodeId & lhs, const NodeId & rhs) {
-    return NodeId::CloserToTarget(lhs, rhs, kNodeId_);
-  });
-#else
-  // BEFORE_RELEASE use std::nth_element() for all platform when min required Gcc version is 4.8.3
-  // http://gcc.gnu.org/bugzilla/show_bug.cgi?id=58800 Bug fixed in gcc 4.8.3
-  std::partial_sort(unique_nodes.begin(), unique_nodes.begin() + Parameters::group_size,
-                    unique_nodes.end(), [&](const NodeId & lhs, const NodeId & rhs) {
-    return NodeId::CloserToTarget(lhs, rhs, kNodeId_);
-  });
-#endif
-  NodeId furthest_group_node(unique_nodes.at(
-      std::min(Parameters::group_size - 1, static_cast<unsigned int>(unique_nodes.size()))));
+  NodeId furthest_group_node(
+      ClosestByDistance(kNodeId_, close_nodes, kGroupSize_).back());
   {
     std::lock_guard<std::mutex> lock(mutex_);
     distance_ = furthest_group_node ^ kNodeId_;
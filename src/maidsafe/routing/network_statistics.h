@@ -24,7 +24,9 @@
 #include "maidsafe/common/crypto.h"
 
 #include "maidsafe/common/node_id.h"
+
 #include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/routing_config.h"
 
 namespace maidsafe {
 
@@ -37,7 +39,7 @@ class NetworkStatisticsTest_FUNC_IsIdInGroupRange_Test;
 
 class NetworkStatistics {
  public:
-  explicit NetworkStatistics(NodeId node_id);
+  explicit NetworkStatistics(NodeId node_id, const RoutingConfig& config = RoutingConfig());
   void UpdateLocalAverageDistance(const std::vector<NodeId>& unique_nodes);
   void UpdateNetworkAverageDistance(const NodeId& distance);
   bool EstimateInGroup(const NodeId& sender_id, const NodeId& info_id);
@@ -56,6 +58,7 @@ class NetworkStatistics {
   };
   std::mutex mutex_;
   const NodeId kNodeId_;
+  const unsigned int kGroupSize_;
   NodeId distance_;
   NetworkDistanceData network_distance_data_;
 };
@@ -22,8 +22,19 @@ namespace maidsafe {
 
 namespace routing {
 
-NetworkUtils::NetworkUtils(const NodeId& local_node_id, BoostAsioService& asio_service)
-    : acknowledgement_(local_node_id, asio_service), firewall_(), statistics_(local_node_id) {}
+NetworkUtils::NetworkUtils(const NodeId& local_node_id, BoostAsioService& asio_service,
+                           const RoutingConfig& config)
+    : flow_control_(config), acknowledgement_(local_node_id, asio_service, config),
+      firewall_(config), statistics_(local_node_id, config) {
+  acknowledgement_.SetAckDoneFunctor([this](AckId ack_id) { flow_control_.Release(ack_id); });
+}
+
+NetworkUtils::NetworkUtils(const NodeId& local_node_id, BoostAsioService& asio_service,
+                           TimingWheel& timing_wheel, const RoutingConfig& config)
+    : flow_control_(config), acknowledgement_(local_node_id, asio_service, timing_wheel, config),
+      firewall_(config), statistics_(local_node_id, config) {
+  acknowledgement_.SetAckDoneFunctor([this](AckId ack_id) { flow_control_.Release(ack_id); });
+}
 
 }  // namespace routing
 
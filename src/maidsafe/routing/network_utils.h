@@ -21,18 +21,27 @@
 
 #include "maidsafe/routing/acknowledgement.h"
 #include "maidsafe/routing/firewall.h"
+#include "maidsafe/routing/flow_control.h"
 #include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/routing_config.h"
+#include "maidsafe/routing/timing_wheel.h"
 
 namespace maidsafe {
 
 namespace routing {
 
 struct NetworkUtils {
-  NetworkUtils(const NodeId& local_node_id, BoostAsioService& asio_service);
+  NetworkUtils(const NodeId& local_node_id, BoostAsioService& asio_service,
+               const RoutingConfig& config = RoutingConfig());
+  // acknowledgement_ keeps its timers on 'timing_wheel', which must outlive this.
+  NetworkUtils(const NodeId& local_node_id, BoostAsioService& asio_service,
+               TimingWheel& timing_wheel, const RoutingConfig& config = RoutingConfig());
   NetworkUtils& operator=(const NetworkUtils&) = delete;
   NetworkUtils(const NetworkUtils&) = delete;
   NetworkUtils(const NetworkUtils&&) = delete;
 
+  // Declared first so that acks given up on as acknowledgement_ is destroyed can return credits.
+  FlowControl flow_control_;
   Acknowledgement acknowledgement_;
   Firewall firewall_;
   NetworkStatistics statistics_;
@@ -0,0 +1,172 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/node_id_store.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+static_assert(NodeId::kSize % 32 == 0, "Distance kernel assumes a whole number of 32-byte lanes");
+
+// Writes the XOR of the kSize-byte rows 'lhs' and 'rhs' to 'distance'.
+inline void XorRow(const unsigned char* lhs, const unsigned char* rhs, unsigned char* distance) {
+#if defined(__AVX2__)
+  for (size_t offset(0); offset < NodeId::kSize; offset += 32) {
+    __m256i lhs_lane(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + offset)));
+    __m256i rhs_lane(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + offset)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(distance + offset),
+                        _mm256_xor_si256(lhs_lane, rhs_lane));
+  }
+#elif defined(__SSE2__)
+  for (size_t offset(0); offset < NodeId::kSize; offset += 16) {
+    __m128i lhs_lane(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + offset)));
+    __m128i rhs_lane(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + offset)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(distance + offset),
+                     _mm_xor_si128(lhs_lane, rhs_lane));
+  }
+#else
+  for (size_t offset(0); offset < NodeId::kSize; offset += sizeof(uint64_t)) {
+    uint64_t lhs_word, rhs_word;
+    std::memcpy(&lhs_word, lhs + offset, sizeof(uint64_t));
+    std::memcpy(&rhs_word, rhs + offset, sizeof(uint64_t));
+    lhs_word ^= rhs_word;
+    std::memcpy(distance + offset, &lhs_word, sizeof(uint64_t));
+  }
+#endif
+}
+
+// The most significant 8 bytes of a distance as an integer, so that most comparisons between two
+// distances are decided by a single integer comparison.
+inline uint64_t LeadingWord(const unsigned char* distance) {
+  uint64_t word(0);
+  for (size_t index(0); index < sizeof(uint64_t); ++index)
+    word = (word << 8) | distance[index];
+  return word;
+}
+
+}  // unnamed namespace
+
+NodeIdStore::NodeIdStore() : rows_() {}
+
+NodeIdStore::NodeIdStore(const std::vector<NodeId>& node_ids) : rows_() {
+  rows_.reserve(node_ids.size());
+  for (const auto& node_id : node_ids)
+    rows_.push_back(ToRow(node_id));
+}
+
+NodeIdStore::Row NodeIdStore::ToRow(const NodeId& node_id) {
+  Row row;
+  std::string raw_id(node_id.string());
+  assert(raw_id.size() == NodeId::kSize);
+  std::memcpy(row.bytes, raw_id.data(), NodeId::kSize);
+  return row;
+}
+
+void NodeIdStore::Insert(size_t slot, const NodeId& node_id) {
+  assert(slot <= rows_.size());
+  rows_.insert(std::begin(rows_) + slot, ToRow(node_id));
+}
+
+void NodeIdStore::PushBack(const NodeId& node_id) { rows_.push_back(ToRow(node_id)); }
+
+void NodeIdStore::Erase(size_t slot) {
+  assert(slot < rows_.size());
+  rows_.erase(std::begin(rows_) + slot);
+}
+
+void NodeIdStore::Clear() { rows_.clear(); }
+
+std::vector<size_t> NodeIdStore::ClosestSlots(const NodeId& target, size_t count) const {
+  std::vector<size_t> candidates(rows_.size());
+  for (size_t slot(0); slot < candidates.size(); ++slot)
+    candidates[slot] = slot;
+  return ClosestSlots(target, count, std::move(candidates));
+}
+
+std::vector<size_t> NodeIdStore::ClosestSlots(const NodeId& target, size_t count,
+                                              std::vector<size_t> candidates) const {
+  count = std::min(count, candidates.size());
+  if (count == 0)
+    return std::vector<size_t>();
+
+  // One pass computes every candidate's distance; the selection below then only touches keys.
+  Row target_row(ToRow(target));
+  std::vector<Row> distances(candidates.size());
+  std::vector<std::pair<uint64_t, size_t>> keys(candidates.size());
+  for (size_t index(0); index < candidates.size(); ++index) {
+    assert(candidates[index] < rows_.size());
+    XorRow(rows_[candidates[index]].bytes, target_row.bytes, distances[index].bytes);
+    keys[index] = std::make_pair(LeadingWord(distances[index].bytes), index);
+  }
+
+  std::partial_sort(std::begin(keys), std::begin(keys) + count, std::end(keys),
+                    [&distances](const std::pair<uint64_t, size_t>& lhs,
+                                 const std::pair<uint64_t, size_t>& rhs) {
+                      if (lhs.first != rhs.first)
+                        return lhs.first < rhs.first;
+                      return std::memcmp(distances[lhs.second].bytes + sizeof(uint64_t),
+                                         distances[rhs.second].bytes + sizeof(uint64_t),
+                                         NodeId::kSize - sizeof(uint64_t)) < 0;
+                    });
+
+  std::vector<size_t> closest(count);
+  for (size_t index(0); index < count; ++index)
+    closest[index] = candidates[keys[index].second];
+  return closest;
+}
+
+NodeId NodeIdStore::at(size_t slot) const {
+  return NodeId(std::string(reinterpret_cast<const char*>(rows_.at(slot).bytes), NodeId::kSize));
+}
+
+size_t NodeIdHash::operator()(const NodeId& node_id) const {
+  size_t hash(0);
+  std::string raw_id(node_id.string());
+  std::memcpy(&hash, raw_id.data(), std::min(sizeof(hash), raw_id.size()));
+  return hash;
+}
+
+void SortByDistance(const NodeId& target, std::vector<NodeId>& node_ids) {
+  node_ids = ClosestByDistance(target, node_ids, node_ids.size());
+}
+
+std::vector<NodeId> ClosestByDistance(const NodeId& target, const std::vector<NodeId>& node_ids,
+                                      size_t count) {
+  std::vector<NodeId> closest;
+  NodeIdStore store(node_ids);
+  for (auto slot : store.ClosestSlots(target, count))
+    closest.push_back(node_ids[slot]);
+  return closest;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,84 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_NODE_ID_STORE_H_
+#define MAIDSAFE_ROUTING_NODE_ID_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Holds raw NodeIds back to back in fixed-size rows, so that the XOR distance of every entry to a
+// target can be computed in a single pass over contiguous memory (using AVX2 or SSE2 where the
+// build enables them, otherwise 64-bit words) rather than via repeated NodeId::CloserToTarget
+// calls, each of which copies and compares two ids byte by byte.  Slots mirror the indices of the
+// container the ids were taken from.
+class NodeIdStore {
+ public:
+  NodeIdStore();
+  explicit NodeIdStore(const std::vector<NodeId>& node_ids);
+
+  void Insert(size_t slot, const NodeId& node_id);
+  void PushBack(const NodeId& node_id);
+  void Erase(size_t slot);
+  void Clear();
+
+  // Returns up to 'count' slots, ordered by increasing distance to 'target'.
+  std::vector<size_t> ClosestSlots(const NodeId& target, size_t count) const;
+  // As above, but only 'candidates' are considered.
+  std::vector<size_t> ClosestSlots(const NodeId& target, size_t count,
+                                   std::vector<size_t> candidates) const;
+
+  NodeId at(size_t slot) const;
+  size_t size() const { return rows_.size(); }
+  bool empty() const { return rows_.empty(); }
+
+ private:
+  // Rows carry no alignment requirement; the distance kernel uses unaligned loads throughout.
+  struct Row {
+    unsigned char bytes[NodeId::kSize];
+  };
+
+  static Row ToRow(const NodeId& node_id);
+
+  std::vector<Row> rows_;
+};
+
+// Hashes a NodeId by its leading bytes.  Ids are uniformly distributed, so no mixing is needed.
+struct NodeIdHash {
+  size_t operator()(const NodeId& node_id) const;
+};
+
+// Sorts 'node_ids' by increasing distance to 'target'.
+void SortByDistance(const NodeId& target, std::vector<NodeId>& node_ids);
+
+// Returns the 'count' entries of 'node_ids' closest to 'target', ordered by increasing distance.
+std::vector<NodeId> ClosestByDistance(const NodeId& target, const std::vector<NodeId>& node_ids,
+                                      size_t count);
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_NODE_ID_STORE_H_
@@ -30,6 +30,7 @@ NodeInfo::NodeInfo()
     : id(),
       connection_id(),
       public_key(),
+      public_key_fingerprint(0),
       rank(),
       bucket(kInvalidBucket),
       nat_type(rudp::NatType::kUnknown),
@@ -39,6 +40,7 @@ NodeInfo::NodeInfo(const NodeInfo& other)
     : id(other.id),
       connection_id(other.connection_id),
       public_key(other.public_key),
+      public_key_fingerprint(other.public_key_fingerprint),
       rank(other.rank),
       bucket(other.bucket),
       nat_type(other.nat_type),
@@ -48,6 +50,7 @@ NodeInfo::NodeInfo(NodeInfo&& other)
     : id(std::move(other.id)),
       connection_id(std::move(other.connection_id)),
       public_key(std::move(other.public_key)),
+      public_key_fingerprint(std::move(other.public_key_fingerprint)),
       rank(std::move(other.rank)),
       bucket(std::move(other.bucket)),
       nat_type(std::move(other.nat_type)),
@@ -59,7 +62,8 @@ NodeInfo& NodeInfo::operator=(NodeInfo other) {
 }
 
 NodeInfo::NodeInfo(const serialised_type& serialised_message)
-    : connection_id(), public_key(), bucket(kInvalidBucket), nat_type(rudp::NatType::kUnknown) {
+    : connection_id(), public_key(), public_key_fingerprint(0), bucket(kInvalidBucket),
+      nat_type(rudp::NatType::kUnknown) {
   protobuf::NodeInfo proto_node_info;
   if (!proto_node_info.ParseFromString(serialised_message->string()))
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
@@ -95,6 +99,7 @@ void swap(NodeInfo& lhs, NodeInfo& rhs) MAIDSAFE_NOEXCEPT {
   swap(lhs.id, rhs.id);
   swap(lhs.connection_id, rhs.connection_id);
   swap(lhs.public_key, rhs.public_key);
+  swap(lhs.public_key_fingerprint, rhs.public_key_fingerprint);
   swap(lhs.rank, rhs.rank);
   swap(lhs.bucket, rhs.bucket);
   swap(lhs.nat_type, rhs.nat_type);
@@ -0,0 +1,78 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/outbound_message.h"
+
+#include <utility>
+
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+protobuf::Message HopFields(const protobuf::Message& message) {
+  protobuf::Message hop_fields;
+  if (message.has_destination_id())
+    hop_fields.set_destination_id(message.destination_id());
+  if (message.has_ack_id())
+    hop_fields.set_ack_id(message.ack_id());
+  hop_fields.mutable_ack_node_ids()->CopyFrom(message.ack_node_ids());
+  hop_fields.mutable_route_history()->CopyFrom(message.route_history());
+  hop_fields.mutable_acked_ids()->CopyFrom(message.acked_ids());
+  return hop_fields;
+}
+
+}  // unnamed namespace
+
+OutboundMessage::OutboundMessage(protobuf::Message message)
+    : header_(), body_(), hop_fields_() {
+  const protobuf::Message kHopFields(HopFields(message));
+  message.clear_destination_id();
+  message.clear_ack_id();
+  message.clear_ack_node_ids();
+  message.clear_route_history();
+  message.clear_acked_ids();
+  body_ = std::make_shared<const std::string>(message.SerializeAsString());
+  message.clear_data();
+  message.MergeFrom(kHopFields);
+  auto header(std::make_shared<protobuf::Message>());
+  header->Swap(&message);
+  header_ = header;
+  // The per-hop fields alone lack the required fields, which the body carries.
+  hop_fields_ = kHopFields.SerializePartialAsString();
+}
+
+OutboundMessage::OutboundMessage(std::shared_ptr<const protobuf::Message> header,
+                                 std::shared_ptr<const std::string> body)
+    : header_(std::move(header)),
+      body_(std::move(body)),
+      hop_fields_(HopFields(*header_).SerializePartialAsString()) {}
+
+OutboundMessage OutboundMessage::WithHopFields(
+    const std::function<void(protobuf::Message&)>& set_hop_fields) const {
+  auto header(std::make_shared<protobuf::Message>(*header_));
+  set_hop_fields(*header);
+  return OutboundMessage(header, body_);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,73 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_OUTBOUND_MESSAGE_H_
+#define MAIDSAFE_ROUTING_OUTBOUND_MESSAGE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace protobuf {
+class Message;
+}
+
+// An immutable message together with its wire bytes, shared by every copy, so that resending a
+// message (e.g. on ack timeout) or holding it in pending handlers never copies or reserialises
+// it.  The wire form is the body - every field bar the per-hop ones (destination ID, ack ID, ack
+// node IDs, route history and piggybacked acks) - followed by the per-hop fields, which relies on
+// a serialised message followed by another parsing as their merge.  Variants differing only in
+// their per-hop fields - a retry with an adjusted route history, or each copy of a group message -
+// share the body's bytes and hold only their own per-hop fields, and the two parts are joined only
+// when handed to a sender which needs them in one buffer.
+class OutboundMessage {
+ public:
+  explicit OutboundMessage(protobuf::Message message);
+
+  // Returns a variant of this message with its per-hop fields changed by 'set_hop_fields', which
+  // must not change any other field.  The payload is not copied.
+  OutboundMessage WithHopFields(
+      const std::function<void(protobuf::Message&)>& set_hop_fields) const;
+
+  // Every field of the message bar its payload ('data'), which is held only in body().
+  const protobuf::Message& message() const { return *header_; }
+  const std::string& body() const { return *body_; }
+  const std::string& hop_fields() const { return hop_fields_; }
+  // The whole wire form, body() followed by hop_fields(), in a new buffer.
+  std::string Serialise() const { return body() + hop_fields(); }
+  // Whether 'other' shares this message's serialised body.
+  bool SharesBodyWith(const OutboundMessage& other) const { return body_ == other.body_; }
+
+ private:
+  OutboundMessage(std::shared_ptr<const protobuf::Message> header,
+                  std::shared_ptr<const std::string> body);
+
+  std::shared_ptr<const protobuf::Message> header_;
+  std::shared_ptr<const std::string> body_;
+  std::string hop_fields_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_OUTBOUND_MESSAGE_H_
@@ -21,6 +21,8 @@
 #include "maidsafe/rudp/parameters.h"
 #include "maidsafe/rudp/managed_connections.h"
 
+#include "maidsafe/routing/routing_config.h"
+
 namespace bptime = boost::posix_time;
 
 namespace maidsafe {
@@ -29,38 +31,102 @@ namespace routing {
 
 unsigned int Parameters::thread_count(8);
 unsigned int Parameters::num_chunks_to_cache(100);
-unsigned int Parameters::closest_nodes_size(16);
-unsigned int Parameters::group_size(4);
-unsigned int Parameters::proximity_factor(2);
-unsigned int Parameters::max_routing_table_size(64);
-unsigned int Parameters::routing_table_size_threshold(max_routing_table_size / 4);
-unsigned int Parameters::max_routing_table_size_for_client(8);
-unsigned int Parameters::max_client_routing_table_size(max_routing_table_size);
+unsigned int Parameters::closest_nodes_size(defaults::kClosestNodesSize);
+unsigned int Parameters::group_size(defaults::kGroupSize);
+unsigned int Parameters::proximity_factor(defaults::kProximityFactor);
+unsigned int Parameters::max_routing_table_size(defaults::kMaxRoutingTableSize);
+unsigned int Parameters::routing_table_size_threshold(defaults::kRoutingTableSizeThreshold);
+unsigned int Parameters::max_routing_table_size_for_client(
+    defaults::kMaxRoutingTableSizeForClient);
+unsigned int Parameters::max_client_routing_table_size(defaults::kMaxRoutingTableSize);
 unsigned int Parameters::bucket_target_size(1);
-std::chrono::steady_clock::duration Parameters::default_response_timeout(std::chrono::seconds(20));
-std::chrono::seconds Parameters::find_node_interval(10);
-std::chrono::seconds Parameters::recovery_time_lag(5);
-std::chrono::seconds Parameters::re_bootstrap_time_lag(10);
-std::chrono::seconds Parameters::find_close_node_interval(3);
+std::chrono::steady_clock::duration Parameters::default_response_timeout(
+    std::chrono::seconds(defaults::kDefaultResponseTimeoutSeconds));
+std::chrono::seconds Parameters::find_node_interval(defaults::kFindNodeIntervalSeconds);
+std::chrono::seconds Parameters::recovery_time_lag(defaults::kRecoveryTimeLagSeconds);
+std::chrono::seconds Parameters::re_bootstrap_time_lag(defaults::kReBootstrapTimeLagSeconds);
+std::chrono::seconds Parameters::find_close_node_interval(
+    defaults::kFindCloseNodeIntervalSeconds);
 unsigned int Parameters::find_node_repeats_per_num_requested(3);
 unsigned int Parameters::maximum_find_close_node_failures(10);
-unsigned int Parameters::max_route_history(3);
-unsigned int Parameters::hops_to_live(50);
+unsigned int Parameters::max_route_history(defaults::kMaxRouteHistory);
+unsigned int Parameters::hops_to_live(defaults::kHopsToLive);
 unsigned int Parameters::accepted_distance_tolerance(1);
-unsigned int Parameters::max_send_retry(3);
-unsigned int Parameters::ack_timeout(5);
-unsigned int Parameters::firewall_history_cleanup_factor(5000);
-std::chrono::seconds Parameters::firewall_message_life(300);
+unsigned int Parameters::max_send_retry(defaults::kMaxSendRetry);
+unsigned int Parameters::ack_timeout(defaults::kAckTimeoutSeconds);
+std::chrono::milliseconds Parameters::min_ack_timeout(defaults::kMinAckTimeoutMilliseconds);
+unsigned int Parameters::firewall_history_cleanup_factor(
+    defaults::kFirewallHistoryCleanupFactor);
+std::chrono::seconds Parameters::firewall_message_life(defaults::kFirewallMessageLifeSeconds);
+unsigned int Parameters::firewall_max_history(defaults::kFirewallMaxHistory);
 unsigned int Parameters::public_key_holding_time(30);
-unsigned int Parameters::unidirectional_interest_range(Parameters::closest_nodes_size * 2);
+unsigned int Parameters::max_retries_in_flight(defaults::kMaxRetriesInFlight);
+std::chrono::milliseconds Parameters::retry_base_delay(defaults::kRetryBaseDelayMilliseconds);
+std::chrono::milliseconds Parameters::retry_max_delay(defaults::kRetryMaxDelayMilliseconds);
+unsigned int Parameters::retry_budget(defaults::kRetryBudget);
+std::chrono::milliseconds Parameters::coalescing_window(
+    defaults::kCoalescingWindowMilliseconds);
+unsigned int Parameters::max_coalesced_message_size(defaults::kMaxCoalescedMessageSize);
+unsigned int Parameters::max_batch_size(defaults::kMaxBatchSize);
+std::chrono::milliseconds Parameters::ack_batch_window(defaults::kAckBatchWindowMilliseconds);
+unsigned int Parameters::max_batched_acks(defaults::kMaxBatchedAcks);
+bool Parameters::end_to_end_acks(defaults::kEndToEndAcks);
+bool Parameters::hedged_direct_sends(defaults::kHedgedDirectSends);
+std::chrono::milliseconds Parameters::hedge_min_delay(defaults::kHedgeMinDelayMilliseconds);
+std::chrono::milliseconds Parameters::hedge_max_delay(defaults::kHedgeMaxDelayMilliseconds);
+unsigned int Parameters::max_messages_in_flight(defaults::kMaxMessagesInFlight);
+unsigned int Parameters::max_messages_in_flight_per_hop(defaults::kMaxMessagesInFlightPerHop);
+unsigned int Parameters::priority_starvation_limit(defaults::kPriorityStarvationLimit);
+unsigned int Parameters::unidirectional_interest_range(defaults::kUnidirectionalInterestRange);
 std::chrono::steady_clock::duration Parameters::local_retreival_timeout(std::chrono::seconds(2));
-unsigned int Parameters::routing_table_ready_to_response(Parameters::max_routing_table_size / 2);
+unsigned int Parameters::routing_table_ready_to_response(
+    defaults::kRoutingTableReadyToResponse);
 bptime::time_duration Parameters::connect_rpc_prune_timeout(
     rudp::Parameters::rendezvous_connect_timeout * 2);
 // 10 KB of book keeping data for Routing
 uint32_t Parameters::max_data_size(rudp::ManagedConnections::kMaxMessageSize() - 10240);
 // TODO(Prakash): BEFORE_RELEASE enable caching after persona tests are passing
 bool Parameters::caching(true);
+
+RoutingConfig::RoutingConfig()
+    : closest_nodes_size(Parameters::closest_nodes_size),
+      group_size(Parameters::group_size),
+      proximity_factor(Parameters::proximity_factor),
+      max_routing_table_size(Parameters::max_routing_table_size),
+      routing_table_size_threshold(Parameters::routing_table_size_threshold),
+      max_routing_table_size_for_client(Parameters::max_routing_table_size_for_client),
+      routing_table_ready_to_response(Parameters::routing_table_ready_to_response),
+      unidirectional_interest_range(Parameters::unidirectional_interest_range),
+      max_route_history(Parameters::max_route_history),
+      hops_to_live(Parameters::hops_to_live),
+      max_send_retry(Parameters::max_send_retry),
+      ack_timeout(Parameters::ack_timeout),
+      min_ack_timeout(Parameters::min_ack_timeout),
+      firewall_history_cleanup_factor(Parameters::firewall_history_cleanup_factor),
+      firewall_message_life(Parameters::firewall_message_life),
+      firewall_max_history(Parameters::firewall_max_history),
+      default_response_timeout(Parameters::default_response_timeout),
+      find_node_interval(Parameters::find_node_interval),
+      recovery_time_lag(Parameters::recovery_time_lag),
+      re_bootstrap_time_lag(Parameters::re_bootstrap_time_lag),
+      find_close_node_interval(Parameters::find_close_node_interval),
+      max_retries_in_flight(Parameters::max_retries_in_flight),
+      retry_base_delay(Parameters::retry_base_delay),
+      retry_max_delay(Parameters::retry_max_delay),
+      retry_budget(Parameters::retry_budget),
+      coalescing_window(Parameters::coalescing_window),
+      max_coalesced_message_size(Parameters::max_coalesced_message_size),
+      max_batch_size(Parameters::max_batch_size),
+      ack_batch_window(Parameters::ack_batch_window),
+      max_batched_acks(Parameters::max_batched_acks),
+      end_to_end_acks(Parameters::end_to_end_acks),
+      hedged_direct_sends(Parameters::hedged_direct_sends),
+      hedge_min_delay(Parameters::hedge_min_delay),
+      hedge_max_delay(Parameters::hedge_max_delay),
+      max_messages_in_flight(Parameters::max_messages_in_flight),
+      max_messages_in_flight_per_hop(Parameters::max_messages_in_flight_per_hop),
+      priority_starvation_limit(Parameters::priority_starvation_limit) {}
+
 }  // namespace routing
 
 }  // namespace maidsafe
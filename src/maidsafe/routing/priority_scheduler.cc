@@ -0,0 +1,135 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/priority_scheduler.h"
+
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const size_t kClassCount(static_cast<size_t>(MessagePriority::kCount));
+
+}  // unnamed namespace
+
+MessagePriority Priority(const protobuf::Message& message) {
+  if (IsRoutingMessage(message))
+    return MessagePriority::kControl;
+  if (IsCacheableGet(message) || IsCacheablePut(message))
+    return MessagePriority::kCache;
+  return IsDirect(message) ? MessagePriority::kDirect : MessagePriority::kGroup;
+}
+
+struct PriorityScheduler::State {
+  explicit State(unsigned int starvation_limit_in)
+      : mutex(), queues(), skipped(), starvation_limit(starvation_limit_in) {}
+
+  std::mutex mutex;
+  std::array<std::deque<std::function<void()>>, kClassCount> queues;
+  // Tasks of more urgent classes run since each class last ran, while it had tasks waiting.
+  std::array<unsigned int, kClassCount> skipped;
+  const unsigned int starvation_limit;
+};
+
+PriorityScheduler::PriorityScheduler(BoostAsioService& asio_service, const RoutingConfig& config)
+    : asio_service_(asio_service),
+      state_(std::make_shared<State>(config.priority_starvation_limit)) {
+  state_->skipped.fill(0);
+}
+
+PriorityScheduler::~PriorityScheduler() {
+  CancelAll();
+}
+
+void PriorityScheduler::Post(MessagePriority priority, std::function<void()> task) {
+  assert(priority < MessagePriority::kCount);
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->queues[static_cast<size_t>(priority)].push_back(std::move(task));
+  }
+  std::weak_ptr<State> weak_state(state_);
+  asio_service_.service().post([weak_state] { RunNext(weak_state); });
+}
+
+void PriorityScheduler::RunNext(std::weak_ptr<State> weak_state) {
+  std::function<void()> task;
+  {
+    auto state(weak_state.lock());
+    if (!state)
+      return;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    size_t chosen(kClassCount);
+    for (size_t index(0); index != kClassCount; ++index) {
+      if (state->queues[index].empty())
+        continue;
+      if (chosen == kClassCount) {
+        chosen = index;
+      } else if (state->starvation_limit != 0 &&
+                 state->skipped[index] >= state->starvation_limit) {
+        chosen = index;
+        break;
+      }
+    }
+    // The queue may have been emptied by CancelAll.
+    if (chosen == kClassCount)
+      return;
+    for (size_t index(chosen + 1); index < kClassCount; ++index) {
+      if (!state->queues[index].empty())
+        ++state->skipped[index];
+    }
+    state->skipped[chosen] = 0;
+    task = std::move(state->queues[chosen].front());
+    state->queues[chosen].pop_front();
+  }
+  task();
+}
+
+void PriorityScheduler::CancelAll() {
+  std::array<std::deque<std::function<void()>>, kClassCount> queues;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    queues.swap(state_->queues);
+    state_->skipped.fill(0);
+  }
+}
+
+size_t PriorityScheduler::queued() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  size_t count(0);
+  for (const auto& queue : state_->queues)
+    count += queue.size();
+  return count;
+}
+
+size_t PriorityScheduler::queued(MessagePriority priority) const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->queues[static_cast<size_t>(priority)].size();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
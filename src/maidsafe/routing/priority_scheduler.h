@@ -0,0 +1,83 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_PRIORITY_SCHEDULER_H_
+#define MAIDSAFE_ROUTING_PRIORITY_SCHEDULER_H_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "maidsafe/common/asio_service.h"
+
+#include "maidsafe/routing/routing_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace protobuf { class Message; }
+
+// Classes of message, most urgent first.
+enum class MessagePriority : int32_t {
+  kControl = 0,  // routing messages, e.g. connect, find nodes and acks
+  kGroup,
+  kDirect,
+  kCache,
+  kCount
+};
+
+MessagePriority Priority(const protobuf::Message& message);
+
+// Runs tasks on an asio service's threads in priority order rather than the order posted, so that
+// routing control traffic is not held up behind a backlog of node-level data.  Each class has its
+// own queue, and every Post posts one handler which runs the first task of the most urgent class
+// waiting.  To keep lower classes from starving, a task which has waited while
+// priority_starvation_limit tasks of more urgent classes ran is run next regardless.
+class PriorityScheduler {
+ public:
+  PriorityScheduler(BoostAsioService& asio_service, const RoutingConfig& config = RoutingConfig());
+  // Drops any tasks still queued without running them.
+  ~PriorityScheduler();
+
+  void Post(MessagePriority priority, std::function<void()> task);
+  void CancelAll();
+
+  size_t queued() const;
+  size_t queued(MessagePriority priority) const;
+
+ private:
+  struct State;
+
+  PriorityScheduler(const PriorityScheduler&);
+  PriorityScheduler(const PriorityScheduler&&);
+  PriorityScheduler& operator=(const PriorityScheduler&);
+
+  static void RunNext(std::weak_ptr<State> state);
+
+  BoostAsioService& asio_service_;
+  // Shared with posted handlers so that a handler outliving the scheduler is harmless.
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PRIORITY_SCHEDULER_H_
@@ -25,12 +25,26 @@ namespace maidsafe {
 namespace routing {
 
 PublicKeyHolder::PublicKeyHolder(BoostAsioService& io_service, Network &network)
-    : mutex_(), io_service_(io_service), network_(network), elements_() {}
+    : mutex_(),
+      io_service_(io_service),
+      own_timing_wheel_(new TimingWheel(io_service)),
+      timing_wheel_(*own_timing_wheel_),
+      network_(network),
+      elements_() {}
+
+PublicKeyHolder::PublicKeyHolder(BoostAsioService& io_service, TimingWheel& timing_wheel,
+                                 Network &network)
+    : mutex_(),
+      io_service_(io_service),
+      own_timing_wheel_(),
+      timing_wheel_(timing_wheel),
+      network_(network),
+      elements_() {}
 
 PublicKeyHolder::~PublicKeyHolder() {
   std::for_each(std::begin(elements_), std::end(elements_),
-                [](const PublicKeyInfo& info) {
-                  info.timer->cancel();
+                [this](const PublicKeyInfo& info) {
+                  timing_wheel_.Cancel(info.timer);
                 });
   while (!elements_.empty()) {}
 }
@@ -42,21 +56,21 @@ bool PublicKeyHolder::Add(const NodeId& peer, const asymm::PublicKey& public_key
                     return info.peer == peer;
                   }))
     return false;
-  auto timer(std::make_shared<boost::asio::deadline_timer>(
-      io_service_.service(), boost::posix_time::seconds(Parameters::public_key_holding_time)));
-  timer->async_wait([peer, this](const boost::system::error_code& error) {
-                      {
-                        std::lock_guard<std::mutex> lock(mutex_);
-                        this->elements_.erase(std::remove_if(
-                            std::begin(this->elements_), std::end(this->elements_),
-                            [peer](const PublicKeyInfo& info) {
-                              return info.peer == peer;
-                            }), std::end(this->elements_));
-                      }
-                      if (!error) {
-                        this->network_.Remove(peer);
-                      }
-                    });
+  auto timer(timing_wheel_.Schedule(
+      std::chrono::seconds(Parameters::public_key_holding_time),
+      [peer, this](const boost::system::error_code& error) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          this->elements_.erase(std::remove_if(
+              std::begin(this->elements_), std::end(this->elements_),
+              [peer](const PublicKeyInfo& info) {
+                return info.peer == peer;
+              }), std::end(this->elements_));
+        }
+        if (!error) {
+          this->network_.Remove(peer);
+        }
+      }));
   elements_.emplace_back(PublicKeyInfo(peer, public_key, timer));
   return true;
 }
@@ -75,7 +89,7 @@ boost::optional<asymm::PublicKey> PublicKeyHolder::Find(const NodeId& peer) cons
 }
 
 void PublicKeyHolder::Remove(const NodeId& peer) {
-  TimerPointer timer;
+  TimingWheel::TimerId timer(0);
   {
     std::lock_guard<std::mutex> lock(mutex_);
     auto element(std::find_if(std::begin(elements_), std::end(elements_),
@@ -87,7 +101,7 @@ void PublicKeyHolder::Remove(const NodeId& peer) {
       timer = element->timer;
     }
   }
-  timer->cancel();
+  timing_wheel_.Cancel(timer);
 }
 
 }  // namespace routing
@@ -19,16 +19,17 @@
 #ifndef MAIDSAFE_ROUTING_PUBLIC_KEY_HOLDER_H_
 #define MAIDSAFE_ROUTING_PUBLIC_KEY_HOLDER_H_
 
+#include <memory>
 #include <vector>
 #include <mutex>
 
-#include "boost/asio/deadline_timer.hpp"
 #include "boost/optional.hpp"
 
 #include "maidsafe/common/rsa.h"
 #include "maidsafe/common/asio_service.h"
 
 #include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/timing_wheel.h"
 
 
 namespace maidsafe {
@@ -37,20 +38,23 @@ namespace routing {
 
 class Network;
 
-typedef std::shared_ptr<boost::asio::deadline_timer> TimerPointer;
 typedef std::function<void(const boost::system::error_code& error)> Handler;
 
 struct PublicKeyInfo {
-  PublicKeyInfo(const NodeId& peer_in, const asymm::PublicKey public_key_in, TimerPointer timer_in)
+  PublicKeyInfo(const NodeId& peer_in, const asymm::PublicKey public_key_in,
+                TimingWheel::TimerId timer_in)
       : peer(peer_in), public_key(public_key_in), timer(timer_in) {}
   NodeId peer;
   asymm::PublicKey public_key;
-  TimerPointer timer;
+  TimingWheel::TimerId timer;
 };
 
 class PublicKeyHolder {
  public:
+  // Keeps its timers on a timing wheel of its own.
   explicit PublicKeyHolder(BoostAsioService& asio_service, Network& network);
+  // Keeps its timers on 'timing_wheel', which must outlive this.
+  PublicKeyHolder(BoostAsioService& asio_service, TimingWheel& timing_wheel, Network& network);
   PublicKeyHolder(const PublicKeyHolder&) = delete;
   PublicKeyHolder& operator=(const PublicKeyHolder&) = delete;
   PublicKeyHolder(const PublicKeyHolder&&) = delete;
@@ -63,6 +67,8 @@ class PublicKeyHolder {
  private:
   mutable std::mutex mutex_;
   BoostAsioService& io_service_;
+  std::unique_ptr<TimingWheel> own_timing_wheel_;
+  TimingWheel& timing_wheel_;
   Network& network_;
   std::vector<PublicKeyInfo> elements_;
 };
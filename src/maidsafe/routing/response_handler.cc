@@ -22,6 +22,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <utility>
 
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/node_id.h"
@@ -118,9 +119,10 @@ void ResponseHandler::Connect(protobuf::Message& message) {
       return;
     }
 
-    auto result(AddToRudp(network_, routing_table_.kNodeId(), routing_table_.kConnectionId(),
-                          peer_node_id, peer_connection_id, peer_endpoint_pair, true,  // requestor
-                          routing_table_.client_mode()));
+    auto result(AddToRudp(network_, routing_table_.config(), routing_table_.kNodeId(),
+                          routing_table_.kConnectionId(), peer_node_id, peer_connection_id,
+                          peer_endpoint_pair, true,  // requestor
+                          routing_table_.client_mode(), routing_table_.Coordinates()));
     if (result != kSuccess)
       LOG(kWarning) << "Already added node";
   }
@@ -153,6 +155,13 @@ void ResponseHandler::FindNodes(const protobuf::Message& message) {
   //    return;  // we never requested this
   //  }
 
+  if (message.has_source_id() && find_nodes_response.coordinates_size() != 0) {
+    routing_table_.SetCoordinates(
+        NodeId(message.source_id()),
+        std::vector<int32_t>(find_nodes_response.coordinates().begin(),
+                             find_nodes_response.coordinates().end()));
+  }
+
   for (int i = 0; i < find_nodes_response.nodes_size(); ++i) {
     if (!find_nodes_response.nodes(i).empty())
       CheckAndSendConnectRequest(NodeId(find_nodes_response.nodes(i)));
@@ -164,8 +173,9 @@ void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
     LOG(kWarning) << "Need to re bootstrap !";
     return;
   }
-  bool send_to_bootstrap_connection((routing_table_.size() < Parameters::closest_nodes_size) &&
-                                    network_.bootstrap_connection_id().IsValid());
+  bool send_to_bootstrap_connection(
+      (routing_table_.size() < routing_table_.config().closest_nodes_size) &&
+      network_.bootstrap_connection_id().IsValid());
   NodeInfo peer;
   peer.id = peer_node_id;
 
@@ -200,8 +210,9 @@ void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
       relay_message = true;
     }
     protobuf::Message connect_rpc(rpcs::Connect(
-        peer.id, this_endpoint_pair, routing_table_.kNodeId(), routing_table_.kConnectionId(),
-        routing_table_.client_mode(), this_nat_type, relay_message, relay_connection_id));
+        routing_table_.config(), peer.id, this_endpoint_pair, routing_table_.kNodeId(),
+        routing_table_.kConnectionId(), routing_table_.client_mode(), this_nat_type, relay_message,
+        relay_connection_id));
     if (send_to_bootstrap_connection)
       network_.SendToDirect(connect_rpc, network_.bootstrap_connection_id(),
                             network_.bootstrap_connection_id());
@@ -228,6 +239,8 @@ void ResponseHandler::ConnectSuccessAcknowledgement(protobuf::Message& message)
     peer.id = NodeId(connect_success_ack.node_id());
   if (!connect_success_ack.connection_id().empty())
     peer.connection_id = NodeId(connect_success_ack.connection_id());
+  peer.dimension_list.assign(connect_success_ack.coordinates().begin(),
+                             connect_success_ack.coordinates().end());
   if (!peer.id.IsValid()) {
     LOG(kWarning) << "Invalid node id provided";
     return;
@@ -257,7 +270,8 @@ void ResponseHandler::ValidateAndCompleteConnectionToClient(const NodeInfo& peer
                                                             bool from_requestor,
                                                             const std::vector<NodeId>& close_ids) {
   if (ValidateAndAddToRoutingTable(network_, routing_table_, client_routing_table_, peer.id,
-                                   peer.connection_id, asymm::PublicKey(), true)) {
+                                   peer.connection_id, asymm::PublicKey(), true,
+                                   peer.dimension_list)) {
     if (from_requestor) {
       HandleSuccessAcknowledgementAsReponder(peer, true);
     } else {
@@ -274,7 +288,8 @@ void ResponseHandler::ValidateAndCompleteConnectionToNonClient(
   }
   public_key_holder_.Remove(peer.id);
   if (ValidateAndAddToRoutingTable(network_, routing_table_, client_routing_table_, peer.id,
-                                   peer.connection_id, *peer_public_key, false)) {
+                                   peer.connection_id, *peer_public_key, false,
+                                   peer.dimension_list)) {
     if (from_requestor) {
       HandleSuccessAcknowledgementAsReponder(peer, false);
     } else {
@@ -284,8 +299,8 @@ void ResponseHandler::ValidateAndCompleteConnectionToNonClient(
 }
 
 void ResponseHandler::HandleSuccessAcknowledgementAsReponder(NodeInfo peer, bool client) {
-  auto count =
-      (client ? Parameters::max_routing_table_size_for_client : Parameters::max_routing_table_size);
+  auto count(client ? routing_table_.config().max_routing_table_size_for_client
+                    : routing_table_.config().max_routing_table_size);
   auto close_nodes_for_peer(routing_table_.GetClosestNodes(peer.id, count));
   auto itr(std::find_if(std::begin(close_nodes_for_peer), std::end(close_nodes_for_peer),
                         [=](const NodeInfo&  info)->bool {
@@ -295,9 +310,9 @@ void ResponseHandler::HandleSuccessAcknowledgementAsReponder(NodeInfo peer, bool
     close_nodes_for_peer.erase(itr);
 
   protobuf::Message connect_success_ack(rpcs::ConnectSuccessAcknowledgement(
-      peer.id, routing_table_.kNodeId(), routing_table_.kConnectionId(),
+      routing_table_.config(), peer.id, routing_table_.kNodeId(), routing_table_.kConnectionId(),
       false,  // this node is responder
-      close_nodes_for_peer, routing_table_.client_mode()));
+      close_nodes_for_peer, routing_table_.client_mode(), routing_table_.Coordinates()));
   network_.SendToDirect(connect_success_ack, peer.id, peer.connection_id);
 }
 
@@ -317,8 +332,9 @@ void ResponseHandler::CheckAndSendConnectRequest(const NodeId& node_id) {
     return;
   if (public_key_holder_.Find(node_id))
     return;
-  unsigned int limit(routing_table_.client_mode() ? Parameters::max_routing_table_size_for_client
-                                                  : Parameters::closest_nodes_size);
+  unsigned int limit(routing_table_.client_mode()
+                         ? routing_table_.config().max_routing_table_size_for_client
+                         : routing_table_.config().closest_nodes_size);
   if ((routing_table_.size() < routing_table_.kMaxSize()) ||
       NodeId::CloserToTarget(
           node_id, routing_table_.GetNthClosestNode(routing_table_.kNodeId(), limit).id,
@@ -400,7 +416,7 @@ void ResponseHandler::GetGroup(Timer<std::string>& timer, protobuf::Message& mes
   try {
     if (!message.has_id() || message.data_size() != 1)
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
-    timer.AddResponse(message.id(), message.data(0));
+    timer.AddResponse(message.id(), std::move(*message.mutable_data(0)));
   }
   catch (const maidsafe_error& e) {
     LOG(kError) << e.what();
@@ -0,0 +1,160 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/retry_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "boost/asio/error.hpp"
+#include "boost/asio/steady_timer.hpp"
+
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+std::chrono::milliseconds DelayFor(unsigned int failures, std::chrono::milliseconds base_delay,
+                                   std::chrono::milliseconds max_delay) {
+  auto delay(base_delay);
+  for (unsigned int i(0); i != failures && delay < max_delay; ++i)
+    delay *= 2;
+  return std::min(delay, max_delay);
+}
+
+}  // unnamed namespace
+
+struct RetryScheduler::State {
+  struct Pending {
+    std::unique_ptr<boost::asio::steady_timer> timer;
+    std::function<void()> retry;
+  };
+
+  explicit State(unsigned int budget_in)
+      : mutex(), pending(), failures(), next_retry_id(0), budget(budget_in),
+        last_refill(std::chrono::steady_clock::now()) {}
+
+  std::mutex mutex;
+  std::map<uint64_t, Pending> pending;
+  // Consecutive failures per peer since its last Reset.
+  std::map<NodeId, unsigned int> failures;
+  uint64_t next_retry_id;
+  double budget;
+  std::chrono::steady_clock::time_point last_refill;
+};
+
+RetryScheduler::RetryScheduler(BoostAsioService& asio_service, const RoutingConfig& config)
+    : asio_service_(asio_service),
+      kMaxRetriesInFlight_(config.max_retries_in_flight),
+      kBaseDelay_(config.retry_base_delay),
+      kMaxDelay_(std::max(config.retry_max_delay, config.retry_base_delay)),
+      kBudget_(config.retry_budget),
+      state_(std::make_shared<State>(kBudget_)) {}
+
+RetryScheduler::~RetryScheduler() {
+  CancelAll();
+}
+
+bool RetryScheduler::Schedule(const NodeId& peer_id, std::function<void()> retry) {
+  if (!retry)
+    return false;
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  if (state_->pending.size() >= kMaxRetriesInFlight_) {
+    LOG(kWarning) << "Refusing retry to " << DebugId(peer_id) << ": " << state_->pending.size()
+                  << " retries already pending.";
+    return false;
+  }
+
+  auto now(std::chrono::steady_clock::now());
+  auto elapsed(std::chrono::duration_cast<std::chrono::duration<double>>(
+      now - state_->last_refill));
+  state_->budget = std::min(static_cast<double>(kBudget_),
+                            state_->budget + elapsed.count() * kBudget_);
+  state_->last_refill = now;
+  if (state_->budget < 1.0) {
+    LOG(kWarning) << "Refusing retry to " << DebugId(peer_id) << ": retry budget exhausted.";
+    return false;
+  }
+  state_->budget -= 1.0;
+
+  auto& failures(state_->failures[peer_id]);
+  auto delay(DelayFor(failures, kBaseDelay_, kMaxDelay_));
+  if (delay < kMaxDelay_)
+    ++failures;
+  // Wait somewhere in the upper half of the backoff.
+  auto half(delay.count() / 2);
+  delay = std::chrono::milliseconds(half + RandomUint32() % (delay.count() - half + 1));
+
+  auto retry_id(state_->next_retry_id++);
+  auto& pending(state_->pending[retry_id]);
+  pending.timer.reset(new boost::asio::steady_timer(asio_service_.service(), delay));
+  pending.retry = std::move(retry);
+  std::weak_ptr<State> state(state_);
+  pending.timer->async_wait([state, retry_id](const boost::system::error_code& error) {
+    Fire(state, retry_id, error == boost::asio::error::operation_aborted);
+  });
+  return true;
+}
+
+void RetryScheduler::Fire(std::weak_ptr<State> weak_state, uint64_t retry_id, bool cancelled) {
+  std::function<void()> retry;
+  {
+    auto state(weak_state.lock());
+    if (!state)
+      return;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    auto itr(state->pending.find(retry_id));
+    if (itr == std::end(state->pending))
+      return;
+    retry = std::move(itr->second.retry);
+    state->pending.erase(itr);
+  }
+  if (!cancelled)
+    retry();
+}
+
+void RetryScheduler::Reset(const NodeId& peer_id) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->failures.erase(peer_id);
+}
+
+void RetryScheduler::CancelAll() {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  // Destroying the timers aborts their waits; the handlers then find nothing left to run.
+  state_->pending.clear();
+  state_->failures.clear();
+}
+
+size_t RetryScheduler::in_flight() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->pending.size();
+}
+
+std::chrono::milliseconds RetryScheduler::Backoff(const NodeId& peer_id) const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  auto itr(state_->failures.find(peer_id));
+  return DelayFor(itr == std::end(state_->failures) ? 0 : itr->second, kBaseDelay_, kMaxDelay_);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
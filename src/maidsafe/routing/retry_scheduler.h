@@ -0,0 +1,81 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_RETRY_SCHEDULER_H_
+#define MAIDSAFE_ROUTING_RETRY_SCHEDULER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/routing_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Defers retries of failed sends on asio timers, so that waiting to retry never blocks an io
+// thread.  Each peer has its own backoff, doubling from retry_base_delay with every consecutive
+// failure up to retry_max_delay, with random jitter so that retries to a peer which dropped many
+// messages at once do not all fire together.  Retries are refused once max_retries_in_flight are
+// waiting, or once the retry budget (retry_budget per second, refilled continuously) is spent.
+class RetryScheduler {
+ public:
+  RetryScheduler(BoostAsioService& asio_service, const RoutingConfig& config = RoutingConfig());
+  // Cancels all pending retries without running them.
+  ~RetryScheduler();
+
+  // Runs 'retry' on an io thread once the backoff for 'peer_id' has elapsed.  Returns false, and
+  // never runs 'retry', if the retry was refused.
+  bool Schedule(const NodeId& peer_id, std::function<void()> retry);
+  // Resets the backoff for 'peer_id', e.g. after a successful send or once the peer is dropped.
+  void Reset(const NodeId& peer_id);
+  void CancelAll();
+
+  size_t in_flight() const;
+  // The upper bound of the delay the next retry to 'peer_id' would wait.
+  std::chrono::milliseconds Backoff(const NodeId& peer_id) const;
+
+ private:
+  struct State;
+
+  RetryScheduler(const RetryScheduler&);
+  RetryScheduler(const RetryScheduler&&);
+  RetryScheduler& operator=(const RetryScheduler&);
+
+  static void Fire(std::weak_ptr<State> state, uint64_t retry_id, bool cancelled);
+
+  BoostAsioService& asio_service_;
+  const unsigned int kMaxRetriesInFlight_;
+  const std::chrono::milliseconds kBaseDelay_, kMaxDelay_;
+  const unsigned int kBudget_;
+  // Shared with pending timer handlers so that a handler outliving the scheduler is harmless.
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_RETRY_SCHEDULER_H_
@@ -28,15 +28,21 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
 }
 
 Routing::Routing() : pimpl_() {
-  InitialisePimpl(true, NodeId(RandomString(NodeId::kSize)), asymm::GenerateKeyPair());
+  InitialisePimpl(true, NodeId(RandomString(NodeId::kSize)), asymm::GenerateKeyPair(),
+                  RoutingConfig());
+}
+
+Routing::Routing(const RoutingConfig& config) : pimpl_() {
+  InitialisePimpl(true, NodeId(RandomString(NodeId::kSize)), asymm::GenerateKeyPair(), config);
 }
 
 Routing::~Routing() {
   pimpl_->Stop();
 }
 
-void Routing::InitialisePimpl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys) {
-  pimpl_.reset(new Impl(client_mode, node_id, keys));
+void Routing::InitialisePimpl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                              const RoutingConfig& config) {
+  pimpl_.reset(new Impl(client_mode, node_id, keys, config));
 }
 
 void Routing::Join(Functors functors) {
@@ -74,6 +80,18 @@ void Routing::Send(const GroupToSingleRelayMessage& message) {
   pimpl_->Send(message);
 }
 
+PendingResponse::PendingResponse() : task_id_(0), ack_id_(0), response_() {}
+
+PendingResponse::PendingResponse(PendingResponse&& other)
+    : task_id_(other.task_id_), ack_id_(other.ack_id_), response_(std::move(other.response_)) {}
+
+PendingResponse& PendingResponse::operator=(PendingResponse&& other) {
+  task_id_ = other.task_id_;
+  ack_id_ = other.ack_id_;
+  response_ = std::move(other.response_);
+  return *this;
+}
+
 void Routing::SendDirect(const NodeId& destination_id, const std::string& message, bool cacheable,
                          ResponseFunctor response_functor) {
   return pimpl_->SendDirect(destination_id, message, cacheable, response_functor);
@@ -84,6 +102,36 @@ void Routing::SendGroup(const NodeId& destination_id, const std::string& message
   return pimpl_->SendGroup(destination_id, message, cacheable, response_functor);
 }
 
+void Routing::SendGroup(const NodeId& destination_id, const std::string& message, bool cacheable,
+                        int quorum, ResponseFunctor response_functor,
+                        ResponseMatchFunctor response_match) {
+  return pimpl_->SendGroup(destination_id, message, cacheable, quorum, response_functor,
+                           response_match);
+}
+
+PendingResponse Routing::SendDirectAsync(const NodeId& destination_id, const std::string& message,
+                                         bool cacheable) {
+  PendingResponse pending_response;
+  pending_response.response_ = pimpl_->SendDirectAsync(destination_id, message, cacheable,
+                                                       pending_response.task_id_,
+                                                       pending_response.ack_id_);
+  return pending_response;
+}
+
+PendingResponse Routing::SendGroupAsync(const NodeId& destination_id, const std::string& message,
+                                        bool cacheable, int quorum,
+                                        ResponseMatchFunctor response_match) {
+  PendingResponse pending_response;
+  pending_response.response_ = pimpl_->SendGroupAsync(destination_id, message, cacheable, quorum,
+                                                      response_match, pending_response.task_id_,
+                                                      pending_response.ack_id_);
+  return pending_response;
+}
+
+void Routing::CancelRequest(const PendingResponse& pending_response) {
+  pimpl_->CancelRequest(pending_response.task_id_, pending_response.ack_id_);
+}
+
 bool Routing::ClosestToId(const NodeId& target_id) { return pimpl_->ClosestToId(target_id); }
 
 NodeId Routing::RandomConnectedNode() { return pimpl_->RandomConnectedNode(); }
@@ -18,7 +18,9 @@
 
 #include "maidsafe/routing/routing_impl.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <type_traits>
 
 #include "maidsafe/common/log.h"
@@ -48,6 +50,13 @@ namespace {
 
 typedef boost::asio::ip::udp::endpoint Endpoint;
 
+// Moves 'proto_message' into a shared message without copying it, leaving 'proto_message' empty.
+std::shared_ptr<protobuf::Message> TakeMessage(protobuf::Message& proto_message) {
+  auto message(std::make_shared<protobuf::Message>());
+  message->Swap(&proto_message);
+  return message;
+}
+
 }  // unnamed namespace
 
 namespace detail {}  // namespace detail
@@ -57,6 +66,7 @@ void Routing::Impl::Send(const GroupToSingleRelayMessage& message) {
   assert(!functors_.message_and_caching.message_received &&
          "Not allowed with string type message API");
   protobuf::Message proto_message = CreateNodeLevelMessage(message);
+  AcquireSendCredit(proto_message);
   // append relay information
   SendMessage(message.receiver.relay_node, proto_message);
 }
@@ -73,8 +83,8 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const GroupToSingleRelay
   proto_message.set_client_node(routing_table_->client_mode());
 
   proto_message.set_request(true);
-  proto_message.set_hops_to_live(Parameters::hops_to_live);
-  proto_message.set_ack_id(network_utils_.acknowledgement_.GetId());
+  proto_message.set_hops_to_live(kConfig_.hops_to_live);
+  network_utils_.acknowledgement_.SetAckId(proto_message);
 
   AddGroupSourceRelatedFields(message, proto_message,
                               detail::is_group_source<GroupToSingleRelayMessage>());
@@ -90,10 +100,12 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const GroupToSingleRelay
   return proto_message;
 }
 
-Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys)
+Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                    const RoutingConfig& config)
     : network_status_mutex_(),
       network_status_(kNotJoined),
-      routing_table_(maidsafe::make_unique<RoutingTable>(client_mode, node_id, keys)),
+      kConfig_(config),
+      routing_table_(maidsafe::make_unique<RoutingTable>(client_mode, node_id, keys, kConfig_)),
       kNodeId_(node_id),
       running_(true),
       running_mutex_(),
@@ -103,15 +115,23 @@ Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys&
       client_routing_table_(node_id),
       message_handler_(),
       asio_service_(2),
-      network_utils_(node_id, asio_service_),
+      timing_wheel_(asio_service_),
+      network_utils_(node_id, asio_service_, timing_wheel_, kConfig_),
+      scheduler_(asio_service_, kConfig_),
       network_(maidsafe::make_unique<Network>(*routing_table_, client_routing_table_,
-                                              network_utils_.acknowledgement_)),
-      timer_(asio_service_),
+                                              network_utils_.acknowledgement_, asio_service_)),
+      timer_(asio_service_, timing_wheel_),
       re_bootstrap_timer_(asio_service_.service()),
       recovery_timer_(asio_service_.service()),
       setup_timer_(asio_service_.service()) {
   message_handler_.reset(new MessageHandler(*routing_table_, client_routing_table_, *network_,
-                                            timer_, network_utils_, asio_service_));
+                                            timer_, network_utils_, asio_service_,
+                                            timing_wheel_));
+  network_utils_.flow_control_.SetReadyFunctor([this] {
+    std::lock_guard<std::mutex> lock(running_mutex_);
+    if (running_ && functors_.send_ready)
+      asio_service_.service().post(functors_.send_ready);
+  });
   assert((client_mode || node_id.IsValid()) && "Server Nodes cannot be created without valid keys");
 }
 
@@ -120,6 +140,8 @@ void Routing::Impl::Stop() {
     std::lock_guard<std::mutex> lock(running_mutex_);
     running_ = false;
   }
+  // Queued tasks hold shared pointers to this.
+  scheduler_.CancelAll();
 
   // below is a work-around and not a fix for routing destruction issues.
   // this must be replaced with an appropriate fix as soon as possible.
@@ -185,7 +207,7 @@ void Routing::Impl::Bootstrap() {
   }
   int return_value(DoBootstrap());
   if (kSuccess != return_value) {
-    re_bootstrap_timer_.expires_from_now(Parameters::re_bootstrap_time_lag);
+    re_bootstrap_timer_.expires_from_now(kConfig_.re_bootstrap_time_lag);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     re_bootstrap_timer_.async_wait(
         [this_ptr](boost::system::error_code error_code) {
@@ -241,7 +263,7 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
       if (!running_)
         return;
       // Exit the loop & start recovery loop
-      recovery_timer_.expires_from_now(Parameters::find_node_interval);
+      recovery_timer_.expires_from_now(kConfig_.find_node_interval);
       std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
       recovery_timer_.async_wait([this_ptr](const boost::system::error_code& error_code) {
         if (error_code != boost::asio::error::operation_aborted)
@@ -259,7 +281,8 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
   }
 
   int num_nodes_requested(1 + attempts / Parameters::find_node_repeats_per_num_requested);
-  protobuf::Message find_node_rpc(rpcs::FindNodes(kNodeId_, kNodeId_, num_nodes_requested, true,
+  protobuf::Message find_node_rpc(rpcs::FindNodes(kConfig_, kNodeId_, kNodeId_,
+                                                  num_nodes_requested, true,
                                                   network_->this_node_relay_connection_id()));
   std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
   rudp::MessageSentFunctor message_sent_functor([this_ptr, find_node_rpc](int message_sent) {
@@ -274,7 +297,7 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
   std::lock_guard<std::mutex> lock(running_mutex_);
   if (!running_)
     return;
-  setup_timer_.expires_from_now(Parameters::find_close_node_interval);
+  setup_timer_.expires_from_now(kConfig_.find_close_node_interval);
   setup_timer_.async_wait([this_ptr, attempts](boost::system::error_code error_code_local) {
     if (error_code_local != boost::asio::error::operation_aborted)
       this_ptr->FindClosestNode(error_code_local, attempts);
@@ -337,7 +360,7 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
       return kNetworkShuttingDown;
-    recovery_timer_.expires_from_now(Parameters::find_node_interval);
+    recovery_timer_.expires_from_now(kConfig_.find_node_interval);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     recovery_timer_.async_wait([this_ptr](const boost::system::error_code& error_code) {
       if (error_code != boost::asio::error::operation_aborted)
@@ -364,42 +387,116 @@ void Routing::Impl::SendGroup(const NodeId& destination_id, const std::string& d
   Send(destination_id, data, DestinationType::kGroup, cacheable, response_functor);
 }
 
+void Routing::Impl::SendGroup(const NodeId& destination_id, const std::string& data,
+                              bool cacheable, int quorum, ResponseFunctor response_functor,
+                              ResponseMatchFunctor response_match) {
+  assert(!functors_.typed_message_and_caching.single_to_single.message_received &&
+         "Not allowed with typed Message API");
+  CheckQuorum(quorum);
+  Send(destination_id, data, DestinationType::kGroup, cacheable, response_functor, quorum,
+       response_match);
+}
+
+std::future<std::string> Routing::Impl::SendDirectAsync(const NodeId& destination_id,
+                                                        const std::string& data, bool cacheable,
+                                                        TaskId& task_id, AckId& ack_id) {
+  assert(!functors_.typed_message_and_caching.single_to_single.message_received &&
+         "Not allowed with typed Message API");
+  return Send(destination_id, data, DestinationType::kDirect, cacheable, 0,
+              ResponseMatchFunctor(), task_id, ack_id);
+}
+
+std::future<std::string> Routing::Impl::SendGroupAsync(const NodeId& destination_id,
+                                                       const std::string& data, bool cacheable,
+                                                       int quorum,
+                                                       ResponseMatchFunctor response_match,
+                                                       TaskId& task_id, AckId& ack_id) {
+  assert(!functors_.typed_message_and_caching.single_to_single.message_received &&
+         "Not allowed with typed Message API");
+  CheckQuorum(quorum);
+  return Send(destination_id, data, DestinationType::kGroup, cacheable, quorum, response_match,
+              task_id, ack_id);
+}
+
+void Routing::Impl::CancelRequest(TaskId task_id, AckId ack_id) {
+  try {
+    timer_.CancelTask(task_id);
+  }
+  catch (const maidsafe_error& error) {
+    if (error.code() != make_error_code(CommonErrors::invalid_parameter))
+      throw;
+    return;  // Already completed
+  }
+  // Stops any resending of the message, and returns its flow control credit.
+  network_utils_.acknowledgement_.Remove(ack_id);
+}
+
 void Routing::Impl::Send(const NodeId& destination_id, const std::string& data,
                          const DestinationType& destination_type, bool cacheable,
-                         ResponseFunctor response_functor) {
+                         ResponseFunctor response_functor, int quorum,
+                         ResponseMatchFunctor response_match) {
   CheckSendParameters(destination_id, data);
   protobuf::Message proto_message =
       CreateNodeLevelPartialMessage(destination_id, destination_type, data, cacheable);
+  AcquireSendCredit(proto_message);
   unsigned int expected_response_count(1);
   if (response_functor) {
     if (DestinationType::kGroup == destination_type)
-      expected_response_count = 4;
+      expected_response_count = kConfig_.group_size;
     proto_message.set_id(timer_.NewTaskId());
-    timer_.AddTask(Parameters::default_response_timeout, response_functor, expected_response_count,
-                   proto_message.id());
+    if (quorum != 0) {
+      timer_.AddQuorumTask(kConfig_.default_response_timeout, response_functor,
+                           expected_response_count, quorum, response_match, proto_message.id());
+    } else {
+      timer_.AddTask(kConfig_.default_response_timeout, response_functor,
+                     expected_response_count, proto_message.id());
+    }
   } else {
     proto_message.set_id(0);
   }
   SendMessage(destination_id, proto_message);
 }
 
+std::future<std::string> Routing::Impl::Send(const NodeId& destination_id,
+                                             const std::string& data,
+                                             const DestinationType& destination_type,
+                                             bool cacheable, int quorum,
+                                             ResponseMatchFunctor response_match, TaskId& task_id,
+                                             AckId& ack_id) {
+  CheckSendParameters(destination_id, data);
+  protobuf::Message proto_message =
+      CreateNodeLevelPartialMessage(destination_id, destination_type, data, cacheable);
+  AcquireSendCredit(proto_message);
+  task_id = timer_.NewTaskId();
+  ack_id = proto_message.ack_id();
+  proto_message.set_id(task_id);
+  auto future(DestinationType::kGroup == destination_type
+                  ? timer_.AddQuorumTask(kConfig_.default_response_timeout, kConfig_.group_size,
+                                         quorum, response_match, task_id)
+                  : timer_.AddTask(kConfig_.default_response_timeout, task_id));
+  SendMessage(destination_id, proto_message);
+  return future;
+}
+
 void Routing::Impl::SendMessage(const NodeId& destination_id, protobuf::Message& proto_message) {
+  const AckId kAckId(proto_message.ack_id());
   if (routing_table_->size() == 0) {  // Partial join state
     PartiallyJoinedSend(proto_message);
   } else {  // Normal node
     proto_message.set_source_id(kNodeId_.string());
     if (!proto_message.direct() && !routing_table_->client_mode()) {
-      OnMessageReceived(proto_message.SerializeAsString());
-      return;
-    }
-    if (kNodeId_ != destination_id) {
+      OnMessageReceived(TakeMessage(proto_message));
+    } else if (kNodeId_ != destination_id) {
       network_->SendToClosestNode(proto_message);
     } else if (routing_table_->client_mode()) {
       network_->SendToClosestNode(proto_message);
     } else {
-      OnMessageReceived(proto_message.SerializeAsString());
+      OnMessageReceived(TakeMessage(proto_message));
     }
   }
+  // A message left awaiting no ack, e.g. one handled by this node, no longer needs its credit.
+  if (!network_utils_.acknowledgement_.IsAwaited(kAckId))
+    network_utils_.flow_control_.Release(kAckId);
 }
 
 // Partial join state
@@ -447,18 +544,28 @@ protobuf::Message Routing::Impl::CreateNodeLevelPartialMessage(
   proto_message.set_direct((DestinationType::kDirect == destination_type));
   proto_message.set_client_node(routing_table_->client_mode());
   proto_message.set_request(true);
-  proto_message.set_hops_to_live(Parameters::hops_to_live);
-  proto_message.set_ack_id(network_utils_.acknowledgement_.GetId());
+  proto_message.set_hops_to_live(kConfig_.hops_to_live);
+  network_utils_.acknowledgement_.SetAckId(proto_message);
   unsigned int replication(1);
   if (DestinationType::kGroup == destination_type) {
     proto_message.set_visited(false);
-    replication = Parameters::group_size;
+    replication = kConfig_.group_size;
   }
   proto_message.set_replication(replication);
 
   return proto_message;
 }
 
+// throws
+void Routing::Impl::AcquireSendCredit(const protobuf::Message& proto_message) {
+  const NodeId kNextHop(routing_table_->GetClosestNode(NodeId(proto_message.destination_id()),
+                                                       !proto_message.direct()).id);
+  if (!network_utils_.flow_control_.Acquire(proto_message.ack_id(), kNextHop)) {
+    LOG(kWarning) << "Too many messages in flight, aborted send";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::cannot_exceed_limit));
+  }
+}
+
 // throws
 void Routing::Impl::CheckSendParameters(const NodeId& destination_id, const std::string& data) {
   if (!destination_id.IsValid()) {
@@ -473,6 +580,14 @@ void Routing::Impl::CheckSendParameters(const NodeId& destination_id, const std:
   }
 }
 
+// throws
+void Routing::Impl::CheckQuorum(int quorum) const {
+  if (quorum < 1 || quorum > static_cast<int>(kConfig_.group_size)) {
+    LOG(kError) << "Invalid quorum " << quorum << ", aborted send";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+}
+
 bool Routing::Impl::ClosestToId(const NodeId& target_id) {
   return routing_table_->IsThisNodeClosestTo(target_id, true);
 }
@@ -480,7 +595,7 @@ bool Routing::Impl::ClosestToId(const NodeId& target_id) {
 NodeId Routing::Impl::RandomConnectedNode() { return routing_table_->RandomConnectedNode(); }
 
 bool Routing::Impl::EstimateInGroup(const NodeId& sender_id, const NodeId& info_id) {
-  return ((routing_table_->size() > Parameters::routing_table_ready_to_response) &&
+  return ((routing_table_->size() > kConfig_.routing_table_ready_to_response) &&
           network_utils_.statistics_.EstimateInGroup(sender_id, info_id));
 }
 
@@ -503,54 +618,65 @@ std::future<std::vector<NodeId>> Routing::Impl::GetGroup(const NodeId& group_id)
     }
     promise->set_value(nodes_id);
   };
-  protobuf::Message get_group_message(rpcs::GetGroup(group_id, kNodeId_));
-  get_group_message.set_ack_id(network_utils_.acknowledgement_.GetId());
+  protobuf::Message get_group_message(rpcs::GetGroup(kConfig_, group_id, kNodeId_));
+  network_utils_.acknowledgement_.SetAckId(get_group_message);
   get_group_message.set_id(timer_.NewTaskId());
-  timer_.AddTask(Parameters::default_response_timeout, callback, 1, get_group_message.id());
+  timer_.AddTask(kConfig_.default_response_timeout, callback, 1, get_group_message.id());
   network_->SendToClosestNode(get_group_message);
   return future;
 }
 
 void Routing::Impl::OnMessageReceived(const std::string& message) {
+  // Parsed on rudp's thread, straight from its buffer, rather than copying the buffer to post it.
+  // The buffer may hold a batch of messages coalesced by the sender.
+  auto pb_messages(ParseReceivedMessages(message));
+  if (pb_messages.empty()) {
+    LOG(kWarning) << "Message received, failed to parse";
+    return;
+  }
+  for (const auto& pb_message : pb_messages)
+    OnMessageReceived(pb_message);
+}
+
+void Routing::Impl::OnMessageReceived(std::shared_ptr<protobuf::Message> message) {
   std::lock_guard<std::mutex> lock(running_mutex_);
   if (running_) {
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
-    std::shared_ptr<std::string> message_ptr(new std::string(message.data(), message.size()));
-    asio_service_.service().post([this_ptr, message_ptr]() {
-                                   this_ptr->DoOnMessageReceived(*message_ptr);
-                                 });
+    scheduler_.Post(Priority(*message), [this_ptr, message]() {
+                                          this_ptr->DoOnMessageReceived(*message);
+                                        });
   }
 }
 
-void Routing::Impl::DoOnMessageReceived(const std::string& message) {
-  protobuf::Message pb_message;
-  if (pb_message.ParseFromString(message)) {
-    if ((!pb_message.client_node() && pb_message.has_source_id()) ||
-        (!pb_message.direct() && !pb_message.request())) {
-      NodeId source_id(pb_message.source_id());
-      if (source_id.IsValid())
-        random_node_helper_.Add(source_id);
-    }
-    {
-      std::lock_guard<std::mutex> lock(running_mutex_);
-      if (!running_)
-        return;
-    }
-    if (network_utils_.acknowledgement_.IsSendingAckRequired(pb_message, kNodeId())) {
-      network_->SendAck(pb_message);
-      pb_message.clear_ack_node_ids();
-    }
-    message_handler_->HandleMessage(pb_message);
-  } else {
-    LOG(kWarning) << "Message received, failed to parse";
+void Routing::Impl::DoOnMessageReceived(protobuf::Message& pb_message) {
+  if ((!pb_message.client_node() && pb_message.has_source_id()) ||
+      (!pb_message.direct() && !pb_message.request())) {
+    NodeId source_id(pb_message.source_id());
+    if (source_id.IsValid())
+      random_node_helper_.Add(source_id);
   }
+  {
+    std::lock_guard<std::mutex> lock(running_mutex_);
+    if (!running_)
+      return;
+  }
+  if (pb_message.acked_ids_size() != 0 && pb_message.destination_id() == kNodeId_.string()) {
+    network_utils_.acknowledgement_.HandleMessage(
+        std::vector<AckId>(pb_message.acked_ids().begin(), pb_message.acked_ids().end()));
+    pb_message.clear_acked_ids();
+  }
+  if (network_utils_.acknowledgement_.IsSendingAckRequired(pb_message, kNodeId())) {
+    network_->SendAck(pb_message);
+    pb_message.clear_ack_node_ids();
+  }
+  message_handler_->HandleMessage(pb_message);
 }
 
 void Routing::Impl::OnConnectionLost(const NodeId lost_connection_id) {
   std::lock_guard<std::mutex> lock(running_mutex_);
   if (running_) {
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
-    asio_service_.service().post([this_ptr, lost_connection_id]() {
+    scheduler_.Post(MessagePriority::kControl, [this_ptr, lost_connection_id]() {
       this_ptr->DoOnConnectionLost(lost_connection_id);
     });
   }
@@ -566,7 +692,7 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
   NodeInfo dropped_node;
   bool resend(
       routing_table_->GetNodeInfo(lost_connection_id, dropped_node) &&
-      routing_table_->IsThisNodeInRange(dropped_node.id, Parameters::closest_nodes_size));
+      routing_table_->IsThisNodeInRange(dropped_node.id, kConfig_.closest_nodes_size));
 
   // Checking routing table
   dropped_node = routing_table_->DropNode(lost_connection_id, true);
@@ -611,7 +737,7 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
       return;
     // Close node lost, get more nodes
     LOG(kWarning) << "Lost close node, getting more.";
-    recovery_timer_.expires_from_now(Parameters::recovery_time_lag);
+    recovery_timer_.expires_from_now(kConfig_.recovery_time_lag);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     recovery_timer_.async_wait([this_ptr](const boost::system::error_code& error_code) {
       if (error_code != boost::asio::error::operation_aborted)
@@ -631,7 +757,7 @@ void Routing::Impl::RemoveNode(const NodeInfo& node, bool internal_rudp_only) {
 
   // TODO(Prakash): Handle pseudo connection removal here and NRT node removal
 
-  bool resend(routing_table_->IsThisNodeInRange(node.id, Parameters::closest_nodes_size));
+  bool resend(routing_table_->IsThisNodeInRange(node.id, kConfig_.closest_nodes_size));
   if (resend) {
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
@@ -639,7 +765,7 @@ void Routing::Impl::RemoveNode(const NodeInfo& node, bool internal_rudp_only) {
     // Close node removed by routing, get more nodes
     LOG(kWarning) << "[" << DebugId(kNodeId_)
                   << "] Removed close node, sending find node to get more nodes.";
-    recovery_timer_.expires_from_now(Parameters::recovery_time_lag);
+    recovery_timer_.expires_from_now(kConfig_.recovery_time_lag);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     recovery_timer_.async_wait([this_ptr](const boost::system::error_code& error_code) {
       if (error_code != boost::asio::error::operation_aborted)
@@ -667,14 +793,15 @@ void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error
   } else if (ignore_size || (routing_table_->size() < routing_table_->kThresholdSize())) {
     int num_nodes_requested(0);
     if (ignore_size && (routing_table_->size() > routing_table_->kThresholdSize()))
-      num_nodes_requested = static_cast<int>(Parameters::closest_nodes_size);
+      num_nodes_requested = static_cast<int>(kConfig_.closest_nodes_size);
     else
-      num_nodes_requested = static_cast<int>(Parameters::max_routing_table_size);
+      num_nodes_requested = static_cast<int>(kConfig_.max_routing_table_size);
 
-    protobuf::Message find_node_rpc(rpcs::FindNodes(kNodeId_, kNodeId_, num_nodes_requested));
+    protobuf::Message find_node_rpc(rpcs::FindNodes(kConfig_, kNodeId_, kNodeId_,
+                                                    num_nodes_requested));
     network_->SendToClosestNode(find_node_rpc);
 
-    recovery_timer_.expires_from_now(Parameters::find_node_interval);
+    recovery_timer_.expires_from_now(kConfig_.find_node_interval);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     recovery_timer_.async_wait([this_ptr, error_code](boost::system::error_code error_code_local) {
       if (error_code != boost::asio::error::operation_aborted)
@@ -696,7 +823,7 @@ int Routing::Impl::network_status() {
 }
 
 std::vector<NodeInfo> Routing::Impl::ClosestNodes() {
-  return routing_table_->GetClosestNodes(kNodeId(), Parameters::closest_nodes_size);
+  return routing_table_->GetClosestNodes(kNodeId(), kConfig_.closest_nodes_size);
 }
 
 bool Routing::Impl::IsConnectedVault(const NodeId& node_id) {
@@ -711,7 +838,7 @@ bool Routing::Impl::IsConnectedClient(const NodeId& node_id) {
 void Routing::Impl::AddDestinationTypeRelatedFields(protobuf::Message& proto_message,
                                                     std::true_type) {
   proto_message.set_direct(false);
-  proto_message.set_replication(Parameters::group_size);
+  proto_message.set_replication(kConfig_.group_size);
   proto_message.set_visited(false);
   proto_message.set_group_destination(proto_message.destination_id());
 }
@@ -729,15 +856,13 @@ void Routing::Impl::OnRoutingTableChange(const RoutingTableChange& routing_table
   }
   NotifyNetworkStatus(routing_table_change.health);
 
-  if (routing_table_change.removed.node.id != NodeId()) {
-    RemoveNode(routing_table_change.removed.node,
-               routing_table_change.removed.routing_only_removal);
-  }
+  for (const auto& removed : routing_table_change.removed_nodes)
+    RemoveNode(removed.node, removed.routing_only_removal);
 
   if (routing_table_->client_mode()) {
-    if (routing_table_->size() < Parameters::max_routing_table_size_for_client)
-      network_->SendToClosestNode(rpcs::FindNodes(kNodeId_, kNodeId_,
-                                 Parameters::max_routing_table_size_for_client));
+    if (routing_table_->size() < kConfig_.max_routing_table_size_for_client)
+      network_->SendToClosestNode(rpcs::FindNodes(kConfig_, kNodeId_, kNodeId_,
+                                 kConfig_.max_routing_table_size_for_client));
     return;
   }
 
@@ -751,13 +876,19 @@ void Routing::Impl::OnRoutingTableChange(const RoutingTableChange& routing_table
 
   if (routing_table_change.close_nodes_change && routing_table_change.insertion) {
     auto clients(client_routing_table_.GetNodesInfo());
-    for (auto client : clients)
-      InformClientOfNewCloseNode(*network_, client, routing_table_change.added_node, kNodeId());
+    auto new_close_nodes(routing_table_change.close_nodes_change->new_close_nodes());
+    for (const auto& added_node : routing_table_change.added_nodes) {
+      if (std::find(std::begin(new_close_nodes), std::end(new_close_nodes), added_node.id) ==
+          std::end(new_close_nodes))
+        continue;
+      for (auto client : clients)
+        InformClientOfNewCloseNode(*network_, client, added_node, kNodeId());
+    }
   }
 
-  if (routing_table_->size() > Parameters::routing_table_size_threshold)
-    network_->SendToClosestNode(rpcs::FindNodes(kNodeId_, kNodeId_,
-                                               Parameters::max_routing_table_size));
+  if (routing_table_->size() > kConfig_.routing_table_size_threshold)
+    network_->SendToClosestNode(rpcs::FindNodes(kConfig_, kNodeId_, kNodeId_,
+                                               kConfig_.max_routing_table_size));
 }
 
 }  // namespace routing
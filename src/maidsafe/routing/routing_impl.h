@@ -19,6 +19,7 @@
 #ifndef MAIDSAFE_ROUTING_ROUTING_IMPL_H_
 #define MAIDSAFE_ROUTING_ROUTING_IMPL_H_
 
+#include <future>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -37,11 +38,14 @@
 #include "maidsafe/routing/client_routing_table.h"
 #include "maidsafe/routing/message_handler.h"
 #include "maidsafe/routing/network.h"
+#include "maidsafe/routing/priority_scheduler.h"
 #include "maidsafe/routing/random_node_helper.h"
 #include "maidsafe/routing/routing_api.h"
+#include "maidsafe/routing/routing_config.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/timing_wheel.h"
 #include "maidsafe/routing/network_utils.h"
 
 namespace maidsafe {
@@ -97,7 +101,8 @@ class GenericNode;
 
 class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
  public:
-  Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys);
+  Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+       const RoutingConfig& config);
 
   void Join(const Functors& functors);
 
@@ -114,6 +119,22 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
   void SendGroup(const NodeId& destination_id, const std::string& data, bool cacheable,
                  ResponseFunctor response_functor);
 
+  void SendGroup(const NodeId& destination_id, const std::string& data, bool cacheable,
+                 int quorum, ResponseFunctor response_functor,
+                 ResponseMatchFunctor response_match);
+
+  // Future-returning forms of the above; 'task_id' and 'ack_id' are set to identify the request
+  // for CancelRequest.
+  std::future<std::string> SendDirectAsync(const NodeId& destination_id, const std::string& data,
+                                           bool cacheable, TaskId& task_id, AckId& ack_id);
+
+  std::future<std::string> SendGroupAsync(const NodeId& destination_id, const std::string& data,
+                                          bool cacheable, int quorum,
+                                          ResponseMatchFunctor response_match, TaskId& task_id,
+                                          AckId& ack_id);
+
+  void CancelRequest(TaskId task_id, AckId ack_id);
+
   NodeId GetRandomExistingNode() const { return random_node_helper_.Get(); }
 
   bool ClosestToId(const NodeId& node_id);
@@ -151,7 +172,8 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
   // void OnMessageReceived(const std::string message);
   // void DoOnMessageReceived(const std::string message);
   void OnMessageReceived(const std::string& message);
-  void DoOnMessageReceived(const std::string& message);
+  void OnMessageReceived(std::shared_ptr<protobuf::Message> message);
+  void DoOnMessageReceived(protobuf::Message& pb_message);
   void OnConnectionLost(const NodeId lost_connection_id);
   void DoOnConnectionLost(const NodeId& lost_connection_id);
   void OnRoutingTableChange(const RoutingTableChange& routing_table_change);
@@ -160,13 +182,21 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
   void NotifyNetworkStatus(int return_code) const;
   void Send(const NodeId& destination_id, const std::string& data,
             const DestinationType& destination_type, bool cacheable,
-            ResponseFunctor response_functor);
+            ResponseFunctor response_functor, int quorum = 0,
+            ResponseMatchFunctor response_match = ResponseMatchFunctor());
+  std::future<std::string> Send(const NodeId& destination_id, const std::string& data,
+                                const DestinationType& destination_type, bool cacheable,
+                                int quorum, ResponseMatchFunctor response_match, TaskId& task_id,
+                                AckId& ack_id);
+  void CheckQuorum(int quorum) const;
   void SendMessage(const NodeId& destination_id, protobuf::Message& proto_message);
   void PartiallyJoinedSend(protobuf::Message& proto_message);
   protobuf::Message CreateNodeLevelPartialMessage(const NodeId& destination_id,
                                                   const DestinationType& destination_type,
                                                   const std::string& data, bool cacheable);
   void CheckSendParameters(const NodeId& destination_id, const std::string& data);
+  // Takes a flow control credit for 'proto_message', throwing if none is available.
+  void AcquireSendCredit(const protobuf::Message& proto_message);
 
   template <typename T>
   protobuf::Message CreateNodeLevelMessage(const T& message);
@@ -182,6 +212,7 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
 
   std::mutex network_status_mutex_;
   int network_status_;
+  const RoutingConfig kConfig_;
   std::unique_ptr<RoutingTable> routing_table_;
   const NodeId kNodeId_;
   bool running_;
@@ -190,11 +221,15 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
   RandomNodeHelper random_node_helper_;
   ClientRoutingTable client_routing_table_;
   // The following variables' declarations should remain the last ones in this class and should stay
-  // in the order: message_handler_, asio_service_, network_, all timers.  This is important for the
-  // proper destruction of the routing library, i.e. to avoid segmentation faults.
+  // in the order: message_handler_, asio_service_, timing_wheel_, network_, all timers.  This is
+  // important for the proper destruction of the routing library, i.e. to avoid segmentation faults.
   std::unique_ptr<MessageHandler> message_handler_;
   BoostAsioService asio_service_;
+  // Holds the deadlines of timer_, acks and held public keys, on a single asio timer.
+  TimingWheel timing_wheel_;
   NetworkUtils network_utils_;
+  // Runs received messages on asio_service_ in priority order.
+  PriorityScheduler scheduler_;
   std::unique_ptr<Network> network_;
   Timer<std::string> timer_;
   boost::asio::steady_timer re_bootstrap_timer_, recovery_timer_, setup_timer_;
@@ -212,6 +247,7 @@ void Routing::Impl::Send(const T& message) {  // FIXME(Fix caching)
   assert(!functors_.message_and_caching.message_received &&
          "Not allowed with string type message API");
   protobuf::Message proto_message = CreateNodeLevelMessage(message);
+  AcquireSendCredit(proto_message);
   SendMessage(message.receiver, proto_message);
 }
 
@@ -237,8 +273,8 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const T& message) {
   proto_message.set_client_node(routing_table_->client_mode());
 
   proto_message.set_request(true);
-  proto_message.set_hops_to_live(Parameters::hops_to_live);
-  proto_message.set_ack_id(network_utils_.acknowledgement_.GetId());
+  proto_message.set_hops_to_live(kConfig_.hops_to_live);
+  network_utils_.acknowledgement_.SetAckId(proto_message);
   proto_message.set_id(RandomUint32());
 
   AddGroupSourceRelatedFields(message, proto_message, detail::is_group_source<T>());
@@ -19,10 +19,11 @@
 #include "maidsafe/routing/routing_table.h"
 
 #include <algorithm>
-#include <bitset>
+#include <functional>
 #include <limits>
-#include <map>
 #include <sstream>
+#include <string>
+#include <utility>
 
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/utils.h"
@@ -38,25 +39,206 @@ namespace maidsafe {
 
 namespace routing {
 
-RoutingTable::RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys)
+RoutingTableSnapshot::RoutingTableSnapshot(const NodeId& node_id,
+                                           unsigned int closest_nodes_size)
+    : kNodeId_(node_id),
+      kClosestNodesSize_(closest_nodes_size),
+      nodes_(),
+      node_ids_(),
+      bucket_index_(node_id),
+      slot_by_id_(),
+      slot_by_connection_id_(),
+      ids_by_key_fingerprint_() {}
+
+bool RoutingTableSnapshot::IsThisNodeInRange(const NodeId& target_id,
+                                             const unsigned int range) const {
+  // sort by target will always put the node bearing the same target_id (such as pmid_pub_key)
+  // as the closest if that node is in the routing table
+  if (nodes_.size() < range)
+    return true;
+
+  auto closest_slots(ClosestSlots(target_id, range + 1));
+  auto count(closest_slots.size());
+  bool skip_front(target_id == nodes_[closest_slots.front()].id);
+  if (skip_front && (count == range))
+    return true;
+  return NodeId::CloserToTarget(kNodeId_,
+                                nodes_[closest_slots[count - 1 - (skip_front ? 0 : 1)]].id,
+                                target_id);
+}
+
+bool RoutingTableSnapshot::IsThisNodeClosestTo(const NodeId& target_id,
+                                               bool ignore_exact_match) const {
+  if (target_id == kNodeId_)
+    return false;
+  if (nodes_.empty())
+    return false;
+
+  if (!target_id.IsValid()) {
+    LOG(kError) << "Invalid target_id passed.";
+    return false;
+  }
+
+  NodeInfo closest_node(GetClosestNode(target_id, ignore_exact_match));
+  return (closest_node.bucket == NodeInfo::kInvalidBucket) ||
+         NodeId::CloserToTarget(kNodeId_, closest_node.id, target_id);
+}
+
+bool RoutingTableSnapshot::Contains(const NodeId& node_id) const {
+  return Find(node_id) != nodes_.size();
+}
+
+bool RoutingTableSnapshot::ContainsPublicKey(const NodeInfo& node) const {
+  auto fingerprint_range(ids_by_key_fingerprint_.equal_range(node.public_key_fingerprint));
+  return std::any_of(fingerprint_range.first, fingerprint_range.second,
+                     [&](const std::pair<const uint64_t, NodeId>& entry) {
+                       return asymm::MatchingKeys(nodes_[Find(entry.second)].public_key,
+                                                  node.public_key);
+                     });
+}
+
+bool RoutingTableSnapshot::GetNodeInfo(const NodeId& node_id, NodeInfo& peer) const {
+  auto slot(Find(node_id));
+  if (slot == nodes_.size())
+    return false;
+  peer = nodes_[slot];
+  return true;
+}
+
+NodeInfo RoutingTableSnapshot::GetClosestNode(const NodeId& target_id, bool ignore_exact_match,
+                                              const std::vector<std::string>& exclude) const {
+  auto closest_nodes(GetClosestNodes(target_id, kClosestNodesSize_, ignore_exact_match));
+  for (const auto& node_info : closest_nodes) {
+    if (std::find(exclude.begin(), exclude.end(), node_info.id.string()) == exclude.end())
+      return node_info;
+  }
+  return NodeInfo();
+}
+
+std::vector<NodeInfo> RoutingTableSnapshot::GetClosestNodes(const NodeId& target_id,
+                                                            unsigned int number_to_get,
+                                                            bool ignore_exact_match) const {
+  if (number_to_get == 0)
+    return std::vector<NodeInfo>();
+
+  auto closest_slots(ClosestSlots(target_id, number_to_get + 1));
+  if (closest_slots.empty())
+    return std::vector<NodeInfo>();
+
+  size_t begin(ignore_exact_match && nodes_.at(closest_slots.front()).id == target_id);
+  size_t end(std::min(closest_slots.size(), static_cast<size_t>(number_to_get) + begin));
+  std::vector<NodeInfo> closest_nodes;
+  for (auto index(begin); index < end; ++index)
+    closest_nodes.push_back(nodes_.at(closest_slots.at(index)));
+  return closest_nodes;
+}
+
+NodeInfo RoutingTableSnapshot::GetNthClosestNode(const NodeId& target_id,
+                                                 unsigned int index) const {
+  if (nodes_.size() < index) {
+    NodeInfo node_info;
+    node_info.id = NodeInNthBucket(kNodeId_, static_cast<int>(index));
+    return node_info;
+  }
+  return nodes_.at(ClosestSlots(target_id, index).at(index - 1));
+}
+
+std::vector<size_t> RoutingTableSnapshot::ClosestSlots(const NodeId& target,
+                                                       unsigned int number) const {
+  if (target != kNodeId_)
+    return bucket_index_.ClosestSlots(target, number, node_ids_);
+  std::vector<size_t> slots(std::min(static_cast<size_t>(number), nodes_.size()));
+  for (size_t slot(0); slot < slots.size(); ++slot)
+    slots[slot] = slot;
+  return slots;
+}
+
+size_t RoutingTableSnapshot::LowerBound(const NodeId& node_id) const {
+  return std::lower_bound(nodes_.begin(), nodes_.end(), node_id,
+                          [this](const NodeInfo& node_info, const NodeId& id) {
+                            return NodeId::CloserToTarget(node_info.id, id, kNodeId_);
+                          }) - nodes_.begin();
+}
+
+size_t RoutingTableSnapshot::Find(const NodeId& node_id) const {
+  auto itr(slot_by_id_.find(node_id));
+  if (itr != std::end(slot_by_id_))
+    return itr->second;
+  itr = slot_by_connection_id_.find(node_id);
+  return (itr != std::end(slot_by_connection_id_)) ? itr->second : nodes_.size();
+}
+
+std::vector<NodeId> RoutingTableSnapshot::ClosestIds(size_t count) const {
+  std::vector<NodeId> ids;
+  for (size_t slot(0); slot < std::min(count, nodes_.size()); ++slot)
+    ids.push_back(nodes_[slot].id);
+  return ids;
+}
+
+size_t RoutingTableSnapshot::Insert(const NodeInfo& node) {
+  auto slot(LowerBound(node.id));
+  bucket_index_.Insert(node.bucket, slot);
+  node_ids_.Insert(slot, node.id);
+  nodes_.insert(std::begin(nodes_) + slot, node);
+  ids_by_key_fingerprint_.insert(std::make_pair(node.public_key_fingerprint, node.id));
+  Reindex(slot);
+  return slot;
+}
+
+NodeInfo RoutingTableSnapshot::Erase(size_t slot) {
+  NodeInfo erased(nodes_.at(slot));
+  bucket_index_.Remove(erased.bucket, slot);
+  node_ids_.Erase(slot);
+  nodes_.erase(std::begin(nodes_) + slot);
+  slot_by_id_.erase(erased.id);
+  auto fingerprint_range(ids_by_key_fingerprint_.equal_range(erased.public_key_fingerprint));
+  for (auto itr(fingerprint_range.first); itr != fingerprint_range.second; ++itr) {
+    if (itr->second == erased.id) {
+      ids_by_key_fingerprint_.erase(itr);
+      break;
+    }
+  }
+  if (erased.connection_id.IsValid())
+    slot_by_connection_id_.erase(erased.connection_id);
+  Reindex(slot);
+  return erased;
+}
+
+void RoutingTableSnapshot::Reindex(size_t first) {
+  for (size_t slot(first); slot < nodes_.size(); ++slot) {
+    slot_by_id_[nodes_[slot].id] = slot;
+    if (nodes_[slot].connection_id.IsValid())
+      slot_by_connection_id_[nodes_[slot].connection_id] = slot;
+  }
+}
+
+RoutingTable::RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                           const RoutingConfig& config)
     : kClientMode_(client_mode),
       kNodeId_(node_id),
       kConnectionId_(kClientMode_ ? NodeId(RandomString(NodeId::kSize)) : kNodeId_),
       kKeys_(keys),
-      kMaxSize_(kClientMode_ ? Parameters::max_routing_table_size_for_client
-                             : Parameters::max_routing_table_size),
-      kThresholdSize_(kClientMode_ ? Parameters::max_routing_table_size_for_client
-                                   : Parameters::routing_table_size_threshold),
+      kConfig_(config),
+      kMaxSize_(kClientMode_ ? kConfig_.max_routing_table_size_for_client
+                             : kConfig_.max_routing_table_size),
+      kThresholdSize_(kClientMode_ ? kConfig_.max_routing_table_size_for_client
+                                   : kConfig_.routing_table_size_threshold),
       mutex_(),
       routing_table_change_functor_(),
-      nodes_(),
-      ipc_message_queue_() {
+      snapshot_mutex_(),
+      snapshot_(std::make_shared<RoutingTableSnapshot>(kNodeId_, kConfig_.closest_nodes_size)),
+      ipc_message_queue_(),
+      coordinates_mutex_(),
+      coordinates_(),
+      peer_coordinates_(),
+      rtt_mutex_(),
+      rtt_estimators_() {
 #ifdef TESTING
   try {
     ipc_message_queue_.reset(new boost::interprocess::message_queue(
         boost::interprocess::open_only, network_viewer::kMessageQueueName.c_str()));
     if (static_cast<unsigned int>(ipc_message_queue_->get_max_msg_size()) <
-        (Parameters::closest_nodes_size + 1) * Parameters::closest_nodes_size * 2 * NodeId::kSize) {
+        (kConfig_.closest_nodes_size + 1) * kConfig_.closest_nodes_size * 2 * NodeId::kSize) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
     }
   }
@@ -83,6 +265,85 @@ bool RoutingTable::AddNode(const NodeInfo& peer) {
   return AddOrCheckNode(peer, true);
 }
 
+std::vector<bool> RoutingTable::AddNodes(const std::vector<NodeInfo>& peers) {
+  std::vector<bool> added(peers.size(), false);
+  std::vector<NodeInfo> candidates(peers);
+  // Only valid peers are fingerprinted, as encoding an invalid key throws, which would abort the
+  // whole batch.
+  std::vector<bool> valid(peers.size(), false);
+  for (size_t index(0); index < candidates.size(); ++index) {
+    auto& peer(candidates[index]);
+    if (!peer.id.IsValid() || peer.id == kNodeId_ || !asymm::ValidateKey(peer.public_key)) {
+      LOG(kError) << "Attempt to add an invalid node " << peer.id;
+      continue;
+    }
+    SetBucketIndex(peer);
+    SetPublicKeyFingerprint(peer);
+    valid[index] = true;
+  }
+
+  std::vector<NodeInfo> added_nodes;
+  std::vector<RoutingTableChange::Remove> removed_nodes;
+  unsigned int routing_table_size(0);
+  std::shared_ptr<CloseNodesChange> close_nodes_change;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto snapshot(std::make_shared<RoutingTableSnapshot>(*Snapshot()));
+    std::vector<NodeId> old_close_nodes(
+        snapshot->ClosestIds(client_mode() ? 0 : kConfig_.closest_nodes_size));
+    for (size_t index(0); index < candidates.size(); ++index) {
+      auto& peer(candidates[index]);
+      if (!valid[index] || snapshot->Contains(peer.id))
+        continue;
+      size_t evicted_slot(snapshot->size());
+      if (!MakeSpaceForNodeToBeAdded(peer, true, *snapshot, evicted_slot))
+        continue;
+      if (evicted_slot != snapshot->size()) {
+        NodeInfo evicted(snapshot->Erase(evicted_slot));
+        // A node added earlier in this batch and evicted again is neither added nor removed.
+        auto added_itr(std::find_if(std::begin(added_nodes), std::end(added_nodes),
+                                    [&evicted](const NodeInfo& node) {
+                                      return node.id == evicted.id;
+                                    }));
+        if (added_itr != std::end(added_nodes)) {
+          added_nodes.erase(added_itr);
+          for (size_t other(0); other < index; ++other) {
+            if (candidates[other].id == evicted.id)
+              added[other] = false;
+          }
+        } else {
+          removed_nodes.push_back(RoutingTableChange::Remove(evicted, false));
+        }
+      }
+      snapshot->Insert(peer);
+      added_nodes.push_back(peer);
+      added[index] = true;
+    }
+    if (added_nodes.empty())
+      return added;
+
+    if (!client_mode()) {
+      auto new_close_nodes(snapshot->ClosestIds(kConfig_.closest_nodes_size));
+      if (new_close_nodes != old_close_nodes) {
+        close_nodes_change.reset(new CloseNodesChange(kNodeId(), old_close_nodes,
+                                                      new_close_nodes, kConfig_));
+      }
+    }
+    routing_table_size = static_cast<unsigned int>(snapshot->size());
+    Publish(snapshot, lock);
+  }
+
+  for (const auto& removed : removed_nodes)
+    ForgetPeer(removed.node.id);
+
+  if (routing_table_change_functor_) {
+    routing_table_change_functor_(RoutingTableChange(added_nodes, removed_nodes,
+                                                     close_nodes_change,
+                                                     NetworkStatus(routing_table_size)));
+  }
+  return added;
+}
+
 bool RoutingTable::CheckNode(const NodeInfo& peer) { return AddOrCheckNode(peer, false); }
 
 bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove) {
@@ -100,46 +361,43 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove) {
   std::vector<NodeId> old_close_nodes, new_close_nodes;
   std::shared_ptr<CloseNodesChange> close_nodes_change;
 
-  if (remove)
+  if (remove) {
     SetBucketIndex(peer);
+    SetPublicKeyFingerprint(peer);
+  }
   {
     std::unique_lock<std::mutex> lock(mutex_);
-    auto found(Find(peer.id, lock));
-    if (found.first) {
+    auto current(Snapshot());
+    if (current->Contains(peer.id)) {
       return false;
     }
 
-    auto close_nodes_size(PartialSortFromTarget(kNodeId_, Parameters::max_routing_table_size,
-                                                lock));
-
-    if (MakeSpaceForNodeToBeAdded(peer, remove, removed_node, lock)) {
+    size_t evicted_slot(current->size());
+    if (MakeSpaceForNodeToBeAdded(peer, remove, *current, evicted_slot)) {
       if (remove) {
         assert(peer.bucket != NodeInfo::kInvalidBucket);
-        if (!client_mode() &&
-           ((nodes_.size() < Parameters::closest_nodes_size)  ||
-            NodeId::CloserToTarget(
-                peer.id, nodes_.at(Parameters::closest_nodes_size - 1).id, kNodeId()))) {
-          bool full_close_nodes(nodes_.size() >= Parameters::closest_nodes_size);
-          close_nodes_size = (full_close_nodes) ? (Parameters::closest_nodes_size - 1)
-                                                : close_nodes_size;
-          std::for_each (std::begin(nodes_), std::begin(nodes_) + close_nodes_size,
-                         [&](const NodeInfo& node_info) {
-                           old_close_nodes.push_back(node_info.id);
-                           new_close_nodes.push_back(node_info.id);
-                         });
-            new_close_nodes.push_back(peer.id);
-            if (full_close_nodes)
-              old_close_nodes.push_back(nodes_.at(Parameters::closest_nodes_size - 1).id);
+        // Readers keep using 'current' while the copy is modified and then published.
+        auto snapshot(std::make_shared<RoutingTableSnapshot>(*current));
+        if (evicted_slot != current->size())
+          removed_node = snapshot->Erase(evicted_slot);
+        if (!client_mode())
+          old_close_nodes = snapshot->ClosestIds(kConfig_.closest_nodes_size);
+        // The sorted position tells directly whether the close group changes.
+        if (snapshot->Insert(peer) < kConfig_.closest_nodes_size && !client_mode()) {
+          new_close_nodes = snapshot->ClosestIds(kConfig_.closest_nodes_size);
           close_nodes_change.reset(new CloseNodesChange(kNodeId(), old_close_nodes,
-                                                        new_close_nodes));
+                                                        new_close_nodes, kConfig_));
         }
-        nodes_.push_back(peer);
+        Publish(snapshot, lock);
       }
       return_value = true;
     }
-    routing_table_size = static_cast<unsigned int>(nodes_.size());
+    routing_table_size = static_cast<unsigned int>(Snapshot()->size());
   }
 
+  if (removed_node.id.IsValid())
+    ForgetPeer(removed_node.id);
+
   if (return_value && remove) {  // Firing functors on Add only
     if (routing_table_change_functor_) {
       routing_table_change_functor_(
@@ -157,33 +415,24 @@ NodeInfo RoutingTable::DropNode(const NodeId& node_to_drop, bool routing_only) {
   std::shared_ptr<CloseNodesChange> close_nodes_change;
   {
     std::unique_lock<std::mutex> lock(mutex_);
-    auto close_nodes_size(PartialSortFromTarget(kNodeId_, Parameters::closest_nodes_size + 1,
-                                                lock));
-    auto found(Find(node_to_drop, lock));
-    if (found.first) {
-      if (!client_mode() &&
-          ((nodes_.size() < Parameters::closest_nodes_size) ||
-           !NodeId::CloserToTarget(nodes_.at(Parameters::closest_nodes_size - 1).id,
-                                   node_to_drop, kNodeId()))) {
-        std::for_each (std::begin(nodes_),
-                       std::begin(nodes_) + std::min(close_nodes_size,
-                                                     Parameters::closest_nodes_size),
-                       [&](const NodeInfo& node_info) {
-                         old_close_nodes.push_back(node_info.id);
-                         if (node_info.id != node_to_drop)
-                           new_close_nodes.push_back(node_info.id);
-                       });
-        if (close_nodes_size == Parameters::closest_nodes_size + 1)
-          new_close_nodes.push_back(nodes_.at(Parameters::closest_nodes_size).id);
-        close_nodes_change.reset(new CloseNodesChange(kNodeId(), old_close_nodes, new_close_nodes));
+    auto current(Snapshot());
+    auto found(current->Find(node_to_drop));
+    if (found != current->size()) {
+      auto snapshot(std::make_shared<RoutingTableSnapshot>(*current));
+      dropped_node = snapshot->Erase(found);
+      if (!client_mode() && found < kConfig_.closest_nodes_size) {
+        old_close_nodes = current->ClosestIds(kConfig_.closest_nodes_size);
+        new_close_nodes = snapshot->ClosestIds(kConfig_.closest_nodes_size);
+        close_nodes_change.reset(
+            new CloseNodesChange(kNodeId(), old_close_nodes, new_close_nodes, kConfig_));
       }
-      dropped_node = *found.second;
-      nodes_.erase(found.second);
-      routing_table_size = static_cast<unsigned int>(nodes_.size());
+      routing_table_size = static_cast<unsigned int>(snapshot->size());
+      Publish(snapshot, lock);
     }
   }
 
   if (dropped_node.id.IsValid()) {
+    ForgetPeer(dropped_node.id);
     if (routing_table_change_functor_) {
       routing_table_change_functor_(
           RoutingTableChange(NodeInfo(), RoutingTableChange::Remove(dropped_node, routing_only),
@@ -193,111 +442,77 @@ NodeInfo RoutingTable::DropNode(const NodeId& node_to_drop, bool routing_only) {
   return dropped_node;
 }
 
-NodeId RoutingTable::RandomConnectedNode() {
-  std::unique_lock<std::mutex> lock(mutex_);
+std::shared_ptr<const RoutingTableSnapshot> RoutingTable::Snapshot() const {
+  std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+  return snapshot_;
+}
+
+void RoutingTable::Publish(std::shared_ptr<const RoutingTableSnapshot> snapshot,
+                           std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  {
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+    snapshot_.swap(snapshot);
+  }
+  // 'snapshot' now holds the previous snapshot, released here outside snapshot_mutex_.
+}
+
+NodeId RoutingTable::RandomConnectedNode() const {
+  auto snapshot(Snapshot());
 // Commenting out assert as peer starts treating this node as joined as soon as it adds
 // it into its routing table.
 //  assert(nodes_.size() > Parameters::closest_nodes_size &&
 //         "Shouldn't call RandomConnectedNode when routing table size is <= closest_nodes_size");
 //   assert(nodes_.empty());
-  if (nodes_.empty())
+  if (snapshot->nodes().empty())
     return NodeId();
 
-  PartialSortFromTarget(kNodeId_, static_cast<unsigned int>(nodes_.size()), lock);
-  size_t index(RandomUint32() % (nodes_.size()));
-  return nodes_.at(index).id;
+  size_t index(RandomUint32() % (snapshot->size()));
+  return snapshot->nodes().at(index).id;
 }
 
 bool RoutingTable::GetNodeInfo(const NodeId& node_id, NodeInfo& peer) const {
-  std::unique_lock<std::mutex> lock(mutex_);
-  auto found(Find(node_id, lock));
-  if (found.first)
-    peer = *found.second;
-  return found.first;
+  return Snapshot()->GetNodeInfo(node_id, peer);
 }
 
-bool RoutingTable::IsThisNodeInRange(const NodeId& target_id, const unsigned int range) {
-  // sort by target will always put the node bearing the same target_id (such as pmid_pub_key)
-  // as the closest if that node is in the routing table
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (nodes_.size() < range)
-    return true;
-
-  auto count(PartialSortFromTarget(target_id, range + 1, lock));
-  bool skip_front(target_id == nodes_[0].id);
-  if (skip_front && (count == range))
-    return true;
-  return NodeId::CloserToTarget(kNodeId_,
-                                nodes_[count - 1 - (skip_front ? 0 : 1)].id,
-                                target_id);
+bool RoutingTable::IsThisNodeInRange(const NodeId& target_id, const unsigned int range) const {
+  return Snapshot()->IsThisNodeInRange(target_id, range);
 }
 
-bool RoutingTable::IsThisNodeClosestTo(const NodeId& target_id, bool ignore_exact_match) {
-  if (target_id == kNodeId())
-    return false;
-  {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (nodes_.empty())
-      return false;
-  }
-
-  if (!target_id.IsValid()) {
-    LOG(kError) << "Invalid target_id passed.";
-    return false;
-  }
-
-  NodeInfo closest_node(GetClosestNode(target_id, ignore_exact_match));
-  return (closest_node.bucket == NodeInfo::kInvalidBucket) ||
-         NodeId::CloserToTarget(kNodeId_, closest_node.id, target_id);
+bool RoutingTable::IsThisNodeClosestTo(const NodeId& target_id, bool ignore_exact_match) const {
+  return Snapshot()->IsThisNodeClosestTo(target_id, ignore_exact_match);
 }
 
 bool RoutingTable::Contains(const NodeId& node_id) const {
-  std::unique_lock<std::mutex> lock(mutex_);
-  return Find(node_id, lock).first;
+  return Snapshot()->Contains(node_id);
 }
 
-bool RoutingTable::ConfirmGroupMembers(const NodeId& node1, const NodeId& node2) {
+bool RoutingTable::ConfirmGroupMembers(const NodeId& node1, const NodeId& node2) const {
+  auto snapshot(Snapshot());
   NodeId difference =
-      kNodeId_ ^ GetNthClosestNode(
+      kNodeId_ ^ snapshot->GetNthClosestNode(
                      kNodeId(),
-                     std::min(static_cast<unsigned>(nodes_.size()),
-                              static_cast<unsigned>(Parameters::closest_nodes_size))).id;
+                     std::min(static_cast<unsigned>(snapshot->size()),
+                              static_cast<unsigned>(kConfig_.closest_nodes_size))).id;
   return (node1 ^ node2) < difference;
 }
 
 // bucket 0 is us, 511 is furthest bucket (should fill first)
 void RoutingTable::SetBucketIndex(NodeInfo& node_info) const {
-  std::string holder_raw_id(kNodeId_.string());
-  std::string node_raw_id(node_info.id.string());
-  int16_t byte_index(0);
-  while (byte_index != NodeId::kSize) {
-    if (holder_raw_id[byte_index] != node_raw_id[byte_index]) {
-      std::bitset<8> holder_byte(static_cast<int>(holder_raw_id[byte_index]));
-      std::bitset<8> node_byte(static_cast<int>(node_raw_id[byte_index]));
-      int16_t bit_index(0);
-      while (bit_index != 8U) {
-        if (holder_byte[7U - bit_index] != node_byte[7U - bit_index])
-          break;
-        ++bit_index;
-      }
-      node_info.bucket = (8 * (NodeId::kSize - byte_index)) - bit_index - 1;
-      return;
-    }
-    ++byte_index;
-  }
-  node_info.bucket = 0;
+  node_info.bucket = BucketIndex::Bucket(kNodeId_, node_info.id);
+}
+
+void RoutingTable::SetPublicKeyFingerprint(NodeInfo& node_info) {
+  node_info.public_key_fingerprint =
+      std::hash<std::string>()(asymm::EncodeKey(node_info.public_key)->string());
 }
 
 bool RoutingTable::CheckPublicKeyIsUnique(const NodeInfo& node,
-                                          std::unique_lock<std::mutex>& lock) const {
-  assert(lock.owns_lock());
-  static_cast<void>(lock);
+                                          const RoutingTableSnapshot& snapshot) const {
   // If we already have a duplicate public key return false
-  if (std::find_if(nodes_.begin(), nodes_.end(), [node](const NodeInfo & node_info) {
-        return asymm::MatchingKeys(node_info.public_key, node.public_key);
-      }) != nodes_.end()) {
+  if (snapshot.ContainsPublicKey(node))
     return false;
-  }
 
   // If the endpoint is kNonRoutable then no need to check for endpoint duplication.
   //  if (node.endpoint == rudp::kNonRoutable)
@@ -315,163 +530,179 @@ bool RoutingTable::CheckPublicKeyIsUnique(const NodeInfo& node,
 }
 
 bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
-                                             NodeInfo& removed_node,
-                                             std::unique_lock<std::mutex>& lock) {
-  assert(lock.owns_lock());
-
-  std::map<uint32_t, unsigned int> bucket_rank_map;
-
-  if (remove && !CheckPublicKeyIsUnique(node, lock))
+                                             const RoutingTableSnapshot& snapshot,
+                                             size_t& evicted_slot) const {
+  if (remove && !CheckPublicKeyIsUnique(node, snapshot))
     return false;
 
-  if (nodes_.size() < kMaxSize_)
+  const auto& nodes(snapshot.nodes_);
+  if (nodes.size() < kMaxSize_)
     return true;
 
   if (client_mode()) {
-    assert(nodes_.size() == kMaxSize_);
-    if (NodeId::CloserToTarget(node.id, nodes_.at(kMaxSize_ - 1).id, kNodeId())) {
-      removed_node = *nodes_.rbegin();
-      nodes_.pop_back();
+    assert(nodes.size() == kMaxSize_);
+    if (NodeId::CloserToTarget(node.id, nodes.back().id, kNodeId())) {
+      evicted_slot = nodes.size() - 1;
       return true;
     } else {
       return false;
     }
   }
 
-  unsigned int max_bucket(0), max_bucket_count(1);
-  std::for_each(std::begin(nodes_) + Parameters::unidirectional_interest_range, std::end(nodes_),
-                [&bucket_rank_map, &max_bucket, &max_bucket_count](const NodeInfo& node_info) {
-                  auto bucket_iter(bucket_rank_map.find(node_info.bucket));
-                  if (bucket_iter != std::end(bucket_rank_map))
-                    (*bucket_iter).second++;
-                   else
-                    bucket_rank_map.insert(std::make_pair(node_info.bucket, 1));
-
-                   if (bucket_rank_map[node_info.bucket] >= max_bucket_count) {
-                     max_bucket = node_info.bucket;
-                     max_bucket_count = bucket_rank_map[node_info.bucket];
-                   }
-                });
+  // Since nodes are ordered by distance, each bucket is a contiguous run of slots and the bucket
+  // index's occupancy and highest slot per bucket stand in for a histogram over the nodes.
+  auto max_bucket(snapshot.bucket_index_.FullestBucketFrom(
+      kConfig_.unidirectional_interest_range));
+  size_t max_bucket_count(max_bucket.second);
+  assert(max_bucket_count != 0);
 
   // If no duplicate bucket exists, prioirity is given to closer nodes.
-  if ((max_bucket_count == 1) && (nodes_.back().bucket < node.bucket))
+  if ((max_bucket_count == 1) && (nodes.back().bucket < node.bucket))
     return false;
 
-  if (NodeId::CloserToTarget(nodes_.at(Parameters::unidirectional_interest_range).id, node.id,
+  if (NodeId::CloserToTarget(nodes.at(kConfig_.unidirectional_interest_range).id, node.id,
                              kNodeId()))
     return false;
 
-  for (auto it(nodes_.rbegin()); it != nodes_.rend(); ++it)
-    if (static_cast<unsigned int>(it->bucket) == max_bucket) {
-      if ((it->bucket != node.bucket) || NodeId::CloserToTarget(node.id, it->id, kNodeId())) {
-        if (remove) {
-          removed_node = *it;
-          nodes_.erase(--(it.base()));
-        }
-        return true;
-      }
-    }
+  // Only the furthest member of the bucket need be considered: if 'node' is not closer than it,
+  // it is not closer than any other member either.
+  auto furthest_slot(snapshot.bucket_index_.HighestSlot(max_bucket.first));
+  const auto& furthest(nodes.at(furthest_slot));
+  if ((furthest.bucket != node.bucket) || NodeId::CloserToTarget(node.id, furthest.id, kNodeId())) {
+    // A node for a sparser bucket is always taken, at the cost of the fullest bucket's furthest
+    // member, so latency never shapes the bucket layout.
+    evicted_slot = furthest_slot;
+    if (node.bucket != max_bucket.first)
+      return true;
+    // Within its own bucket, any member beyond the interest range serves routing equally well, so
+    // the one with the highest expected latency is the one given up (proximity neighbour
+    // selection), but only for a node expected to be faster.  Without both estimates, the furthest
+    // is given up.
+    size_t first_slot(std::max<size_t>(
+        furthest_slot + 1 - snapshot.bucket_index_.BucketSize(max_bucket.first),
+        kConfig_.unidirectional_interest_range));
+    std::lock_guard<std::mutex> lock(coordinates_mutex_);
+    const auto kNodeRtt(EstimateRtt(NetworkCoordinates(node.dimension_list)));
+    if (kNodeRtt.count() < 0)
+      return true;
+    std::chrono::microseconds slowest_rtt(-1);
+    auto slowest_slot(SlowestSlot(snapshot, first_slot, furthest_slot, slowest_rtt));
+    if (slowest_rtt.count() < 0)
+      return true;
+    if (kNodeRtt >= slowest_rtt)
+      return false;
+    evicted_slot = slowest_slot;
+    return true;
+  }
   return false;
 }
 
-unsigned int RoutingTable::PartialSortFromTarget(const NodeId& target, unsigned int number,
-                                                 std::unique_lock<std::mutex>& lock) {
-  assert(lock.owns_lock());
-  static_cast<void>(lock);
-  unsigned int count = std::min(number, static_cast<unsigned int>(nodes_.size()));
-  std::partial_sort(nodes_.begin(), nodes_.begin() + count, nodes_.end(),
-                    [target](const NodeInfo& lhs, const NodeInfo& rhs) {
-    return NodeId::CloserToTarget(lhs.id, rhs.id, target);
-  });
-  return count;
+size_t RoutingTable::SlowestSlot(const RoutingTableSnapshot& snapshot, size_t first_slot,
+                                 size_t last_slot, std::chrono::microseconds& slowest_rtt) const {
+  size_t slowest_slot(last_slot);
+  slowest_rtt = std::chrono::microseconds(-1);
+  for (size_t slot(first_slot); slot <= last_slot; ++slot) {
+    auto rtt(EstimateRtt(PeerCoordinates(snapshot.nodes_[slot])));
+    if (rtt.count() >= 0 && rtt >= slowest_rtt) {
+      slowest_rtt = rtt;
+      slowest_slot = slot;
+    }
+  }
+  return slowest_slot;
 }
 
-void RoutingTable::NthElementSortFromTarget(const NodeId& target, unsigned int nth_element,
-                                            std::unique_lock<std::mutex>& lock) {
-  assert(lock.owns_lock());
-  static_cast<void>(lock);
-  assert((nodes_.size() >= nth_element) &&
-         "This should only be called when n is at max the size of RT");
-#if defined(__clang__) || defined(MAIDSAFE_WIN32) || \
-    (__GNUC__ > 4 || \
-    (__GNUC__ == 4 && (__GNUC_MINOR__ > 8 || (__GNUC_MINOR__ ==  8  && __GNUC_PATCHLEVEL__ > 2))))
-  std::nth_element(std::begin(nodes_), std::begin(nodes_) + nth_element, std::end(nodes_),
-                   [target](const NodeInfo& lhs, const NodeInfo& rhs) {
-                     return NodeId::CloserToTarget(lhs.id, rhs.id, target);
-                   });
-#else
-// BEFORE_RELEASE use std::nth_element() for all platform when min required Gcc version is 4.8.3
-// http://gcc.gnu.org/bugzilla/show_bug.cgi?id=58800 Bug fixed in gcc 4.8.3
-  PartialSortFromTarget(target, nth_element + 1, lock);
-#endif
+NetworkCoordinates RoutingTable::PeerCoordinates(const NodeInfo& peer) const {
+  auto itr(peer_coordinates_.find(peer.id));
+  if (itr != std::end(peer_coordinates_))
+    return itr->second;
+  return NetworkCoordinates(peer.dimension_list);
 }
 
-NodeInfo RoutingTable::GetClosestNode(const NodeId& target_id, bool ignore_exact_match,
-                                      const std::vector<std::string>& exclude) {
-  auto closest_nodes(GetClosestNodes(target_id, Parameters::closest_nodes_size,
-                                     ignore_exact_match));
-  for (const auto& node_info : closest_nodes) {
-    if (std::find(exclude.begin(), exclude.end(), node_info.id.string()) == exclude.end())
-      return node_info;
+std::chrono::microseconds RoutingTable::EstimateRtt(const NetworkCoordinates& remote) const {
+  if (!remote.IsValid() || coordinates_.error() >= 1.0)
+    return std::chrono::microseconds(-1);
+  return coordinates_.EstimateRtt(remote);
+}
+
+void RoutingTable::ForgetPeer(const NodeId& peer_id) {
+  {
+    std::lock_guard<std::mutex> lock(coordinates_mutex_);
+    peer_coordinates_.erase(peer_id);
   }
-  return NodeInfo();
+  std::lock_guard<std::mutex> lock(rtt_mutex_);
+  rtt_estimators_.erase(peer_id);
 }
 
-std::vector<NodeInfo> RoutingTable::GetClosestNodes(
-    const NodeId& target_id, unsigned int number_to_get, bool ignore_exact_match) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (number_to_get == 0)
-    return std::vector<NodeInfo>();
+std::vector<int32_t> RoutingTable::Coordinates() const {
+  std::lock_guard<std::mutex> lock(coordinates_mutex_);
+  return coordinates_.ToDimensionList();
+}
 
-  int sorted_count(PartialSortFromTarget(target_id, number_to_get + 1, lock));
-  if (sorted_count == 0)
-    return std::vector<NodeInfo>();
+void RoutingTable::AddRttSample(const NodeId& peer_id, std::chrono::microseconds rtt) {
+  auto snapshot(Snapshot());
+  auto slot(snapshot->Find(peer_id));
+  if (slot == snapshot->size())
+    return;
+  std::lock_guard<std::mutex> lock(coordinates_mutex_);
+  NetworkCoordinates remote(PeerCoordinates(snapshot->nodes_[slot]));
+  if (!remote.IsValid())
+    return;
+  coordinates_.Update(remote, rtt);
+}
 
-  if (sorted_count == 1) {
-    if (ignore_exact_match)
-      return (nodes_.begin()->id == target_id)
-                  ? std::vector<NodeInfo>()
-                  : std::vector<NodeInfo>(std::begin(nodes_), std::end(nodes_));
-    else
-      return std::vector<NodeInfo>(std::begin(nodes_), std::end(nodes_));
-  }
+std::chrono::microseconds RoutingTable::EstimateRtt(const NodeId& peer_id) const {
+  auto snapshot(Snapshot());
+  auto slot(snapshot->Find(peer_id));
+  if (slot == snapshot->size())
+    return std::chrono::microseconds(-1);
+  std::lock_guard<std::mutex> lock(coordinates_mutex_);
+  return EstimateRtt(PeerCoordinates(snapshot->nodes_[slot]));
+}
 
-  unsigned int index(ignore_exact_match && nodes_.begin()->id == target_id);
-  return std::vector<NodeInfo>(std::begin(nodes_) + index,
-                               std::begin(nodes_) +
-                                   std::min(nodes_.size(),
-                                            static_cast<size_t>(number_to_get + index)));
+void RoutingTable::SetCoordinates(const NodeId& peer_id,
+                                  const std::vector<int32_t>& dimension_list) {
+  NetworkCoordinates coordinates(dimension_list);
+  if (!coordinates.IsValid())
+    return;
+  // Checked under the lock, so that a peer being dropped is forgotten after, not before, this.
+  std::lock_guard<std::mutex> lock(coordinates_mutex_);
+  if (Snapshot()->Contains(peer_id))
+    peer_coordinates_[peer_id] = coordinates;
 }
 
-NodeInfo RoutingTable::GetNthClosestNode(const NodeId& target_id, unsigned int index) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (nodes_.size() < index) {
-    NodeInfo node_info;
-    node_info.id = NodeInNthBucket(kNodeId(), static_cast<int>(index));
-    return node_info;
-  }
-  NthElementSortFromTarget(target_id, index - 1, lock);
-  return nodes_.at(index - 1);
+void RoutingTable::AddAckRttSample(const NodeId& peer_id, std::chrono::microseconds rtt) {
+  if (!Snapshot()->Contains(peer_id))
+    return;
+  std::lock_guard<std::mutex> lock(rtt_mutex_);
+  rtt_estimators_[peer_id].AddSample(rtt);
 }
 
-std::pair<bool, std::vector<NodeInfo>::iterator> RoutingTable::Find(
-    const NodeId& node_id, std::unique_lock<std::mutex>& lock) {
-  assert(lock.owns_lock());
-  static_cast<void>(lock);
-  auto itr(std::find_if(nodes_.begin(), nodes_.end(), [&node_id](const NodeInfo & node_info) {
-    return node_info.id == node_id;
-  }));
-  return std::make_pair(itr != nodes_.end(), itr);
+std::chrono::milliseconds RoutingTable::AckTimeout(const NodeId& peer_id) const {
+  std::chrono::milliseconds ceiling(std::chrono::seconds(kConfig_.ack_timeout));
+  std::lock_guard<std::mutex> lock(rtt_mutex_);
+  auto itr(rtt_estimators_.find(peer_id));
+  if (itr == std::end(rtt_estimators_))
+    return ceiling;
+  // The estimate is of one rudp round trip to the peer, but the peer acks only once its own send
+  // onwards has succeeded, and may then hold the ack for a batch.
+  auto timeout(itr->second.Timeout(std::chrono::milliseconds(0), ceiling) * 2 +
+               kConfig_.ack_batch_window);
+  return std::max(std::min(kConfig_.min_ack_timeout, ceiling), std::min(timeout, ceiling));
 }
 
-std::pair<bool, std::vector<NodeInfo>::const_iterator> RoutingTable::Find(
-    const NodeId& node_id, std::unique_lock<std::mutex>& lock) const {
-  assert(lock.owns_lock());
-  static_cast<void>(lock);
-  auto itr(std::find_if(nodes_.begin(), nodes_.end(), [&node_id](const NodeInfo & node_info) {
-    return node_info.id == node_id;
-  }));
-  return std::make_pair(itr != nodes_.end(), itr);
+NodeInfo RoutingTable::GetClosestNode(const NodeId& target_id, bool ignore_exact_match,
+                                      const std::vector<std::string>& exclude) const {
+  return Snapshot()->GetClosestNode(target_id, ignore_exact_match, exclude);
+}
+
+std::vector<NodeInfo> RoutingTable::GetClosestNodes(const NodeId& target_id,
+                                                    unsigned int number_to_get,
+                                                    bool ignore_exact_match) const {
+  return Snapshot()->GetClosestNodes(target_id, number_to_get, ignore_exact_match);
+}
+
+NodeInfo RoutingTable::GetNthClosestNode(const NodeId& target_id, unsigned int index) const {
+  return Snapshot()->GetNthClosestNode(target_id, index);
 }
 
 unsigned int RoutingTable::NetworkStatus(unsigned int size) const {
@@ -479,8 +710,7 @@ unsigned int RoutingTable::NetworkStatus(unsigned int size) const {
 }
 
 size_t RoutingTable::size() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return nodes_.size();
+  return Snapshot()->size();
 }
 
 // to be moved to utils
@@ -510,19 +740,12 @@ size_t RoutingTable::size() const {
 //  }
 //  }
 
-std::string RoutingTable::Print() {
-  std::vector<NodeInfo> rt;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::sort(nodes_.begin(), nodes_.end(), [&](const NodeInfo& lhs, const NodeInfo& rhs) {
-      return NodeId::CloserToTarget(lhs.id, rhs.id, kNodeId_);
-    });
-    rt = nodes_;
-  }
+std::string RoutingTable::Print() const {
+  auto snapshot(Snapshot());
   std::stringstream stream;
   stream << "\n\n[" << kNodeId_ << "] This node's own routing table and peer connections:"
-         << "\nRouting table size: " << nodes_.size();
-  for (const auto& node : rt) {
+         << "\nRouting table size: " << snapshot->size();
+  for (const auto& node : snapshot->nodes()) {
     stream << "\n\tPeer [" << node.id << "]--> " << node.connection_id << " && xored "
            << NodeId(kNodeId_ ^ node.id) << " bucket " << node.bucket;
   }
@@ -19,10 +19,13 @@
 #ifndef MAIDSAFE_ROUTING_ROUTING_TABLE_H_
 #define MAIDSAFE_ROUTING_ROUTING_TABLE_H_
 
+#include <chrono>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -36,7 +39,12 @@
 #include "maidsafe/passport/types.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/bucket_index.h"
+#include "maidsafe/routing/network_coordinates.h"
+#include "maidsafe/routing/node_id_store.h"
 #include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_config.h"
+#include "maidsafe/routing/rtt_estimator.h"
 #include "maidsafe/routing/utils.h"
 
 namespace maidsafe {
@@ -68,46 +76,153 @@ struct RoutingTableChange {
     bool routing_only_removal;
   };
   RoutingTableChange() : added_node(), removed(), insertion(false), close_nodes_change(),
-                         health(0) {}
+                         health(0), added_nodes(), removed_nodes() {}
   RoutingTableChange(const NodeInfo& added_node_in, const Remove& removed_in,
                      bool insertion_in, std::shared_ptr<CloseNodesChange> close_nodes_change_in,
                      unsigned int health_in)
       : added_node(added_node_in), removed(removed_in), insertion(insertion_in),
-        close_nodes_change(close_nodes_change_in), health(health_in) {}
+        close_nodes_change(close_nodes_change_in), health(health_in),
+        added_nodes(insertion_in ? std::vector<NodeInfo>(1, added_node_in)
+                                 : std::vector<NodeInfo>()),
+        removed_nodes(removed_in.node.id.IsValid() ? std::vector<Remove>(1, removed_in)
+                                                   : std::vector<Remove>()) {}
+  // A change applying several additions and removals at once.  added_node and removed hold the
+  // first of each.
+  RoutingTableChange(const std::vector<NodeInfo>& added_nodes_in,
+                     const std::vector<Remove>& removed_nodes_in,
+                     std::shared_ptr<CloseNodesChange> close_nodes_change_in,
+                     unsigned int health_in)
+      : added_node(added_nodes_in.empty() ? NodeInfo() : added_nodes_in.front()),
+        removed(removed_nodes_in.empty() ? Remove() : removed_nodes_in.front()),
+        insertion(!added_nodes_in.empty()), close_nodes_change(close_nodes_change_in),
+        health(health_in), added_nodes(added_nodes_in), removed_nodes(removed_nodes_in) {}
   NodeInfo added_node;
   Remove removed;
   bool insertion;
   std::shared_ptr<CloseNodesChange> close_nodes_change;
   unsigned int health;
+  std::vector<NodeInfo> added_nodes;
+  std::vector<Remove> removed_nodes;
 };
 
 using RoutingTableChangeFunctor = std::function<void(const RoutingTableChange&)>;
 
+// An immutable view of the routing table's contents.  RoutingTable publishes a new snapshot on
+// every change, so a holder of a snapshot can make several queries against one consistent view
+// of the table without taking any lock.  Nodes are held in order of distance from kNodeId, so
+// the close group is always the front of nodes().
+class RoutingTableSnapshot {
+ public:
+  RoutingTableSnapshot(const NodeId& node_id, unsigned int closest_nodes_size);
+
+  bool IsThisNodeInRange(const NodeId& target_id, unsigned int range) const;
+  bool IsThisNodeClosestTo(const NodeId& target_id, bool ignore_exact_match = false) const;
+  bool Contains(const NodeId& node_id) const;
+  // Returns true if a held node has the same public key as 'node', whose public_key_fingerprint
+  // must be set.  Keys are only compared in full when their fingerprints match.
+  bool ContainsPublicKey(const NodeInfo& node) const;
+  bool GetNodeInfo(const NodeId& node_id, NodeInfo& node_info) const;
+  // Returns default-constructed NodeId if routing table size is zero
+  NodeInfo GetClosestNode(const NodeId& target_id,
+                          bool ignore_exact_match = false,
+                          const std::vector<std::string>& exclude =
+                              std::vector<std::string>()) const;
+  std::vector<NodeInfo> GetClosestNodes(const NodeId& target_id, unsigned int number_to_get,
+                                        bool ignore_exact_match = false) const;
+  NodeInfo GetNthClosestNode(const NodeId& target_id, unsigned int index) const;
+
+  const std::vector<NodeInfo>& nodes() const { return nodes_; }
+  size_t size() const { return nodes_.size(); }
+  NodeId kNodeId() const { return kNodeId_; }
+
+  friend class RoutingTable;
+
+ private:
+  RoutingTableSnapshot& operator=(const RoutingTableSnapshot&);
+
+  // Returns up to 'number' indices into nodes_, ordered by distance to 'target'.  For targets other
+  // than kNodeId_ the bucket index narrows the candidates and node_ids_ ranks them.
+  std::vector<size_t> ClosestSlots(const NodeId& target, unsigned int number) const;
+  // Returns the index at which 'node_id' is or would be held, found by binary search.
+  size_t LowerBound(const NodeId& node_id) const;
+  // Returns the index of the node whose id, or failing that whose connection id, is 'node_id', or
+  // nodes_.size() if there is none.  Answered from the hash indices.
+  size_t Find(const NodeId& node_id) const;
+  // Returns the ids of the first 'count' nodes, i.e. those closest to kNodeId_.
+  std::vector<NodeId> ClosestIds(size_t count) const;
+  // Inserts 'node' at its sorted position and returns that position.
+  size_t Insert(const NodeInfo& node);
+  NodeInfo Erase(size_t slot);
+  // Re-records the slots of nodes_[first] onwards in the hash indices after an insert or erase.
+  void Reindex(size_t first);
+
+  const NodeId kNodeId_;
+  const unsigned int kClosestNodesSize_;
+  std::vector<NodeInfo> nodes_;
+  // The ids of nodes_, slot for slot, in a layout suited to bulk distance computation.
+  NodeIdStore node_ids_;
+  BucketIndex bucket_index_;
+  std::unordered_map<NodeId, size_t, NodeIdHash> slot_by_id_, slot_by_connection_id_;
+  std::unordered_multimap<uint64_t, NodeId> ids_by_key_fingerprint_;
+};
+
 class RoutingTable {
  public:
-  RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys);
+  RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+               const RoutingConfig& config = RoutingConfig());
   virtual ~RoutingTable();
   void InitialiseFunctors(RoutingTableChangeFunctor routing_table_change_functor);
   bool AddNode(const NodeInfo& peer);
+  // Adds each of 'peers' which AddNode would accept, publishing them together and firing a single
+  // RoutingTableChange covering every addition and eviction.  Element i of the result is true if
+  // peers[i] was added and remains in the table.  Invalid peers are skipped, not fatal to the
+  // batch.  The join path adds peers one at a time as their connections are confirmed, so this is
+  // for callers which already hold a validated set, e.g. one restored from a bootstrap cache.
+  std::vector<bool> AddNodes(const std::vector<NodeInfo>& peers);
   bool CheckNode(const NodeInfo& peer);
   NodeInfo DropNode(const NodeId& node_to_drop, bool routing_only);
 
-  bool IsThisNodeInRange(const NodeId& target_id, unsigned int range);
-  bool IsThisNodeClosestTo(const NodeId& target_id, bool ignore_exact_match = false);
+  // Returns the current contents of the table.  Never waits on writers, only on the brief copy of
+  // the current snapshot pointer; the returned snapshot is unaffected by subsequent changes.
+  std::shared_ptr<const RoutingTableSnapshot> Snapshot() const;
+
+  // Each of the following queries is answered from a single snapshot without holding a lock.
+  bool IsThisNodeInRange(const NodeId& target_id, unsigned int range) const;
+  bool IsThisNodeClosestTo(const NodeId& target_id, bool ignore_exact_match = false) const;
   bool Contains(const NodeId& node_id) const;
-  bool ConfirmGroupMembers(const NodeId& node1, const NodeId& node2);
+  bool ConfirmGroupMembers(const NodeId& node1, const NodeId& node2) const;
 
   bool GetNodeInfo(const NodeId& node_id, NodeInfo& node_info) const;
   // Returns default-constructed NodeId if routing table size is zero
   NodeInfo GetClosestNode(const NodeId& target_id,
                           bool ignore_exact_match = false,
-                          const std::vector<std::string>& exclude = std::vector<std::string>());
+                          const std::vector<std::string>& exclude =
+                              std::vector<std::string>()) const;
   std::vector<NodeInfo> GetClosestNodes(const NodeId& target_id, unsigned int number_to_get,
-                                        bool ignore_exact_match = false);
-  NodeInfo GetNthClosestNode(const NodeId& target_id, unsigned int index);
-  NodeId RandomConnectedNode();
+                                        bool ignore_exact_match = false) const;
+  NodeInfo GetNthClosestNode(const NodeId& target_id, unsigned int index) const;
+  NodeId RandomConnectedNode() const;
+
+  // This node's network coordinate, encoded as for NodeInfo::dimension_list.
+  std::vector<int32_t> Coordinates() const;
+  // Refines this node's coordinate from a round-trip time measured to 'peer_id'.  Ignored unless
+  // the peer is in the table with a known coordinate.
+  void AddRttSample(const NodeId& peer_id, std::chrono::microseconds rtt);
+  // The round-trip time to 'peer_id' predicted by the two nodes' coordinates.  Negative if the
+  // peer is not in the table, or either coordinate is unknown.
+  std::chrono::microseconds EstimateRtt(const NodeId& peer_id) const;
+  // Records the coordinate most recently advertised by 'peer_id', if it is in the table.
+  void SetCoordinates(const NodeId& peer_id, const std::vector<int32_t>& dimension_list);
+  // Adds a round trip to 'peer_id', measured by rudp, to its smoothed RTT, if it is in the table.
+  // Unlike the coordinate, this is specific to the peer and forgotten when it is dropped.
+  void AddAckRttSample(const NodeId& peer_id, std::chrono::microseconds rtt);
+  // How long to wait for an ack from 'peer_id': twice its smoothed RTT plus four deviations, as
+  // the peer acks after its own send onwards, plus ack_batch_window, within
+  // [min_ack_timeout, ack_timeout].  ack_timeout until a sample has been added.
+  std::chrono::milliseconds AckTimeout(const NodeId& peer_id) const;
 
   size_t size() const;
+  const RoutingConfig& config() const { return kConfig_; }
   unsigned int kThresholdSize() const { return kThresholdSize_; }
   unsigned int kMaxSize() const { return kMaxSize_; }
   NodeId kNodeId() const { return kNodeId_; }
@@ -129,47 +244,71 @@ class RoutingTable {
   RoutingTable& operator=(const RoutingTable&);
   bool AddOrCheckNode(NodeInfo node, bool remove);
   void SetBucketIndex(NodeInfo& node_info) const;
-  bool CheckPublicKeyIsUnique(const NodeInfo& node, std::unique_lock<std::mutex>& lock) const;
+  static void SetPublicKeyFingerprint(NodeInfo& node_info);
+  bool CheckPublicKeyIsUnique(const NodeInfo& node, const RoutingTableSnapshot& snapshot) const;
 
   /** Attempts to find or allocate memory for an incomming connect request, returning true
    * indicates approval
    * returns true if routing table is not full, otherwise, performs the following process to
    * possibly evict an existing node:
-   * - sorts the nodes according to their distance from self-node-id
-   * - a candidate for eviction must have an index > Parameters::unidirectional_interest_range
+   * - nodes are already held in order of their distance from self-node-id
+   * - a candidate for eviction must have an index > unidirectional_interest_range
    * - count the number of nodes in each bucket for nodes with
-   *    index > Parameters::unidirectional_interest_range
-   * - choose the furthest node among the nodes with maximum bucket index
-   * - in case more than one bucket have similar maximum bucket size, the furthest node in higher
-   *    bucket will be evicted
-   * - remove the selected node and return true **/
-  bool MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove, NodeInfo& removed_node,
-                                 std::unique_lock<std::mutex>& lock);
-
-  unsigned int PartialSortFromTarget(const NodeId& target, unsigned int number,
-                                     std::unique_lock<std::mutex>& lock);
-  void NthElementSortFromTarget(const NodeId& target, unsigned int nth_element,
-                                std::unique_lock<std::mutex>& lock);
-  std::pair<bool, std::vector<NodeInfo>::iterator> Find(const NodeId& node_id,
-                                                        std::unique_lock<std::mutex>& lock);
-  std::pair<bool, std::vector<NodeInfo>::const_iterator> Find(
-      const NodeId& node_id, std::unique_lock<std::mutex>& lock) const;
+   *    index > unidirectional_interest_range, using the bucket index's occupancy
+   * - if the new node belongs to a different bucket, choose the furthest node with maximum
+   *    bucket index
+   * - otherwise choose the node with the highest estimated round-trip time among the nodes with
+   *    maximum bucket index, unless the new node is expected to be no faster, in which case it is
+   *    refused; choose the furthest of them if either estimate is unavailable
+   * - in case more than one bucket have similar maximum bucket size, a node in the higher bucket
+   *    will be evicted
+   * - set evicted_slot to the selected node's index in snapshot and return true **/
+  bool MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
+                                 const RoutingTableSnapshot& snapshot, size_t& evicted_slot) const;
+  // The three functions below must be called with coordinates_mutex_ held.
+  // Returns the slot in [first_slot, last_slot] whose node has the highest estimated round-trip
+  // time, setting 'slowest_rtt' to it, or last_slot and a negative time if no member's coordinate
+  // is known.
+  size_t SlowestSlot(const RoutingTableSnapshot& snapshot, size_t first_slot, size_t last_slot,
+                     std::chrono::microseconds& slowest_rtt) const;
+  // The coordinate 'peer' most recently advertised, or else the one it joined with.
+  NetworkCoordinates PeerCoordinates(const NodeInfo& peer) const;
+  // Negative if either coordinate is unknown.
+  std::chrono::microseconds EstimateRtt(const NetworkCoordinates& remote) const;
+
+  // Drops the per-peer coordinate and RTT estimate of a node which has left the table.
+  void ForgetPeer(const NodeId& peer_id);
+  // Replaces the published snapshot.  Must be called with mutex_ held.
+  void Publish(std::shared_ptr<const RoutingTableSnapshot> snapshot,
+               std::unique_lock<std::mutex>& lock);
 
   unsigned int NetworkStatus(unsigned int size) const;
 
   void IpcSendCloseNodes();
-  std::string Print();
+  std::string Print() const;
 
   const bool kClientMode_;
   const NodeId kNodeId_;
   const NodeId kConnectionId_;
   const asymm::Keys kKeys_;
+  const RoutingConfig kConfig_;
   const unsigned int kMaxSize_;
   const unsigned int kThresholdSize_;
+  // Serialises writers only; readers just copy snapshot_.
   mutable std::mutex mutex_;
   RoutingTableChangeFunctor routing_table_change_functor_;
-  std::vector<NodeInfo> nodes_;
+  // Guards only the copy or swap of snapshot_, in place of std::atomic_load/atomic_store on the
+  // shared_ptr, which libstdc++ lacks before gcc 5.
+  mutable std::mutex snapshot_mutex_;
+  std::shared_ptr<const RoutingTableSnapshot> snapshot_;
   std::unique_ptr<boost::interprocess::message_queue> ipc_message_queue_;
+  // Guards this node's coordinate and those advertised by peers since they joined, which are kept
+  // here rather than in the snapshot so that an update does not copy and republish it.
+  mutable std::mutex coordinates_mutex_;
+  NetworkCoordinates coordinates_;
+  std::map<NodeId, NetworkCoordinates> peer_coordinates_;
+  mutable std::mutex rtt_mutex_;
+  std::map<NodeId, RttEstimator> rtt_estimators_;
 };
 
 }  // namespace routing
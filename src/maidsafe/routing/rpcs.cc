@@ -18,6 +18,9 @@
 
 #include "maidsafe/routing/rpcs.h"
 
+#include <iterator>
+#include <vector>
+
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/node_id.h"
 #include "maidsafe/routing/node_info.h"
@@ -34,7 +37,8 @@ namespace routing {
 namespace rpcs {
 
 // This is maybe not required and might be removed
-protobuf::Message Ping(const NodeId& node_id, const std::string& identity) {
+protobuf::Message Ping(const RoutingConfig& config, const NodeId& node_id,
+                       const std::string& identity) {
   assert(node_id.IsValid() && "Invalid node_id");
   assert(!identity.empty() && "Invalid identity");
   protobuf::Message message;
@@ -52,14 +56,15 @@ protobuf::Message Ping(const NodeId& node_id, const std::string& identity) {
   message.set_type(static_cast<int32_t>(MessageType::kPing));
   message.set_request(true);
   message.set_client_node(false);
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(config.hops_to_live);
   assert(message.IsInitialized() && "Uninitialised message");
   return message;
 }
 
-protobuf::Message Connect(const NodeId& node_id, const rudp::EndpointPair& our_endpoint,
-                          const NodeId& this_node_id, const NodeId& this_connection_id,
-                          bool client_node, rudp::NatType nat_type, bool relay_message,
+protobuf::Message Connect(const RoutingConfig& config, const NodeId& node_id,
+                          const rudp::EndpointPair& our_endpoint, const NodeId& this_node_id,
+                          const NodeId& this_connection_id, bool client_node,
+                          rudp::NatType nat_type, bool relay_message,
                           NodeId relay_connection_id) {
   assert(node_id.IsValid() && "Invalid node_id");
   assert(this_node_id.IsValid() && "Invalid my node_id");
@@ -88,7 +93,7 @@ protobuf::Message Connect(const NodeId& node_id, const rudp::EndpointPair& our_e
   message.set_type(static_cast<int32_t>(MessageType::kConnect));
   message.set_request(true);
   message.set_client_node(client_node);
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(config.hops_to_live);
   message.set_ack_id(RandomInt32());
 
   if (!relay_message) {
@@ -102,9 +107,9 @@ protobuf::Message Connect(const NodeId& node_id, const rudp::EndpointPair& our_e
   return message;
 }
 
-protobuf::Message FindNodes(const NodeId& node_id, const NodeId& this_node_id,
-                            int num_nodes_requested, bool relay_message,
-                            NodeId relay_connection_id) {
+protobuf::Message FindNodes(const RoutingConfig& config, const NodeId& node_id,
+                            const NodeId& this_node_id, int num_nodes_requested,
+                            bool relay_message, NodeId relay_connection_id) {
   assert(node_id.IsValid() && "Invalid node_id");
   assert(this_node_id.IsValid() && "Invalid my node_id");
   protobuf::Message message;
@@ -131,15 +136,16 @@ protobuf::Message FindNodes(const NodeId& node_id, const NodeId& this_node_id,
     message.set_relay_id(this_node_id.string());
     message.set_relay_connection_id(relay_connection_id.string());
   }
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(config.hops_to_live);
   message.set_ack_id(RandomInt32());
   assert(message.IsInitialized() && "Unintialised message");
   return message;
 }
 
-protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_id,
-                                 const NodeId& this_connection_id, bool requestor,
-                                 bool client_node) {
+protobuf::Message ConnectSuccess(const RoutingConfig& config, const NodeId& node_id,
+                                 const NodeId& this_node_id, const NodeId& this_connection_id,
+                                 bool requestor, bool client_node,
+                                 const std::vector<int32_t>& coordinates) {
   assert(node_id.IsValid() && "Invalid node_id");
   assert(this_node_id.IsValid() && "Invalid my node_id");
   assert(this_connection_id.IsValid() && "Invalid this_connection_id");
@@ -148,6 +154,8 @@ protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_
   protobuf_connect_success.set_node_id(this_node_id.string());
   protobuf_connect_success.set_connection_id(this_connection_id.string());
   protobuf_connect_success.set_requestor(requestor);
+  for (const auto& coordinate : coordinates)
+    protobuf_connect_success.add_coordinates(coordinate);
   message.set_destination_id(node_id.string());
   message.set_routing_message(true);
   message.add_data(protobuf_connect_success.SerializeAsString());
@@ -155,7 +163,7 @@ protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_
   message.set_replication(1);
   message.set_type(static_cast<int32_t>(MessageType::kConnectSuccess));
   message.set_client_node(client_node);
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(config.hops_to_live);
   message.set_source_id(this_node_id.string());
   message.set_request(requestor);
   message.set_id(RandomInt32());
@@ -164,11 +172,13 @@ protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_
   return message;
 }
 
-protobuf::Message ConnectSuccessAcknowledgement(const NodeId& node_id, const NodeId& this_node_id,
+protobuf::Message ConnectSuccessAcknowledgement(const RoutingConfig& config,
+                                                const NodeId& node_id, const NodeId& this_node_id,
                                                 const NodeId& this_connection_id,
                                                 bool requestor,
                                                 const std::vector<NodeInfo>& close_nodes,
-                                                bool client_node) {
+                                                bool client_node,
+                                                const std::vector<int32_t>& coordinates) {
   assert(node_id.IsValid() && "Invalid node_id");
   assert(this_node_id.IsValid() && "Invalid my node_id");
   assert(this_connection_id.IsValid() && "Invalid this_connection_id");
@@ -180,6 +190,8 @@ protobuf::Message ConnectSuccessAcknowledgement(const NodeId& node_id, const Nod
   for (const auto& i : close_nodes) {
     protobuf_connect_success_ack.add_close_ids(i.id.string());
   }
+  for (const auto& coordinate : coordinates)
+    protobuf_connect_success_ack.add_coordinates(coordinate);
   message.set_destination_id(node_id.string());
   message.set_routing_message(true);
   message.add_data(protobuf_connect_success_ack.SerializeAsString());
@@ -187,7 +199,7 @@ protobuf::Message ConnectSuccessAcknowledgement(const NodeId& node_id, const Nod
   message.set_replication(1);
   message.set_type(static_cast<int32_t>(MessageType::kConnectSuccessAcknowledgement));
   message.set_client_node(client_node);
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(config.hops_to_live);
   message.set_source_id(this_node_id.string());
   message.set_request(false);
   message.set_id(RandomInt32());
@@ -221,7 +233,8 @@ protobuf::Message InformClientOfNewCloseNode(const NodeId& node_id, const NodeId
 }
 
 
-protobuf::Message GetGroup(const NodeId& node_id, const NodeId& my_node_id) {
+protobuf::Message GetGroup(const RoutingConfig& config, const NodeId& node_id,
+                           const NodeId& my_node_id) {
   assert(node_id.IsValid() && "Invalid node_id");
   assert(my_node_id.IsValid() && "Invalid my node_id");
   protobuf::Message message;
@@ -236,7 +249,7 @@ protobuf::Message GetGroup(const NodeId& node_id, const NodeId& my_node_id) {
   message.set_type(static_cast<int32_t>(MessageType::kGetGroup));
   message.set_request(true);
   message.set_client_node(false);
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(config.hops_to_live);
   message.set_visited(false);
   message.set_id(RandomInt32());
   message.set_ack_id(RandomInt32());
@@ -244,7 +257,8 @@ protobuf::Message GetGroup(const NodeId& node_id, const NodeId& my_node_id) {
   return message;
 }
 
-protobuf::Message Ack(const NodeId& node_id, const NodeId& my_node_id, int32_t ack_id) {
+protobuf::Message Ack(const RoutingConfig& config, const NodeId& node_id, const NodeId& my_node_id,
+                      int32_t ack_id) {
   assert(node_id.IsValid() && "Invalid node_id");
   assert(my_node_id.IsValid() && "Invalid my node_id");
   assert((ack_id != 0) && "Invalid ack id");
@@ -257,11 +271,20 @@ protobuf::Message Ack(const NodeId& node_id, const NodeId& my_node_id, int32_t a
   message.set_request(false);
   message.set_client_node(true);
   message.set_routing_message(true);
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(config.hops_to_live);
   message.set_id(RandomInt32());
   return message;
 }
 
+protobuf::Message Ack(const RoutingConfig& config, const NodeId& node_id, const NodeId& my_node_id,
+                      const std::vector<int32_t>& ack_ids) {
+  assert(!ack_ids.empty() && "No ack ids");
+  protobuf::Message message(Ack(config, node_id, my_node_id, ack_ids.front()));
+  for (auto itr(std::next(std::begin(ack_ids))); itr != std::end(ack_ids); ++itr)
+    message.add_acked_ids(*itr);
+  return message;
+}
+
 }  // namespace rpcs
 
 }  // namespace routing
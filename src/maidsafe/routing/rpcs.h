@@ -29,6 +29,7 @@
 #include "maidsafe/rudp/managed_connections.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/routing_config.h"
 
 namespace maidsafe {
 
@@ -40,11 +41,13 @@ class Message;
 
 namespace rpcs {
 
-protobuf::Message Ping(const NodeId& node_id, const std::string& identity);
+// Messages are given config.hops_to_live, unless noted otherwise.
+protobuf::Message Ping(const RoutingConfig& config, const NodeId& node_id,
+                       const std::string& identity);
 
-protobuf::Message Connect(const NodeId& node_id, const rudp::EndpointPair& our_endpoint,
-                          const NodeId& this_node_id, const NodeId& this_connection_id,
-                          bool client_node = false,
+protobuf::Message Connect(const RoutingConfig& config, const NodeId& node_id,
+                          const rudp::EndpointPair& our_endpoint, const NodeId& this_node_id,
+                          const NodeId& this_connection_id, bool client_node = false,
                           rudp::NatType nat_type = rudp::NatType::kUnknown,
                           bool relay_message = false, NodeId relay_connection_id = NodeId());
 
@@ -52,30 +55,42 @@ protobuf::Message Remove(const NodeId& node_id, const NodeId& this_node_id,
                          const NodeId& this_connection_id,
                          const std::vector<std::string>& attempted_nodes);
 
-protobuf::Message FindNodes(const NodeId& node_id, const NodeId& this_node_id,
-                            int num_nodes_requested, bool relay_message = false,
-                            NodeId relay_connection_id = NodeId());
+protobuf::Message FindNodes(const RoutingConfig& config, const NodeId& node_id,
+                            const NodeId& this_node_id, int num_nodes_requested,
+                            bool relay_message = false, NodeId relay_connection_id = NodeId());
 
 protobuf::Message ProxyConnect(const NodeId& node_id, const NodeId& this_node_id,
                                const rudp::EndpointPair& endpoint_pair, bool relay_message = false,
                                NodeId relay_connection_id = NodeId());
 
-protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_id,
-                                 const NodeId& this_connection_id, bool requestor,
-                                 bool client_node);
+// 'coordinates' is this node's network coordinate, as returned by RoutingTable::Coordinates().
+protobuf::Message ConnectSuccess(const RoutingConfig& config, const NodeId& node_id,
+                                 const NodeId& this_node_id, const NodeId& this_connection_id,
+                                 bool requestor, bool client_node,
+                                 const std::vector<int32_t>& coordinates = std::vector<int32_t>());
 
-protobuf::Message ConnectSuccessAcknowledgement(const NodeId& node_id, const NodeId& this_node_id,
+protobuf::Message ConnectSuccessAcknowledgement(const RoutingConfig& config,
+                                                const NodeId& node_id, const NodeId& this_node_id,
                                                 const NodeId& this_connection_id,
                                                 bool requestor,
                                                 const std::vector<NodeInfo>& close_ids,
-                                                bool client_node);
+                                                bool client_node,
+                                                const std::vector<int32_t>& coordinates =
+                                                    std::vector<int32_t>());
 
+// Travels no more than two hops.
 protobuf::Message InformClientOfNewCloseNode(const NodeId& node_id, const NodeId& this_node_id,
                                              const NodeId& client_node_id);
 
-protobuf::Message GetGroup(const NodeId& node_id, const NodeId& my_node_id);
+protobuf::Message GetGroup(const RoutingConfig& config, const NodeId& node_id,
+                           const NodeId& my_node_id);
 
-protobuf::Message Ack(const NodeId& node_id, const NodeId& my_node_id, int32_t ack_id);
+protobuf::Message Ack(const RoutingConfig& config, const NodeId& node_id, const NodeId& my_node_id,
+                      int32_t ack_id);
+
+// A single message acknowledging all of 'ack_ids'.
+protobuf::Message Ack(const RoutingConfig& config, const NodeId& node_id, const NodeId& my_node_id,
+                      const std::vector<int32_t>& ack_ids);
 
 }  // namespace rpcs
 
@@ -0,0 +1,54 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/rtt_estimator.h"
+
+#include <algorithm>
+
+namespace maidsafe {
+
+namespace routing {
+
+RttEstimator::RttEstimator() : srtt_(0), rttvar_(0), has_samples_(false) {}
+
+void RttEstimator::AddSample(std::chrono::microseconds rtt) {
+  if (rtt.count() < 0)
+    return;
+  if (!has_samples_) {
+    srtt_ = rtt;
+    rttvar_ = rtt / 2;
+    has_samples_ = true;
+    return;
+  }
+  // RTTVAR is updated first, using the SRTT the sample is compared against.
+  const std::chrono::microseconds kDeviation(srtt_ > rtt ? srtt_ - rtt : rtt - srtt_);
+  rttvar_ = (rttvar_ * 3 + kDeviation) / 4;
+  srtt_ = (srtt_ * 7 + rtt) / 8;
+}
+
+std::chrono::milliseconds RttEstimator::Timeout(std::chrono::milliseconds floor,
+                                                std::chrono::milliseconds ceiling) const {
+  if (!has_samples_)
+    return ceiling;
+  auto timeout(std::chrono::duration_cast<std::chrono::milliseconds>(srtt_ + rttvar_ * 4));
+  return std::max(floor, std::min(timeout, ceiling));
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,51 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_RTT_ESTIMATOR_H_
+#define MAIDSAFE_ROUTING_RTT_ESTIMATOR_H_
+
+#include <chrono>
+
+namespace maidsafe {
+
+namespace routing {
+
+// The smoothed round-trip time to one peer and its mean deviation, maintained as TCP does
+// (RFC 6298), from which a timeout for that peer's acks is derived.
+class RttEstimator {
+ public:
+  RttEstimator();
+
+  void AddSample(std::chrono::microseconds rtt);
+  bool HasSamples() const { return has_samples_; }
+  std::chrono::microseconds srtt() const { return srtt_; }
+  std::chrono::microseconds rttvar() const { return rttvar_; }
+  // SRTT plus four times RTTVAR, within ['floor', 'ceiling'].  'ceiling' until the first sample.
+  std::chrono::milliseconds Timeout(std::chrono::milliseconds floor,
+                                    std::chrono::milliseconds ceiling) const;
+
+ private:
+  std::chrono::microseconds srtt_, rttvar_;
+  bool has_samples_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_RTT_ESTIMATOR_H_
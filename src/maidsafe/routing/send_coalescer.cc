@@ -0,0 +1,195 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/send_coalescer.h"
+
+#include <array>
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "boost/asio/error.hpp"
+#include "boost/asio/steady_timer.hpp"
+
+#include "maidsafe/common/log.h"
+
+#include "maidsafe/routing/node_id_store.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+rudp::MessageSentFunctor BatchSentFunctor(std::vector<rudp::MessageSentFunctor> functors) {
+  auto shared_functors(
+      std::make_shared<std::vector<rudp::MessageSentFunctor>>(std::move(functors)));
+  return [shared_functors](int result) {
+    for (const auto& functor : *shared_functors) {
+      if (functor)
+        functor(result);
+    }
+  };
+}
+
+}  // unnamed namespace
+
+struct SendCoalescer::State {
+  struct Batch {
+    Batch() : id(0), serialised(), functors(), timer() {}
+
+    uint64_t id;
+    std::string serialised;
+    std::vector<rudp::MessageSentFunctor> functors;
+    std::unique_ptr<boost::asio::steady_timer> timer;
+  };
+
+  explicit State(Sender sender_in)
+      : mutex(), send_mutexes(), batches(), next_batch_id(0), sender(std::move(sender_in)) {}
+
+  // Held from taking a peer's batch, or a message to be sent alone, until it has been handed to
+  // 'sender', so that a concurrent send to the same peer can't overtake it.  Peers are striped
+  // across a fixed set; recursive in case 'sender' calls back into the coalescer.
+  std::recursive_mutex& SendMutex(const NodeId& peer_id) {
+    return send_mutexes[NodeIdHash()(peer_id) % send_mutexes.size()];
+  }
+
+  std::mutex mutex;
+  std::array<std::recursive_mutex, 16> send_mutexes;
+  std::map<NodeId, Batch> batches;
+  uint64_t next_batch_id;
+  const Sender sender;
+};
+
+SendCoalescer::SendCoalescer(BoostAsioService& asio_service, Sender sender,
+                             const RoutingConfig& config)
+    : asio_service_(asio_service),
+      kWindow_(config.coalescing_window),
+      kMaxMessageSize_(config.max_coalesced_message_size),
+      kMaxBatchSize_(config.max_batch_size),
+      state_(std::make_shared<State>(std::move(sender))) {
+  assert(state_->sender);
+}
+
+SendCoalescer::~SendCoalescer() {
+  CancelAll();
+}
+
+void SendCoalescer::Send(const NodeId& peer_id, const std::string& serialised,
+                         const rudp::MessageSentFunctor& message_sent_functor) {
+  Send(peer_id, serialised, std::string(), message_sent_functor);
+}
+
+void SendCoalescer::Send(const NodeId& peer_id, const std::string& head, const std::string& tail,
+                         const rudp::MessageSentFunctor& message_sent_functor) {
+  if (kWindow_.count() == 0)
+    return SendAlone(*state_, peer_id, head, tail, message_sent_functor);
+  if (head.size() + tail.size() > kMaxMessageSize_) {
+    std::lock_guard<std::recursive_mutex> send_lock(state_->SendMutex(peer_id));
+    Flush(peer_id);
+    return SendAlone(*state_, peer_id, head, tail, message_sent_functor);
+  }
+
+  uint64_t full_batch_id(0);
+  bool full(false);
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    auto& batch(state_->batches[peer_id]);
+    if (!batch.timer) {
+      batch.id = state_->next_batch_id++;
+      batch.timer.reset(new boost::asio::steady_timer(asio_service_.service(), kWindow_));
+      std::weak_ptr<State> state(state_);
+      const uint64_t kBatchId(batch.id);
+      batch.timer->async_wait([state, peer_id, kBatchId](const boost::system::error_code& error) {
+        if (error != boost::asio::error::operation_aborted)
+          SendBatch(state, peer_id, kBatchId);
+      });
+    }
+    AppendToMessageBatch(head, tail, batch.serialised);
+    batch.functors.push_back(message_sent_functor);
+    if (batch.serialised.size() >= kMaxBatchSize_) {
+      full = true;
+      full_batch_id = batch.id;
+    }
+  }
+  if (full)
+    SendBatch(state_, peer_id, full_batch_id);
+}
+
+void SendCoalescer::Flush(const NodeId& peer_id) {
+  uint64_t batch_id(0);
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    auto itr(state_->batches.find(peer_id));
+    if (itr == std::end(state_->batches))
+      return;
+    batch_id = itr->second.id;
+  }
+  SendBatch(state_, peer_id, batch_id);
+}
+
+void SendCoalescer::SendBatch(std::weak_ptr<State> weak_state, const NodeId& peer_id,
+                              uint64_t batch_id) {
+  auto state(weak_state.lock());
+  if (!state)
+    return;
+  std::lock_guard<std::recursive_mutex> send_lock(state->SendMutex(peer_id));
+  std::string serialised;
+  std::vector<rudp::MessageSentFunctor> functors;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    auto itr(state->batches.find(peer_id));
+    if (itr == std::end(state->batches) || itr->second.id != batch_id)
+      return;
+    serialised.swap(itr->second.serialised);
+    functors.swap(itr->second.functors);
+    // Destroying the timer aborts its wait if this send was not triggered by it.
+    state->batches.erase(itr);
+  }
+  state->sender(peer_id, serialised, BatchSentFunctor(std::move(functors)));
+}
+
+void SendCoalescer::SendAlone(const State& state, const NodeId& peer_id, const std::string& head,
+                              const std::string& tail,
+                              const rudp::MessageSentFunctor& message_sent_functor) {
+  // 'sender' takes a single buffer, so the parts are joined here, and only here.
+  if (tail.empty())
+    state.sender(peer_id, head, message_sent_functor);
+  else
+    state.sender(peer_id, head + tail, message_sent_functor);
+}
+
+void SendCoalescer::CancelAll() {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->batches.clear();
+}
+
+size_t SendCoalescer::waiting() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  size_t count(0);
+  for (const auto& batch : state_->batches)
+    count += batch.second.functors.size();
+  return count;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,92 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_SEND_COALESCER_H_
+#define MAIDSAFE_ROUTING_SEND_COALESCER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/rudp/managed_connections.h"
+
+#include "maidsafe/routing/routing_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Coalesces small messages to the same peer into a single rudp send, framed as a
+// protobuf::MessageBatch, saving rudp's per-send overhead when many acks and control messages go
+// to one peer.  A message waits at most coalescing_window for others to join it, and a batch
+// reaching max_batch_size is sent at once.  Messages larger than max_coalesced_message_size are
+// sent alone, after any batch waiting for their peer.  Each message in a batch has its sent
+// functor invoked with the result of sending the batch.  A message may be given in two parts,
+// which are copied straight into its batch and only joined if it is sent alone.
+class SendCoalescer {
+ public:
+  typedef std::function<void(const NodeId& peer_id, const std::string& serialised,
+                             const rudp::MessageSentFunctor& message_sent_functor)> Sender;
+
+  // 'sender' performs the actual sends, e.g. via rudp.
+  SendCoalescer(BoostAsioService& asio_service, Sender sender,
+                const RoutingConfig& config = RoutingConfig());
+  // Drops any batches still waiting, without sending them or invoking their functors.
+  ~SendCoalescer();
+
+  void Send(const NodeId& peer_id, const std::string& serialised,
+            const rudp::MessageSentFunctor& message_sent_functor);
+  // Sends the message serialised as 'head' followed by 'tail'.
+  void Send(const NodeId& peer_id, const std::string& head, const std::string& tail,
+            const rudp::MessageSentFunctor& message_sent_functor);
+  // Sends the batch waiting for 'peer_id', if any, without waiting out the window.
+  void Flush(const NodeId& peer_id);
+  void CancelAll();
+
+  // The number of messages waiting in batches.
+  size_t waiting() const;
+
+ private:
+  struct State;
+
+  SendCoalescer(const SendCoalescer&);
+  SendCoalescer(const SendCoalescer&&);
+  SendCoalescer& operator=(const SendCoalescer&);
+
+  // Sends the batch waiting for 'peer_id' if it is still the one with 'batch_id'.
+  static void SendBatch(std::weak_ptr<State> state, const NodeId& peer_id, uint64_t batch_id);
+  static void SendAlone(const State& state, const NodeId& peer_id, const std::string& head,
+                        const std::string& tail,
+                        const rudp::MessageSentFunctor& message_sent_functor);
+
+  BoostAsioService& asio_service_;
+  const std::chrono::milliseconds kWindow_;
+  const size_t kMaxMessageSize_, kMaxBatchSize_;
+  // Shared with pending timer handlers so that a handler outliving the coalescer is harmless.
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_SEND_COALESCER_H_
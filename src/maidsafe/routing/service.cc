@@ -82,7 +82,7 @@ void Service::Ping(protobuf::Message& message) {
   message.add_data(ping_response.SerializeAsString());
   message.set_destination_id(message.source_id());
   message.set_source_id(routing_table_.kNodeId().string());
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(routing_table_.config().hops_to_live);
   assert(message.IsInitialized() && "unintialised message");
 }
 
@@ -165,7 +165,7 @@ void Service::SendConnectResponse(protobuf::Message message, const NodeInfo& pee
   message.set_client_node(routing_table_.client_mode());
   message.set_request(false);
   message.set_ack_id(RandomInt32());
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(routing_table_.config().hops_to_live);
   if (message.has_source_id())
     message.set_destination_id(message.source_id());
   else
@@ -177,7 +177,7 @@ void Service::SendConnectResponse(protobuf::Message message, const NodeInfo& pee
   if (message.client_node()) {  // Client node, check non-routing table
     NodeId furthest_close_node_id =
         routing_table_.GetNthClosestNode(routing_table_.kNodeId(),
-                                         2 * Parameters::closest_nodes_size).id;
+                                         2 * routing_table_.config().closest_nodes_size).id;
     check_node_succeeded = client_routing_table_.CheckNode(peer_node, furthest_close_node_id);
   } else {
     check_node_succeeded = routing_table_.CheckNode(peer_node);
@@ -211,9 +211,10 @@ void Service::SendConnectResponse(protobuf::Message message, const NodeInfo& pee
             !this_endpoint_pair.local.address().is_unspecified()) &&
            "Unspecified endpoint after GetAvailableEndpoint success.");
 
-    int add_result(AddToRudp(network_, routing_table_.kNodeId(), routing_table_.kConnectionId(),
-                             peer_node.id, peer_node.connection_id, peer_endpoint_pair, false,
-                             routing_table_.client_mode()));
+    int add_result(AddToRudp(network_, routing_table_.config(), routing_table_.kNodeId(),
+                             routing_table_.kConnectionId(), peer_node.id,
+                             peer_node.connection_id, peer_endpoint_pair, false,
+                             routing_table_.client_mode(), routing_table_.Coordinates()));
     if (rudp::kSuccess == add_result) {
       connect_response.set_answer(protobuf::ConnectResponseType::kAccepted);
 
@@ -267,6 +268,8 @@ void Service::FindNodes(protobuf::Message& message) {
       found_nodes.add_nodes(node.id.string());
   }
 
+  for (const auto& coordinate : routing_table_.Coordinates())
+    found_nodes.add_coordinates(coordinate);
   found_nodes.set_original_request(message.data(0));
   found_nodes.set_original_signature(message.signature());
 #ifdef TESTING
@@ -287,7 +290,7 @@ void Service::FindNodes(protobuf::Message& message) {
   message.set_ack_id(RandomInt32());
   message.set_client_node(routing_table_.client_mode());
   message.set_request(false);
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(routing_table_.config().hops_to_live);
   assert(message.IsInitialized() && "unintialised message");
 }
 
@@ -303,6 +306,8 @@ void Service::ConnectSuccess(protobuf::Message& message) {
   NodeInfo peer;
   peer.id = NodeId(connect_success.node_id());
   peer.connection_id = NodeId(connect_success.connection_id());
+  peer.dimension_list.assign(connect_success.coordinates().begin(),
+                             connect_success.coordinates().end());
 
   if (!peer.id.IsValid() || !peer.connection_id.IsValid()) {
     LOG(kWarning) << "Invalid node_id / connection_id provided";
@@ -320,7 +325,8 @@ void Service::HandleConnectSuccess(NodeInfo& peer, bool client) {
   }
   if (client) {
     if (!ValidateAndAddToRoutingTable(network_, routing_table_, client_routing_table_, peer.id,
-                                      peer.connection_id, asymm::PublicKey(), true)) {
+                                      peer.connection_id, asymm::PublicKey(), true,
+                                      peer.dimension_list)) {
       return;
     }
   } else {
@@ -329,7 +335,8 @@ void Service::HandleConnectSuccess(NodeInfo& peer, bool client) {
       return;
     }
     if (!ValidateAndAddToRoutingTable(network_, routing_table_, client_routing_table_, peer.id,
-                                      peer.connection_id, *peer_public_key, false)) {
+                                      peer.connection_id, *peer_public_key, false,
+                                      peer.dimension_list)) {
       return;
     } else {
       public_key_holder_.Remove(peer.id);
@@ -337,8 +344,8 @@ void Service::HandleConnectSuccess(NodeInfo& peer, bool client) {
   }
 
   auto count =
-       (client ? Parameters::max_routing_table_size_for_client
-               : Parameters::max_routing_table_size);
+       (client ? routing_table_.config().max_routing_table_size_for_client
+               : routing_table_.config().max_routing_table_size);
   auto close_nodes_for_peer(routing_table_.GetClosestNodes(peer.id, count));
 
   close_nodes_for_peer.erase(
@@ -348,9 +355,9 @@ void Service::HandleConnectSuccess(NodeInfo& peer, bool client) {
                      }), std::end(close_nodes_for_peer));
 
   protobuf::Message connect_success_ack(rpcs::ConnectSuccessAcknowledgement(
-      peer.id, routing_table_.kNodeId(), routing_table_.kConnectionId(),
+      routing_table_.config(), peer.id, routing_table_.kNodeId(), routing_table_.kConnectionId(),
       false,  // this node is responder
-      close_nodes_for_peer, routing_table_.client_mode()));
+      close_nodes_for_peer, routing_table_.client_mode(), routing_table_.Coordinates()));
   network_.SendToDirect(connect_success_ack, peer.id, peer.connection_id);
 }
 
@@ -358,7 +365,7 @@ void Service::GetGroup(protobuf::Message& message) {
   protobuf::GetGroup get_group;
   assert(get_group.ParseFromString(message.data(0)));
   auto close_nodes(routing_table_.GetClosestNodes(NodeId(get_group.node_id()),
-                                                  Parameters::group_size, true));
+                                                  routing_table_.config().group_size, true));
   get_group.set_node_id(routing_table_.kNodeId().string());
   for (const auto& node : close_nodes)
     get_group.add_group_nodes_id(node.id.string());
@@ -373,7 +380,7 @@ void Service::GetGroup(protobuf::Message& message) {
   message.set_client_node(routing_table_.client_mode());
   message.set_request(false);
   message.set_ack_id(RandomInt32());
-  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_hops_to_live(routing_table_.config().hops_to_live);
   assert(message.IsInitialized() && "unintialised message");
 }
 
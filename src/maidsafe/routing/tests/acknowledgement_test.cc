@@ -18,6 +18,10 @@
 
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -28,10 +32,13 @@
 #include "maidsafe/common/test.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/passport/passport.h"
+
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/acknowledgement.h"
+#include "maidsafe/routing/tests/routing_network.h"
 
 
 namespace bptime = boost::posix_time;
@@ -66,6 +73,10 @@ class AcknowledgementTest : public testing::Test {
     message_.set_source_id("source_id");
     message_.set_ack_id(acknowledgement_.GetId());
     message_.set_id(0);
+    message_.set_routing_message(false);
+    message_.set_client_node(false);
+    message_.set_request(true);
+    message_.set_hops_to_live(Parameters::hops_to_live);
   }
 
  protected:
@@ -99,6 +110,245 @@ TEST_F(AcknowledgementTest, BEH_CallRemove) {
   acknowledgement_.RemoveAll();
 }
 
+TEST_F(AcknowledgementTest, BEH_QueuedAcksBatched) {
+  RoutingConfig config;
+  config.ack_batch_window = std::chrono::milliseconds(100);
+  config.max_batched_acks = 64;
+  Acknowledgement acknowledgement(local_node_id_, asio_service_, config);
+  NodeId node_id(NodeId::IdType::kRandomId), other_node_id(NodeId::IdType::kRandomId);
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  std::map<NodeId, std::vector<std::vector<AckId>>> sent;
+  AckSender sender([&](const NodeId& target, const std::vector<AckId>& ack_ids) {
+                     std::lock_guard<std::mutex> lock(mutex);
+                     sent[target].push_back(ack_ids);
+                     cond_var.notify_one();
+                   });
+  for (AckId ack_id(1); ack_id != 4; ++ack_id)
+    acknowledgement.QueueAck(node_id, ack_id, sender);
+  acknowledgement.QueueAck(other_node_id, 4, sender);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cond_var.wait_for(lock, std::chrono::seconds(2),
+                                  [&] { return sent.size() == 2; }));
+  }
+  Sleep(std::chrono::milliseconds(200));
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(1U, sent[node_id].size());
+  EXPECT_EQ(std::vector<AckId>({ 1, 2, 3 }), sent[node_id].front());
+  ASSERT_EQ(1U, sent[other_node_id].size());
+  EXPECT_EQ(std::vector<AckId>(1, 4), sent[other_node_id].front());
+}
+
+TEST_F(AcknowledgementTest, BEH_QueuedAcksFlushedAtLimit) {
+  RoutingConfig config;
+  config.ack_batch_window = std::chrono::milliseconds(10000);
+  config.max_batched_acks = 3;
+  Acknowledgement acknowledgement(local_node_id_, asio_service_, config);
+  NodeId node_id(NodeId::IdType::kRandomId);
+  std::vector<std::vector<AckId>> sent;
+  AckSender sender([&](const NodeId&, const std::vector<AckId>& ack_ids) {
+                     sent.push_back(ack_ids);
+                   });
+  for (AckId ack_id(1); ack_id != 5; ++ack_id)
+    acknowledgement.QueueAck(node_id, ack_id, sender);
+  ASSERT_EQ(1U, sent.size());
+  EXPECT_EQ(std::vector<AckId>({ 1, 2, 3 }), sent.front());
+  EXPECT_EQ(std::vector<AckId>(1, 4), acknowledgement.TakeQueuedAcks(node_id));
+  acknowledgement.RemoveAll();
+}
+
+TEST_F(AcknowledgementTest, BEH_QueuedAcksUnbatched) {
+  RoutingConfig config;
+  // Batching is off by default, as peers predating acked_ids would drop batched acks.
+  EXPECT_EQ(0, config.ack_batch_window.count());
+  config.ack_batch_window = std::chrono::milliseconds(0);
+  Acknowledgement acknowledgement(local_node_id_, asio_service_, config);
+  NodeId node_id(NodeId::IdType::kRandomId);
+  std::vector<std::vector<AckId>> sent;
+  AckSender sender([&](const NodeId&, const std::vector<AckId>& ack_ids) {
+                     sent.push_back(ack_ids);
+                   });
+  acknowledgement.QueueAck(node_id, 1, sender);
+  acknowledgement.QueueAck(node_id, 2, sender);
+  ASSERT_EQ(2U, sent.size());
+  EXPECT_EQ(std::vector<AckId>(1, 1), sent.front());
+  EXPECT_EQ(std::vector<AckId>(1, 2), sent.back());
+  EXPECT_TRUE(acknowledgement.TakeQueuedAcks(node_id).empty());
+}
+
+TEST_F(AcknowledgementTest, BEH_TakeQueuedAcks) {
+  RoutingConfig config;
+  config.ack_batch_window = std::chrono::milliseconds(100);
+  Acknowledgement acknowledgement(local_node_id_, asio_service_, config);
+  NodeId node_id(NodeId::IdType::kRandomId);
+  std::atomic<int> sends(0);
+  AckSender sender([&](const NodeId&, const std::vector<AckId>&) { ++sends; });
+  acknowledgement.QueueAck(node_id, 7, sender);
+  acknowledgement.QueueAck(node_id, 8, sender);
+  EXPECT_TRUE(acknowledgement.TakeQueuedAcks(NodeId(NodeId::IdType::kRandomId)).empty());
+  EXPECT_EQ(std::vector<AckId>({ 7, 8 }), acknowledgement.TakeQueuedAcks(node_id));
+  EXPECT_TRUE(acknowledgement.TakeQueuedAcks(node_id).empty());
+  Sleep(std::chrono::milliseconds(300));
+  EXPECT_EQ(0, sends.load());
+}
+
+TEST_F(AcknowledgementTest, BEH_HandleBatchedAcks) {
+  std::atomic<int> timeouts(0);
+  Handler handler([&](const boost::system::error_code& error) {
+                    if (error.value() == boost::system::errc::success)
+                      ++timeouts;
+                  });
+  std::vector<AckId> ack_ids;
+  for (int index(0); index != 3; ++index) {
+    protobuf::Message message(message_);
+    message.set_ack_id(acknowledgement_.GetId());
+    ack_ids.push_back(message.ack_id());
+    acknowledgement_.Add(message, handler, 1);
+  }
+  acknowledgement_.HandleMessage(ack_ids);
+  Sleep(std::chrono::milliseconds(1500));
+  EXPECT_EQ(0, timeouts.load());
+}
+
+TEST_F(AcknowledgementTest, BEH_EndToEndAck) {
+  RoutingConfig config;
+  config.end_to_end_acks = true;
+  Acknowledgement source(local_node_id_, asio_service_, config);
+  protobuf::Message message(message_);
+  message.set_source_id(local_node_id_.string());
+  source.SetAckId(message);
+  EXPECT_TRUE(message.end_to_end_ack());
+  EXPECT_TRUE(source.NeedsAck(message, NodeId(NodeId::IdType::kRandomId)));
+
+  // A hop in between neither waits on an ack nor adds itself as the node to ack.
+  Acknowledgement hop(NodeId(NodeId::IdType::kRandomId), asio_service_);
+  EXPECT_FALSE(hop.NeedsAck(message, NodeId(NodeId::IdType::kRandomId)));
+  hop.AdjustAckHistory(message);
+  EXPECT_EQ(0, message.ack_node_ids_size());
+
+  hop.SetAckId(message);
+  EXPECT_FALSE(message.has_end_to_end_ack());
+  hop.AdjustAckHistory(message);
+  EXPECT_EQ(1, message.ack_node_ids_size());
+
+  // Typed sends take the sender's ack mode too.
+  GenericNode node(passport::CreatePmidAndSigner().first, config);
+  SingleToSingleMessage typed_message;
+  typed_message.receiver = SingleId(NodeId(NodeId::IdType::kRandomId));
+  typed_message.sender = SingleSource(SingleId(node.node_id()));
+  typed_message.contents = "typed data";
+  auto sent(node.CreateNodeLevelMessage(typed_message));
+  EXPECT_NE(0, sent.ack_id());
+  EXPECT_TRUE(sent.end_to_end_ack());
+}
+
+TEST_F(AcknowledgementTest, BEH_Hedge) {
+  std::atomic<int> hedges(0);
+  Handler handler([](const boost::system::error_code&) {});
+  EXPECT_FALSE(acknowledgement_.Hedge(acknowledgement_.GetId(), bptime::milliseconds(10),
+                                      [&] { ++hedges; }));
+
+  protobuf::Message unacked(message_);
+  unacked.set_ack_id(acknowledgement_.GetId());
+  acknowledgement_.Add(unacked, handler, Parameters::ack_timeout);
+  EXPECT_TRUE(acknowledgement_.Hedge(unacked.ack_id(), bptime::milliseconds(50),
+                                     [&] { ++hedges; }));
+
+  // An ack arriving before the deadline cancels the hedge.
+  protobuf::Message acked(message_);
+  acked.set_ack_id(acknowledgement_.GetId());
+  acknowledgement_.Add(acked, handler, Parameters::ack_timeout);
+  EXPECT_TRUE(acknowledgement_.Hedge(acked.ack_id(), bptime::milliseconds(50),
+                                     [&] { hedges += 10; }));
+  acknowledgement_.HandleMessage(acked.ack_id());
+
+  Sleep(std::chrono::milliseconds(300));
+  EXPECT_EQ(1, hedges.load());
+  acknowledgement_.RemoveAll();
+}
+
+TEST_F(AcknowledgementTest, BEH_AckDoneFunctor) {
+  std::vector<AckId> done;
+  acknowledgement_.SetAckDoneFunctor([&done](AckId ack_id) { done.push_back(ack_id); });
+  Handler handler([](const boost::system::error_code&) {});
+  std::vector<AckId> ack_ids;
+  for (int index(0); index != 3; ++index) {
+    protobuf::Message message(message_);
+    message.set_ack_id(acknowledgement_.GetId());
+    ack_ids.push_back(message.ack_id());
+    acknowledgement_.Add(message, handler, Parameters::ack_timeout);
+    EXPECT_TRUE(acknowledgement_.IsAwaited(message.ack_id()));
+  }
+  acknowledgement_.HandleMessage(ack_ids.front());
+  acknowledgement_.HandleMessage(std::vector<AckId>(ack_ids.begin() + 1, ack_ids.end()));
+  acknowledgement_.HandleMessage(ack_ids.front());
+  EXPECT_EQ(ack_ids, done);
+  EXPECT_FALSE(acknowledgement_.IsAwaited(ack_ids.back()));
+  acknowledgement_.SetAckDoneFunctor(nullptr);
+}
+
+TEST_F(AcknowledgementTest, BEH_IsSentOnce) {
+  Handler handler([](const boost::system::error_code&) {});
+  const std::chrono::milliseconds kTimeout(std::chrono::seconds(Parameters::ack_timeout));
+  EXPECT_TRUE(acknowledgement_.IsSentOnce(acknowledgement_.GetId()));
+
+  protobuf::Message sent_once(message_);
+  sent_once.set_ack_id(acknowledgement_.GetId());
+  acknowledgement_.Add(OutboundMessage(sent_once), handler, kTimeout);
+  EXPECT_TRUE(acknowledgement_.IsSentOnce(sent_once.ack_id()));
+
+  protobuf::Message resent(message_);
+  resent.set_ack_id(acknowledgement_.GetId());
+  acknowledgement_.Add(OutboundMessage(resent), handler, kTimeout);
+  acknowledgement_.Add(OutboundMessage(resent), handler, kTimeout);
+  EXPECT_FALSE(acknowledgement_.IsSentOnce(resent.ack_id()));
+
+  // Only once the hedge has been sent is the timing of the first send ambiguous.
+  protobuf::Message hedged(message_);
+  hedged.set_ack_id(acknowledgement_.GetId());
+  acknowledgement_.Add(OutboundMessage(hedged), handler, kTimeout);
+  std::atomic<bool> hedge_sent(false);
+  ASSERT_TRUE(acknowledgement_.Hedge(hedged.ack_id(), bptime::milliseconds(20),
+                                     [&] { hedge_sent = true; }));
+  EXPECT_TRUE(acknowledgement_.IsSentOnce(hedged.ack_id()));
+  Sleep(std::chrono::milliseconds(200));
+  EXPECT_TRUE(hedge_sent);
+  EXPECT_FALSE(acknowledgement_.IsSentOnce(hedged.ack_id()));
+
+  acknowledgement_.HandleMessage(
+      std::vector<AckId>{ sent_once.ack_id(), resent.ack_id(), hedged.ack_id() });
+}
+
+TEST_F(AcknowledgementTest, FUNC_AckThroughputByInFlight) {
+  // Measures the cost of handling an ack as the number of messages awaiting theirs grows, which
+  // should stay roughly flat.
+  Handler handler([](const boost::system::error_code&) {});
+  const std::chrono::milliseconds kTimeout(std::chrono::seconds(Parameters::ack_timeout));
+  message_.add_data(RandomString(1024));
+  const OutboundMessage kOutbound(message_);
+  for (size_t in_flight : std::vector<size_t>{ 100, 1000, 10000, 50000 }) {
+    std::vector<AckId> ack_ids;
+    for (size_t index(0); index != in_flight; ++index) {
+      ack_ids.push_back(acknowledgement_.GetId());
+      acknowledgement_.Add(kOutbound.WithHopFields([&](protobuf::Message& hop_fields) {
+                             hop_fields.set_ack_id(ack_ids.back());
+                           }), handler, kTimeout);
+    }
+    std::random_shuffle(std::begin(ack_ids), std::end(ack_ids));
+    const auto kStart(std::chrono::steady_clock::now());
+    for (const auto& ack_id : ack_ids)
+      acknowledgement_.HandleMessage(ack_id);
+    const auto kElapsed(std::chrono::steady_clock::now() - kStart);
+    std::cout << in_flight << " in flight - per ack handled: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(kElapsed).count() /
+                     static_cast<int64_t>(in_flight)
+              << "ns\n";
+    for (const auto& ack_id : ack_ids)
+      EXPECT_FALSE(acknowledgement_.IsAwaited(ack_id));
+  }
+}
+
 }  // namespace test
 
 }  // namespace routing
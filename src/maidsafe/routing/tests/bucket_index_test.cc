@@ -0,0 +1,192 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/bucket_index.h"
+#include "maidsafe/routing/node_id_store.h"
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/tests/test_utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// Returns an id sharing all bits above 'bucket' with 'holder', differing at 'bucket' and random
+// below it.
+NodeId IdInBucket(const NodeId& holder, int32_t bucket) {
+  std::string raw_id(holder.string());
+  std::string random(RandomString(NodeId::kSize));
+  size_t byte_index(NodeId::kSize - 1 - bucket / 8);
+  unsigned char mask(static_cast<unsigned char>(1U << (bucket % 8)));
+  unsigned char lower_bits(static_cast<unsigned char>(mask - 1));
+  raw_id[byte_index] = static_cast<char>(
+      ((static_cast<unsigned char>(raw_id[byte_index]) ^ mask) & ~lower_bits) |
+      (static_cast<unsigned char>(random[byte_index]) & lower_bits));
+  for (size_t index(byte_index + 1); index < NodeId::kSize; ++index)
+    raw_id[index] = random[index];
+  return NodeId(raw_id);
+}
+
+std::vector<NodeInfo> InsertNodes(const NodeId& holder, size_t count, BucketIndex& bucket_index) {
+  std::vector<NodeInfo> nodes;
+  while (nodes.size() < count) {
+    NodeInfo node;
+    // Bias towards the closer buckets so several buckets hold more than one node.
+    node.id = (RandomUint32() % 2 == 0) ? NodeId(RandomString(NodeId::kSize))
+                                         : IdInBucket(holder, 511 - RandomUint32() % 16);
+    node.bucket = BucketIndex::Bucket(holder, node.id);
+    size_t slot(RandomUint32() % (nodes.size() + 1));
+    bucket_index.Insert(node.bucket, slot);
+    nodes.insert(std::begin(nodes) + slot, node);
+  }
+  return nodes;
+}
+
+NodeIdStore ToStore(const std::vector<NodeInfo>& nodes) {
+  NodeIdStore node_ids;
+  for (const auto& node : nodes)
+    node_ids.PushBack(node.id);
+  return node_ids;
+}
+
+void ExpectClosest(const NodeId& target, size_t count, const std::vector<NodeInfo>& nodes,
+                   const BucketIndex& bucket_index) {
+  auto expected(nodes);
+  SortFromTarget(target, expected);
+  expected.resize(std::min(count, expected.size()));
+  auto slots(bucket_index.ClosestSlots(target, count, ToStore(nodes)));
+  ASSERT_EQ(expected.size(), slots.size());
+  for (size_t index(0); index < slots.size(); ++index)
+    EXPECT_EQ(expected.at(index).id, nodes.at(slots.at(index)).id);
+}
+
+}  // unnamed namespace
+
+TEST(BucketIndexTest, BEH_Bucket) {
+  NodeId holder(RandomString(NodeId::kSize));
+  EXPECT_EQ(0, BucketIndex::Bucket(holder, holder));
+  for (int32_t bucket(0); bucket < 8 * NodeId::kSize; ++bucket)
+    EXPECT_EQ(bucket, BucketIndex::Bucket(holder, IdInBucket(holder, bucket)));
+}
+
+TEST(BucketIndexTest, BEH_InsertRemove) {
+  NodeId holder(RandomString(NodeId::kSize));
+  BucketIndex bucket_index(holder);
+  auto nodes(InsertNodes(holder, 100, bucket_index));
+  EXPECT_EQ(nodes.size(), bucket_index.size());
+
+  while (!nodes.empty()) {
+    size_t slot(RandomUint32() % nodes.size());
+    int32_t bucket(nodes.at(slot).bucket);
+    size_t bucket_size(bucket_index.BucketSize(bucket));
+    bucket_index.Remove(bucket, slot);
+    nodes.erase(std::begin(nodes) + slot);
+    EXPECT_EQ(bucket_size - 1, bucket_index.BucketSize(bucket));
+    EXPECT_EQ(nodes.size(), bucket_index.size());
+    if (!nodes.empty())
+      ExpectClosest(nodes.front().id, Parameters::closest_nodes_size, nodes, bucket_index);
+  }
+  bucket_index.Clear();
+  EXPECT_EQ(0U, bucket_index.size());
+}
+
+TEST(BucketIndexTest, BEH_ClosestSlots) {
+  NodeId holder(RandomString(NodeId::kSize));
+  BucketIndex bucket_index(holder);
+  EXPECT_TRUE(bucket_index.ClosestSlots(holder, 4, NodeIdStore()).empty());
+
+  auto nodes(InsertNodes(holder, 200, bucket_index));
+  ExpectClosest(holder, nodes.size(), nodes, bucket_index);
+  EXPECT_EQ(nodes.size(), bucket_index.SortedSlots(holder, ToStore(nodes)).size());
+  EXPECT_TRUE(bucket_index.ClosestSlots(holder, 0, ToStore(nodes)).empty());
+  for (int i(0); i != 100; ++i) {
+    size_t count(RandomUint32() % (nodes.size() + 10));
+    ExpectClosest(NodeId(RandomString(NodeId::kSize)), count, nodes, bucket_index);
+    ExpectClosest(IdInBucket(holder, RandomUint32() % (8 * NodeId::kSize)), count, nodes,
+                  bucket_index);
+    ExpectClosest(nodes.at(RandomUint32() % nodes.size()).id, count, nodes, bucket_index);
+  }
+}
+
+TEST(BucketIndexTest, BEH_Occupancy) {
+  NodeId holder(RandomString(NodeId::kSize));
+  BucketIndex bucket_index(holder);
+  EXPECT_EQ(0U, bucket_index.FullestBucketFrom(0).second);
+
+  // Insert in order of distance from the holder, as RoutingTableSnapshot does.
+  std::vector<NodeInfo> nodes;
+  auto check([&] {
+    for (const auto& node : nodes) {
+      size_t highest_slot(0);
+      for (size_t slot(0); slot < nodes.size(); ++slot) {
+        if (nodes.at(slot).bucket == node.bucket)
+          highest_slot = slot;
+      }
+      EXPECT_EQ(highest_slot, bucket_index.HighestSlot(node.bucket));
+    }
+    for (size_t first_slot(0); first_slot <= nodes.size(); ++first_slot) {
+      std::pair<int32_t, size_t> expected(0, 0);
+      for (size_t slot(first_slot); slot < nodes.size(); ++slot) {
+        size_t count(static_cast<size_t>(std::count_if(
+            std::begin(nodes) + first_slot, std::end(nodes),
+            [&](const NodeInfo& node) { return node.bucket == nodes.at(slot).bucket; })));
+        if (count >= expected.second)
+          expected = std::make_pair(nodes.at(slot).bucket, count);
+      }
+      EXPECT_EQ(expected, bucket_index.FullestBucketFrom(first_slot));
+    }
+  });
+  for (int i(0); i != 60; ++i) {
+    NodeInfo node;
+    node.id = (i % 2 == 0) ? NodeId(RandomString(NodeId::kSize))
+                           : IdInBucket(holder, 511 - RandomUint32() % 8);
+    node.bucket = BucketIndex::Bucket(holder, node.id);
+    size_t slot(std::lower_bound(std::begin(nodes), std::end(nodes), node,
+                                 [&holder](const NodeInfo& lhs, const NodeInfo& rhs) {
+                                   return NodeId::CloserToTarget(lhs.id, rhs.id, holder);
+                                 }) - std::begin(nodes));
+    bucket_index.Insert(node.bucket, slot);
+    nodes.insert(std::begin(nodes) + slot, node);
+  }
+  check();
+  while (nodes.size() > 10) {
+    size_t slot(RandomUint32() % nodes.size());
+    bucket_index.Remove(nodes.at(slot).bucket, slot);
+    nodes.erase(std::begin(nodes) + slot);
+  }
+  check();
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
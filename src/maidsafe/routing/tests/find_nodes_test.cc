@@ -49,7 +49,8 @@ class FindNodeNetwork : public GenericNetwork, public testing::Test {
  protected:
   testing::AssertionResult Find(std::shared_ptr<GenericNode> source, const NodeId& node_id) {
     protobuf::Message find_node_rpc(
-        rpcs::FindNodes(node_id, source->node_id(), Parameters::closest_nodes_size));
+        rpcs::FindNodes(RoutingConfig(), node_id, source->node_id(),
+                        Parameters::closest_nodes_size));
     source->SendToClosestNode(find_node_rpc);
     return testing::AssertionSuccess();
   }
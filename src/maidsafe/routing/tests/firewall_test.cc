@@ -0,0 +1,151 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/firewall.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/routing_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(FirewallTest, BEH_AddRemove) {
+  Firewall firewall;
+  EXPECT_FALSE(firewall.Add(NodeId(), 1));
+
+  const int kMessageCount(1000);
+  std::vector<NodeId> sources;
+  for (int index(0); index != 10; ++index)
+    sources.push_back(NodeId(NodeId::IdType::kRandomId));
+  for (const auto& source : sources) {
+    for (int32_t message_id(0); message_id != kMessageCount; ++message_id)
+      EXPECT_TRUE(firewall.Add(source, message_id));
+  }
+  EXPECT_EQ(sources.size() * kMessageCount, firewall.size());
+
+  for (const auto& source : sources) {
+    for (int32_t message_id(0); message_id != kMessageCount; ++message_id)
+      EXPECT_FALSE(firewall.Add(source, message_id));
+  }
+  EXPECT_TRUE(firewall.Add(sources.front(), kMessageCount));
+  EXPECT_EQ(sources.size() * kMessageCount + 1, firewall.size());
+}
+
+TEST(FirewallTest, BEH_Expiry) {
+  RoutingConfig config;
+  config.firewall_message_life = std::chrono::seconds(30);
+  Firewall firewall(config);
+  const NodeId kSource(NodeId::IdType::kRandomId);
+  const auto kStart(common::Clock::now());
+  EXPECT_TRUE(firewall.Add(kSource, 1, kStart));
+
+  // Generations span a third of the life, so the pair is held for 30s and dropped at 40s.
+  for (int seconds(1); seconds != 40; ++seconds)
+    EXPECT_FALSE(firewall.Add(kSource, 1, kStart + std::chrono::seconds(seconds)));
+  EXPECT_TRUE(firewall.Add(kSource, 1, kStart + std::chrono::seconds(40)));
+
+  // After a long idle spell every generation has expired.
+  EXPECT_TRUE(firewall.Add(kSource, 2, kStart + std::chrono::seconds(41)));
+  EXPECT_TRUE(firewall.Add(kSource, 1, kStart + std::chrono::seconds(300)));
+  EXPECT_TRUE(firewall.Add(kSource, 2, kStart + std::chrono::seconds(300)));
+}
+
+TEST(FirewallTest, BEH_BoundedMemory) {
+  RoutingConfig config;
+  config.firewall_max_history = 4096;
+  Firewall firewall(config);
+  const NodeId kSource(NodeId::IdType::kRandomId);
+  const auto kNow(common::Clock::now());
+  // A flood within one span retires generations early rather than growing without limit.
+  for (int32_t message_id(0); message_id != 100000; ++message_id)
+    EXPECT_TRUE(firewall.Add(kSource, message_id, kNow));
+  EXPECT_LE(firewall.size(), 4096U);
+  EXPECT_LE(firewall.capacity(), 2 * 4096U);
+  // The most recent pairs are still held.
+  EXPECT_FALSE(firewall.Add(kSource, 99999, kNow));
+
+  // A generation which held a burst gives its memory back once it has been cleared after holding
+  // little.
+  Firewall::Generation generation;
+  std::vector<NodeId> sources;
+  for (int index(0); index != 10000; ++index) {
+    sources.push_back(NodeId(NodeId::IdType::kRandomId));
+    generation.Insert(sources.back().string(), index, index * 0x9E3779B97F4A7C15ULL);
+  }
+  const size_t kBurstCapacity(generation.capacity());
+  EXPECT_GE(kBurstCapacity, 20000U);
+  EXPECT_TRUE(generation.Contains(sources[5].string(), 5, 5 * 0x9E3779B97F4A7C15ULL));
+  generation.Clear();
+  EXPECT_EQ(kBurstCapacity, generation.capacity());
+  EXPECT_FALSE(generation.Contains(sources[5].string(), 5, 5 * 0x9E3779B97F4A7C15ULL));
+  for (int index(0); index != 10; ++index)
+    generation.Insert(sources[index].string(), index, index * 0x9E3779B97F4A7C15ULL);
+  generation.Clear();
+  EXPECT_EQ(32U, generation.capacity());
+}
+
+TEST(FirewallTest, FUNC_AddThroughput) {
+  // Adds distinct pairs from a single thread, for a small and a large history, and from several
+  // threads at once, as the receive path does.
+  std::vector<NodeId> sources;
+  for (int index(0); index != 64; ++index)
+    sources.push_back(NodeId(NodeId::IdType::kRandomId));
+
+  for (auto run : {std::make_pair(1, 200000), std::make_pair(1, 800000),
+                   std::make_pair(4, 200000)}) {
+    const int kThreadCount(run.first), kAddsPerThread(run.second);
+    RoutingConfig config;
+    config.firewall_max_history = kThreadCount * kAddsPerThread;
+    Firewall firewall(config);
+    auto start(std::chrono::steady_clock::now());
+    std::vector<std::thread> threads;
+    for (int thread_index(0); thread_index != kThreadCount; ++thread_index) {
+      threads.push_back(std::thread([&, thread_index] {
+        for (int index(0); index != kAddsPerThread; ++index) {
+          EXPECT_TRUE(firewall.Add(sources[index % sources.size()],
+                                   thread_index * kAddsPerThread + index));
+        }
+      }));
+    }
+    for (auto& thread : threads)
+      thread.join();
+    const auto kCost(std::chrono::steady_clock::now() - start);
+    std::cout << kThreadCount << " thread(s), " << kThreadCount * kAddsPerThread
+              << " pairs - per add: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(kCost).count() /
+                     (kThreadCount * kAddsPerThread)
+              << "ns;  hardware threads: " << std::thread::hardware_concurrency() << "\n";
+  }
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,110 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/flow_control.h"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/routing_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(FlowControlTest, BEH_TotalLimit) {
+  RoutingConfig config;
+  config.max_messages_in_flight = 3;
+  config.max_messages_in_flight_per_hop = 0;
+  FlowControl flow_control(config);
+  NodeId hop(NodeId::IdType::kRandomId);
+  for (int32_t ack_id(1); ack_id != 4; ++ack_id)
+    EXPECT_TRUE(flow_control.Acquire(ack_id, NodeId(NodeId::IdType::kRandomId)));
+  EXPECT_FALSE(flow_control.Acquire(4, hop));
+  EXPECT_EQ(3U, flow_control.in_flight());
+  EXPECT_EQ(0U, flow_control.in_flight(hop));
+
+  flow_control.Release(2);
+  EXPECT_TRUE(flow_control.Acquire(4, hop));
+  EXPECT_EQ(1U, flow_control.in_flight(hop));
+}
+
+TEST(FlowControlTest, BEH_PerHopLimit) {
+  RoutingConfig config;
+  config.max_messages_in_flight = 0;
+  config.max_messages_in_flight_per_hop = 2;
+  FlowControl flow_control(config);
+  NodeId busy_hop(NodeId::IdType::kRandomId), other_hop(NodeId::IdType::kRandomId);
+  EXPECT_TRUE(flow_control.Acquire(1, busy_hop));
+  EXPECT_TRUE(flow_control.Acquire(2, busy_hop));
+  EXPECT_FALSE(flow_control.Acquire(3, busy_hop));
+  EXPECT_TRUE(flow_control.Acquire(3, other_hop));
+  EXPECT_EQ(2U, flow_control.in_flight(busy_hop));
+  EXPECT_EQ(3U, flow_control.in_flight());
+
+  // Acquiring a credit already held, or releasing one not held, changes nothing.
+  EXPECT_TRUE(flow_control.Acquire(1, busy_hop));
+  flow_control.Release(7);
+  EXPECT_EQ(3U, flow_control.in_flight());
+
+  flow_control.Release(1);
+  flow_control.Release(1);
+  EXPECT_EQ(1U, flow_control.in_flight(busy_hop));
+  EXPECT_TRUE(flow_control.Acquire(4, busy_hop));
+}
+
+TEST(FlowControlTest, BEH_ReadyAfterRefusal) {
+  RoutingConfig config;
+  config.max_messages_in_flight = 1;
+  FlowControl flow_control(config);
+  int ready_count(0);
+  flow_control.SetReadyFunctor([&ready_count] { ++ready_count; });
+  NodeId hop(NodeId::IdType::kRandomId);
+
+  EXPECT_TRUE(flow_control.Acquire(1, hop));
+  flow_control.Release(1);
+  EXPECT_EQ(0, ready_count);
+
+  EXPECT_TRUE(flow_control.Acquire(2, hop));
+  EXPECT_FALSE(flow_control.Acquire(3, hop));
+  EXPECT_FALSE(flow_control.Acquire(3, hop));
+  flow_control.Release(2);
+  EXPECT_EQ(1, ready_count);
+  EXPECT_TRUE(flow_control.Acquire(3, hop));
+  flow_control.Release(3);
+  EXPECT_EQ(1, ready_count);
+}
+
+TEST(FlowControlTest, BEH_Unlimited) {
+  RoutingConfig config;
+  config.max_messages_in_flight = 0;
+  config.max_messages_in_flight_per_hop = 0;
+  FlowControl flow_control(config);
+  NodeId hop(NodeId::IdType::kRandomId);
+  for (int32_t ack_id(1); ack_id != 10001; ++ack_id)
+    ASSERT_TRUE(flow_control.Acquire(ack_id, hop));
+  EXPECT_EQ(10000U, flow_control.in_flight(hop));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
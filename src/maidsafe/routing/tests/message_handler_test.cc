@@ -17,6 +17,8 @@
     use of the MaidSafe Software.                                                                 */
 
 #include <chrono>
+#include <future>
+#include <memory>
 
 #include "maidsafe/common/asio_service.h"
 #include "maidsafe/common/utils.h"
@@ -36,6 +38,7 @@
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/timing_wheel.h"
 
 namespace maidsafe {
 
@@ -47,7 +50,8 @@ class MessageHandlerTest : public testing::Test {
  public:
   MessageHandlerTest()
       : asio_service_(5),
-        timer_(asio_service_),
+        timing_wheel_(asio_service_),
+        timer_(asio_service_, timing_wheel_),
         message_and_caching_functor_(),
         message_(),
         mutex_(),
@@ -70,7 +74,8 @@ class MessageHandlerTest : public testing::Test {
     network_network_.reset(new NetworkUtils(node_id, asio_service_));
     table_.reset(new MockRoutingTable(false, node_id, asymm::GenerateKeyPair()));
     ntable_.reset(new ClientRoutingTable(table_->kNodeId()));
-    network_.reset(new MockNetwork(*table_, *ntable_, network_network_->acknowledgement_));
+    network_.reset(new MockNetwork(*table_, *ntable_, network_network_->acknowledgement_,
+                                   asio_service_));
     public_key_holder_.reset(new PublicKeyHolder(asio_service_, *network_));
     service_.reset(new MockService(*table_, *ntable_, *network_, *public_key_holder_));
     response_handler_.reset(new MockResponseHandler(*table_, *ntable_, *network_,
@@ -92,6 +97,7 @@ class MessageHandlerTest : public testing::Test {
 
  protected:
   BoostAsioService asio_service_;
+  TimingWheel timing_wheel_;
   Timer<std::string> timer_;
   MessageAndCachingFunctors message_and_caching_functor_;
   protobuf::Message message_;
@@ -110,7 +116,7 @@ class MessageHandlerTest : public testing::Test {
 
 TEST_F(MessageHandlerTest, BEH_HandleInvalidMessage) {
   MessageHandler message_handler(*table_, *ntable_, *network_, timer_, *network_network_,
-                                 asio_service_);
+                                 asio_service_, timing_wheel_);
   // Reset the service and response handler inside the message handler to be mocks
   message_handler.service_ = service_;
   message_handler.response_handler_ = response_handler_;
@@ -139,7 +145,7 @@ TEST_F(MessageHandlerTest, BEH_HandleInvalidMessage) {
 
 TEST_F(MessageHandlerTest, BEH_HandleRelay) {
   MessageHandler message_handler(*table_, *ntable_, *network_, timer_, *network_network_,
-                                 asio_service_);
+                                 asio_service_, timing_wheel_);
   message_handler.service_ = service_;
   message_handler.response_handler_ = response_handler_;
 
@@ -224,7 +230,7 @@ TEST_F(MessageHandlerTest, BEH_HandleRelay) {
 
 TEST_F(MessageHandlerTest, DISABLED_BEH_HandleGroupMessage) {
   MessageHandler message_handler(*table_, *ntable_, *network_, timer_, *network_network_,
-                                 asio_service_);
+                                 asio_service_, timing_wheel_);
   bool result(true);
   message_handler.service_ = service_;
   message_handler.response_handler_ = response_handler_;
@@ -583,7 +589,7 @@ TEST_F(MessageHandlerTest, DISABLED_BEH_HandleGroupMessage) {
 
 TEST_F(MessageHandlerTest, BEH_HandleNodeLevelMessage) {
   MessageHandler message_handler(*table_, *ntable_, *network_, timer_, *network_network_,
-                                 asio_service_);
+                                 asio_service_, timing_wheel_);
   message_handler.service_ = service_;
   message_handler.response_handler_ = response_handler_;
   protobuf::Message message;
@@ -632,6 +638,61 @@ TEST_F(MessageHandlerTest, BEH_HandleNodeLevelMessage) {
   }
 }
 
+TEST_F(MessageHandlerTest, BEH_GroupMessageAcks) {
+  MessageHandler message_handler(*table_, *ntable_, *network_, timer_, *network_network_,
+                                 asio_service_, timing_wheel_);
+  message_handler.service_ = service_;
+  message_handler.response_handler_ = response_handler_;
+  for (unsigned int i(0); i != Parameters::group_size * 2; ++i)
+    table_->AddNode(MakeNodeInfoAndKeys().node_info);
+  // This node is as far as it can be from the group, so only fans the message out to its members.
+  std::string group_id(table_->kNodeId().string());
+  for (auto& byte : group_id)
+    byte = static_cast<char>(~byte);
+
+  // The node fanning out a group message acks it to whoever asked: the previous hop for a
+  // hop-by-hop ack, or the source for an end-to-end ack.
+  for (bool end_to_end_ack : {false, true}) {
+    protobuf::Message message;
+    message.set_hops_to_live(1);
+    message.set_routing_message(false);
+    message.set_direct(false);
+    message.set_request(true);
+    message.set_client_node(false);
+    message.set_id(RandomInt32());
+    message.set_source_id(NodeId(NodeId::IdType::kRandomId).string());
+    message.set_destination_id(group_id);
+    message.add_data("DATA");
+    const int32_t kAckId(network_network_->acknowledgement_.GetId());
+    message.set_ack_id(kAckId);
+    const NodeId kPreviousHop(NodeId::IdType::kRandomId);
+    if (end_to_end_ack)
+      message.set_end_to_end_ack(true);
+    else
+      message.add_ack_node_ids(kPreviousHop.string());
+    const std::string kAckedNode(end_to_end_ack ? message.source_id() : kPreviousHop.string());
+
+    auto acked(std::make_shared<std::promise<void>>());
+    EXPECT_CALL(*network_,
+                SendToDirect(testing::AllOf(testing::Property(&protobuf::Message::destination_id,
+                                                              testing::Ne(group_id)),
+                                            testing::Property(&protobuf::Message::ack_id, 0)),
+                             testing::_, testing::_))
+        .Times(static_cast<int>(Parameters::group_size))
+        .RetiresOnSaturation();
+    EXPECT_CALL(*network_,
+                SendToClosestNode(testing::AllOf(
+                    testing::Property(&protobuf::Message::destination_id, kAckedNode),
+                    testing::Property(&protobuf::Message::ack_id, kAckId))))
+        .WillOnce(testing::InvokeWithoutArgs([acked] { acked->set_value(); }))
+        .RetiresOnSaturation();
+    message_handler.HandleGroupMessageAsCloseNode(message);
+    EXPECT_EQ(std::future_status::ready,
+              acked->get_future().wait_for(std::chrono::seconds(1)));
+    testing::Mock::VerifyAndClearExpectations(network_.get());
+  }
+}
+
 TEST_F(MessageHandlerTest, BEH_ClientRoutingTable) {
   auto maid(passport::CreateMaidAndSigner().first);
   asymm::Keys keys;
@@ -640,7 +701,7 @@ TEST_F(MessageHandlerTest, BEH_ClientRoutingTable) {
   table_.reset(new MockRoutingTable(true, NodeId(maid.name()->string()), keys));
   table_->AddNode(close_info_);
   MessageHandler message_handler(*table_, *ntable_, *network_, timer_, *network_network_,
-                                 asio_service_);
+                                 asio_service_, timing_wheel_);
   message_handler.service_ = service_;
   message_handler.response_handler_ = response_handler_;
   protobuf::Message message;
@@ -25,8 +25,8 @@ namespace routing {
 namespace test {
 
 MockNetwork::MockNetwork(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
-                         Acknowledgement& acknowledgement)
-    : Network(routing_table, client_routing_table, acknowledgement) {}
+                         Acknowledgement& acknowledgement, BoostAsioService& asio_service)
+    : Network(routing_table, client_routing_table, acknowledgement, asio_service) {}
 
 MockNetwork::~MockNetwork() {}
 
@@ -35,13 +35,20 @@ namespace test {
 class MockNetwork : public Network {
  public:
   MockNetwork(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
-              Acknowledgement& acknowledgement);
+              Acknowledgement& acknowledgement, BoostAsioService& asio_service);
   virtual ~MockNetwork();
 
   MOCK_METHOD1(SendToClosestNode, void(const protobuf::Message& message));
   MOCK_METHOD1(MarkConnectionAsValid, int(const NodeId& peer_id));
   MOCK_METHOD3(SendToDirect, void(protobuf::Message& message, const NodeId& peer,
                                   const NodeId& connection));
+  // Expectations on group messages are set on the overload above.
+  virtual void SendToDirect(const OutboundMessage& message, const NodeId& peer,
+                            const NodeId& connection) {
+    protobuf::Message sent;
+    sent.ParseFromString(message.Serialise());
+    SendToDirect(sent, peer, connection);
+  }
   MOCK_METHOD3(Add, int(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
                         const std::string& validation_data));
   MOCK_METHOD4(GetAvailableEndpoint,
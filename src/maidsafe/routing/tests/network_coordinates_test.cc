@@ -0,0 +1,115 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/network_coordinates.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(NetworkCoordinatesTest, BEH_DimensionListRoundTrip) {
+  NetworkCoordinates coordinates;
+  EXPECT_TRUE(coordinates.IsValid());
+  auto dimension_list(coordinates.ToDimensionList());
+  EXPECT_EQ(NetworkCoordinates::kDimensions + 2, dimension_list.size());
+  EXPECT_EQ(dimension_list, NetworkCoordinates(dimension_list).ToDimensionList());
+
+  std::vector<int32_t> encoded{ -2000, 3000, 400, 500, 250 };
+  NetworkCoordinates decoded(encoded);
+  ASSERT_TRUE(decoded.IsValid());
+  EXPECT_EQ(encoded, decoded.ToDimensionList());
+  EXPECT_DOUBLE_EQ(0.25, decoded.error());
+  std::vector<int32_t> origin{ 0, 0, 0, 500, 250 };
+  // sqrt(2000^2 + 3000^2 + 400^2) + 500 + 500
+  EXPECT_EQ(4628, decoded.EstimateRtt(NetworkCoordinates(origin)).count());
+
+  EXPECT_FALSE(NetworkCoordinates(std::vector<int32_t>()).IsValid());
+  EXPECT_FALSE(NetworkCoordinates(std::vector<int32_t>(3, 1)).IsValid());
+  EXPECT_FALSE(NetworkCoordinates(std::vector<int32_t>{ 0, 0, 0, -1, 100 }).IsValid());
+  EXPECT_FALSE(NetworkCoordinates(std::vector<int32_t>{ 0, 0, 0, 100, 1001 }).IsValid());
+  EXPECT_TRUE(NetworkCoordinates(std::vector<int32_t>(3, 1)).ToDimensionList().empty());
+}
+
+TEST(NetworkCoordinatesTest, BEH_IgnoresUnusableSamples) {
+  NetworkCoordinates coordinates;
+  auto before(coordinates.ToDimensionList());
+  coordinates.Update(NetworkCoordinates(std::vector<int32_t>()), std::chrono::milliseconds(10));
+  EXPECT_EQ(before, coordinates.ToDimensionList());
+  coordinates.Update(NetworkCoordinates(), std::chrono::microseconds(0));
+  EXPECT_EQ(before, coordinates.ToDimensionList());
+}
+
+TEST(NetworkCoordinatesTest, BEH_ConvergesToMeasuredLatency) {
+  // Nodes placed on a plane with an access link each; the true RTT between two nodes is their
+  // distance plus both access links.
+  const size_t kNodeCount(20);
+  struct Host {
+    double x, y, access;
+  };
+  std::vector<Host> hosts;
+  for (size_t i(0); i != kNodeCount; ++i) {
+    hosts.push_back(Host{ static_cast<double>(RandomUint32() % 100000),
+                          static_cast<double>(RandomUint32() % 100000),
+                          static_cast<double>(500 + RandomUint32() % 2000) });
+  }
+  auto true_rtt([&hosts](size_t lhs, size_t rhs) {
+    return std::chrono::microseconds(static_cast<int64_t>(
+        std::hypot(hosts[lhs].x - hosts[rhs].x, hosts[lhs].y - hosts[rhs].y) +
+        hosts[lhs].access + hosts[rhs].access));
+  });
+
+  std::vector<NetworkCoordinates> coordinates(kNodeCount);
+  for (int round(0); round != 400; ++round) {
+    for (size_t node(0); node != kNodeCount; ++node) {
+      size_t peer((node + 1 + RandomUint32() % (kNodeCount - 1)) % kNodeCount);
+      // Peers only ever see each other's coordinates as exchanged on the wire.
+      NetworkCoordinates remote(coordinates[peer].ToDimensionList());
+      coordinates[node].Update(remote, true_rtt(node, peer));
+    }
+  }
+
+  std::vector<double> relative_errors;
+  for (size_t lhs(0); lhs != kNodeCount; ++lhs) {
+    for (size_t rhs(lhs + 1); rhs != kNodeCount; ++rhs) {
+      auto actual(static_cast<double>(true_rtt(lhs, rhs).count()));
+      auto estimate(static_cast<double>(coordinates[lhs].EstimateRtt(coordinates[rhs]).count()));
+      relative_errors.push_back(std::abs(estimate - actual) / actual);
+    }
+  }
+  std::sort(std::begin(relative_errors), std::end(relative_errors));
+  EXPECT_LT(relative_errors.at(relative_errors.size() / 2), 0.2);
+  for (const auto& node_coordinates : coordinates)
+    EXPECT_LT(node_coordinates.error(), 0.5);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
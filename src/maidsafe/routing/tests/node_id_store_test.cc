@@ -0,0 +1,173 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/node_id_store.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/tests/test_utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+std::vector<NodeId> RandomIds(size_t count) {
+  std::vector<NodeId> node_ids;
+  while (node_ids.size() < count)
+    node_ids.emplace_back(RandomString(NodeId::kSize));
+  return node_ids;
+}
+
+void ExpectClosest(const NodeId& target, size_t count, const std::vector<NodeId>& node_ids,
+                   const NodeIdStore& store) {
+  auto expected(node_ids);
+  SortIdsFromTarget(target, expected);
+  expected.resize(std::min(count, expected.size()));
+  auto slots(store.ClosestSlots(target, count));
+  ASSERT_EQ(expected.size(), slots.size());
+  for (size_t index(0); index < slots.size(); ++index)
+    EXPECT_EQ(expected.at(index), node_ids.at(slots.at(index)));
+}
+
+}  // unnamed namespace
+
+TEST(NodeIdStoreTest, BEH_InsertErase) {
+  NodeIdStore store;
+  EXPECT_TRUE(store.empty());
+  EXPECT_TRUE(store.ClosestSlots(NodeId(RandomString(NodeId::kSize)), 4).empty());
+
+  std::vector<NodeId> node_ids;
+  for (const auto& node_id : RandomIds(100)) {
+    size_t slot(RandomUint32() % (node_ids.size() + 1));
+    store.Insert(slot, node_id);
+    node_ids.insert(std::begin(node_ids) + slot, node_id);
+  }
+  ASSERT_EQ(node_ids.size(), store.size());
+  for (size_t slot(0); slot < node_ids.size(); ++slot)
+    EXPECT_EQ(node_ids.at(slot), store.at(slot));
+
+  while (!node_ids.empty()) {
+    size_t slot(RandomUint32() % node_ids.size());
+    store.Erase(slot);
+    node_ids.erase(std::begin(node_ids) + slot);
+    ASSERT_EQ(node_ids.size(), store.size());
+    if (!node_ids.empty())
+      ExpectClosest(node_ids.front(), Parameters::closest_nodes_size, node_ids, store);
+  }
+  store.PushBack(NodeId(RandomString(NodeId::kSize)));
+  store.Clear();
+  EXPECT_TRUE(store.empty());
+}
+
+TEST(NodeIdStoreTest, BEH_ClosestSlots) {
+  auto node_ids(RandomIds(200));
+  NodeIdStore store(node_ids);
+  EXPECT_TRUE(store.ClosestSlots(node_ids.front(), 0).empty());
+  for (int i(0); i != 100; ++i) {
+    size_t count(RandomUint32() % (node_ids.size() + 10));
+    ExpectClosest(NodeId(RandomString(NodeId::kSize)), count, node_ids, store);
+    // Ids sharing a long prefix with the target are only told apart beyond the leading word.
+    NodeId target(node_ids.at(RandomUint32() % node_ids.size()));
+    ExpectClosest(target, count, node_ids, store);
+    std::string near_target(target.string());
+    near_target[NodeId::kSize - 1] ^= 1;
+    ExpectClosest(NodeId(near_target), count, node_ids, store);
+  }
+
+  std::vector<size_t> candidates;
+  for (size_t slot(0); slot < node_ids.size(); slot += 3)
+    candidates.push_back(slot);
+  NodeId target(RandomString(NodeId::kSize));
+  auto slots(store.ClosestSlots(target, 10, candidates));
+  ASSERT_EQ(10U, slots.size());
+  for (size_t index(0); index < slots.size(); ++index) {
+    EXPECT_EQ(0U, slots.at(index) % 3);
+    if (index != 0)
+      EXPECT_TRUE(NodeId::CloserToTarget(node_ids.at(slots.at(index - 1)),
+                                         node_ids.at(slots.at(index)), target));
+  }
+}
+
+TEST(NodeIdStoreTest, BEH_SortByDistance) {
+  auto node_ids(RandomIds(50));
+  NodeId target(RandomString(NodeId::kSize));
+  auto expected(node_ids);
+  SortIdsFromTarget(target, expected);
+  auto closest(ClosestByDistance(target, node_ids, Parameters::group_size));
+  ASSERT_EQ(Parameters::group_size, closest.size());
+  EXPECT_TRUE(std::equal(std::begin(closest), std::end(closest), std::begin(expected)));
+  SortByDistance(target, node_ids);
+  EXPECT_EQ(expected, node_ids);
+  EXPECT_EQ(2U, ClosestByDistance(target, std::vector<NodeId>(2, target), 5).size());
+}
+
+// Compares ranking a routing-table-sized set of ids with the distance kernel against sorting them
+// with NodeId::CloserToTarget.
+TEST(NodeIdStoreTest, FUNC_DistanceKernelSpeed) {
+  const size_t kIdCount(Parameters::max_routing_table_size), kIterations(2000);
+  auto node_ids(RandomIds(kIdCount));
+  NodeIdStore store(node_ids);
+  auto targets(RandomIds(kIterations));
+
+  size_t checksum(0);
+  auto start(std::chrono::steady_clock::now());
+  for (const auto& target : targets) {
+    auto sorted(node_ids);
+    std::partial_sort(std::begin(sorted), std::begin(sorted) + Parameters::group_size,
+                      std::end(sorted), [&target](const NodeId& lhs, const NodeId& rhs) {
+                        return NodeId::CloserToTarget(lhs, rhs, target);
+                      });
+    checksum += sorted.front().string()[0];
+  }
+  auto comparator_time(std::chrono::steady_clock::now() - start);
+
+  size_t kernel_checksum(0);
+  start = std::chrono::steady_clock::now();
+  for (const auto& target : targets)
+    kernel_checksum += node_ids.at(store.ClosestSlots(target, Parameters::group_size).front())
+                           .string()[0];
+  auto kernel_time(std::chrono::steady_clock::now() - start);
+
+  EXPECT_EQ(checksum, kernel_checksum);
+  auto comparator_us(std::chrono::duration_cast<std::chrono::microseconds>(comparator_time));
+  auto kernel_us(std::chrono::duration_cast<std::chrono::microseconds>(kernel_time));
+  std::cout << "Closest " << Parameters::group_size << " of " << kIdCount << " ids, "
+            << kIterations << " targets: CloserToTarget " << comparator_us.count()
+            << " us, distance kernel " << kernel_us.count() << " us, speedup "
+            << static_cast<double>(comparator_us.count()) / std::max<int64_t>(kernel_us.count(), 1)
+            << "x\n";
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,156 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/outbound_message.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+protobuf::Message MakeMessage() {
+  protobuf::Message message;
+  message.set_source_id(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_destination_id(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_routing_message(false);
+  message.add_data(RandomString(1024));
+  message.set_direct(false);
+  message.set_type(3);
+  message.set_id(RandomUint32() % 10000);
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(20);
+  message.add_route_history(NodeId(NodeId::IdType::kRandomId).string());
+  message.add_route_history(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_ack_id(7);
+  message.add_ack_node_ids(NodeId(NodeId::IdType::kRandomId).string());
+  return message;
+}
+
+protobuf::Message Parse(const OutboundMessage& outbound) {
+  protobuf::Message parsed;
+  EXPECT_TRUE(parsed.ParseFromString(outbound.Serialise()));
+  return parsed;
+}
+
+protobuf::Message WithoutPayload(protobuf::Message message) {
+  message.clear_data();
+  return message;
+}
+
+}  // unnamed namespace
+
+TEST(OutboundMessageTest, BEH_SerialisedParsesToMessage) {
+  const protobuf::Message kMessage(MakeMessage());
+  const OutboundMessage kOutbound(kMessage);
+  EXPECT_EQ(WithoutPayload(kMessage).SerializePartialAsString(),
+            kOutbound.message().SerializePartialAsString());
+  EXPECT_EQ(kMessage.SerializeAsString(), Parse(kOutbound).SerializeAsString());
+
+  // Copies share the message and its bytes.
+  const OutboundMessage kCopy(kOutbound);
+  EXPECT_EQ(&kOutbound.body(), &kCopy.body());
+  EXPECT_EQ(&kOutbound.message(), &kCopy.message());
+}
+
+TEST(OutboundMessageTest, BEH_HopVariantsShareBody) {
+  const protobuf::Message kMessage(MakeMessage());
+  const OutboundMessage kOutbound(kMessage);
+  const std::string kDestination(NodeId(NodeId::IdType::kRandomId).string());
+  const std::string kHop(NodeId(NodeId::IdType::kRandomId).string());
+  auto variant(kOutbound.WithHopFields([&](protobuf::Message& hop_fields) {
+    hop_fields.set_destination_id(kDestination);
+    hop_fields.set_ack_id(0);
+    hop_fields.clear_ack_node_ids();
+    hop_fields.clear_route_history();
+    hop_fields.add_route_history(kHop);
+  }));
+  EXPECT_TRUE(variant.SharesBodyWith(kOutbound));
+  EXPECT_EQ(WithoutPayload(kMessage).SerializePartialAsString(),
+            kOutbound.message().SerializePartialAsString());
+
+  protobuf::Message expected(kMessage);
+  expected.set_destination_id(kDestination);
+  expected.set_ack_id(0);
+  expected.clear_ack_node_ids();
+  expected.clear_route_history();
+  expected.add_route_history(kHop);
+  EXPECT_EQ(WithoutPayload(expected).SerializePartialAsString(),
+            variant.message().SerializePartialAsString());
+  // Repeated per-hop fields are replaced, not appended to those of the original.
+  auto parsed(Parse(variant));
+  ASSERT_EQ(1, parsed.route_history_size());
+  EXPECT_EQ(kHop, parsed.route_history(0));
+  EXPECT_EQ(0, parsed.ack_node_ids_size());
+  EXPECT_EQ(expected.SerializeAsString(), parsed.SerializeAsString());
+
+  // Variants of variants still share the original body.
+  auto second_variant(variant.WithHopFields([](protobuf::Message& hop_fields) {
+    hop_fields.clear_destination_id();
+  }));
+  EXPECT_TRUE(second_variant.SharesBodyWith(kOutbound));
+  EXPECT_FALSE(Parse(second_variant).has_destination_id());
+  EXPECT_TRUE(Parse(variant).has_destination_id());
+}
+
+TEST(OutboundMessageTest, BEH_DistinctMessagesDoNotShareBody) {
+  const OutboundMessage kFirst(MakeMessage()), kSecond(MakeMessage());
+  EXPECT_FALSE(kFirst.SharesBodyWith(kSecond));
+  EXPECT_NE(kFirst.body(), kSecond.body());
+}
+
+TEST(OutboundMessageTest, BEH_HopVariantsDoNotCopyPayload) {
+  protobuf::Message message(MakeMessage());
+  const std::string kPayload(RandomString(64 * 1024));
+  message.set_data(0, kPayload);
+  const OutboundMessage kOutbound(message);
+  ASSERT_NE(std::string::npos, kOutbound.body().find(kPayload));
+
+  std::vector<OutboundMessage> variants;
+  for (int i(0); i != 10; ++i) {
+    variants.push_back(kOutbound.WithHopFields([](protobuf::Message& hop_fields) {
+      hop_fields.set_destination_id(NodeId(NodeId::IdType::kRandomId).string());
+    }));
+  }
+  for (const auto& variant : variants) {
+    // The payload is held once, in the shared body, and in neither the variant's message nor its
+    // per-hop fields.
+    EXPECT_EQ(&kOutbound.body(), &variant.body());
+    EXPECT_EQ(0, variant.message().data_size());
+    EXPECT_EQ(std::string::npos, variant.hop_fields().find(kPayload));
+    EXPECT_LT(variant.hop_fields().size(), 1024U);
+    EXPECT_EQ(kPayload, Parse(variant).data(0));
+  }
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,171 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/priority_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_config.h"
+#include "maidsafe/routing/rpcs.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// Blocks the scheduler's only thread until the returned promise is set, so that tasks posted in
+// the meantime queue up.
+std::shared_ptr<std::promise<void>> BlockThread(BoostAsioService& asio_service) {
+  auto release(std::make_shared<std::promise<void>>());
+  std::shared_future<void> released(release->get_future().share());
+  asio_service.service().post([released] { released.wait(); });
+  return release;
+}
+
+}  // unnamed namespace
+
+TEST(PrioritySchedulerTest, BEH_Priority) {
+  NodeId node_id(NodeId::IdType::kRandomId);
+  protobuf::Message message(rpcs::FindNodes(RoutingConfig(), node_id, node_id, 8));
+  EXPECT_EQ(MessagePriority::kControl, Priority(message));
+  EXPECT_EQ(MessagePriority::kControl, Priority(rpcs::Ack(RoutingConfig(), node_id, node_id, 1)));
+
+  message.set_routing_message(false);
+  message.set_direct(true);
+  EXPECT_EQ(MessagePriority::kDirect, Priority(message));
+  message.set_direct(false);
+  EXPECT_EQ(MessagePriority::kGroup, Priority(message));
+  message.set_cacheable(static_cast<int32_t>(Cacheable::kGet));
+  EXPECT_EQ(MessagePriority::kCache, Priority(message));
+}
+
+TEST(PrioritySchedulerTest, BEH_RunsInPriorityOrder) {
+  BoostAsioService asio_service(1);
+  RoutingConfig config;
+  config.priority_starvation_limit = 0;
+  PriorityScheduler scheduler(asio_service, config);
+  std::vector<MessagePriority> order;
+  auto release(BlockThread(asio_service));
+  for (auto priority : { MessagePriority::kCache, MessagePriority::kDirect,
+                         MessagePriority::kGroup, MessagePriority::kControl }) {
+    scheduler.Post(priority, [&order, priority] { order.push_back(priority); });
+  }
+  EXPECT_EQ(4U, scheduler.queued());
+  EXPECT_EQ(1U, scheduler.queued(MessagePriority::kDirect));
+  release->set_value();
+  asio_service.Stop();
+  EXPECT_EQ(std::vector<MessagePriority>({ MessagePriority::kControl, MessagePriority::kGroup,
+                                           MessagePriority::kDirect, MessagePriority::kCache }),
+            order);
+}
+
+TEST(PrioritySchedulerTest, BEH_StarvationLimit) {
+  BoostAsioService asio_service(1);
+  RoutingConfig config;
+  config.priority_starvation_limit = 4;
+  PriorityScheduler scheduler(asio_service, config);
+  std::vector<MessagePriority> order;
+  auto release(BlockThread(asio_service));
+  scheduler.Post(MessagePriority::kCache, [&order] { order.push_back(MessagePriority::kCache); });
+  for (int index(0); index != 20; ++index) {
+    scheduler.Post(MessagePriority::kControl,
+                   [&order] { order.push_back(MessagePriority::kControl); });
+  }
+  release->set_value();
+  asio_service.Stop();
+  ASSERT_EQ(21U, order.size());
+  EXPECT_EQ(MessagePriority::kCache, order.at(4));
+}
+
+TEST(PrioritySchedulerTest, BEH_CancelAll) {
+  BoostAsioService asio_service(1);
+  std::atomic<int> run(0);
+  {
+    PriorityScheduler scheduler(asio_service);
+    auto release(BlockThread(asio_service));
+    scheduler.Post(MessagePriority::kDirect, [&run] { ++run; });
+    scheduler.CancelAll();
+    EXPECT_EQ(0U, scheduler.queued());
+    scheduler.Post(MessagePriority::kDirect, [&run] { ++run; });
+    release->set_value();
+    Sleep(std::chrono::milliseconds(100));
+    EXPECT_EQ(1, run.load());
+    release = BlockThread(asio_service);
+    scheduler.Post(MessagePriority::kDirect, [&run] { ++run; });
+    release->set_value();
+  }
+  asio_service.Stop();
+  EXPECT_LE(run.load(), 2);
+}
+
+TEST(PrioritySchedulerTest, FUNC_ControlLatencyUnderLoad) {
+  // Saturates two threads with node-level work and checks that control messages arriving
+  // meanwhile are handled within a few data tasks' time rather than after the backlog.
+  BoostAsioService asio_service(2);
+  PriorityScheduler scheduler(asio_service);
+  const int kDataTasks(2000), kControlTasks(20);
+  const auto kDataTaskTime(std::chrono::microseconds(500));
+  for (int index(0); index != kDataTasks; ++index)
+    scheduler.Post(MessagePriority::kDirect, [kDataTaskTime] {
+      auto end(std::chrono::steady_clock::now() + kDataTaskTime);
+      while (std::chrono::steady_clock::now() < end) {}
+    });
+
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  std::vector<std::chrono::steady_clock::duration> latencies;
+  for (int index(0); index != kControlTasks; ++index) {
+    Sleep(std::chrono::milliseconds(10));
+    const auto kPosted(std::chrono::steady_clock::now());
+    scheduler.Post(MessagePriority::kControl, [&, kPosted] {
+      std::lock_guard<std::mutex> lock(mutex);
+      latencies.push_back(std::chrono::steady_clock::now() - kPosted);
+      cond_var.notify_one();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cond_var.wait_for(lock, std::chrono::seconds(10),
+                                  [&] { return latencies.size() == kControlTasks; }));
+  }
+  // The data backlog is still being worked through.
+  EXPECT_GT(scheduler.queued(MessagePriority::kDirect), 0U);
+  for (const auto& latency : latencies)
+    EXPECT_LT(latency, std::chrono::milliseconds(50));
+  scheduler.CancelAll();
+  asio_service.Stop();
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -39,7 +39,7 @@ TEST(PublicKeyHolderTest, BEH_AddFindRemoveTimeout) {
   RoutingTable routing_table(false, node_details.node_info.id, asymm::Keys());
   ClientRoutingTable client_routing_table(node_details.node_info.id);
   Acknowledgement acknowledgment(node_details.node_info.id, asio_service);
-  Network network(routing_table, client_routing_table, acknowledgment);
+  Network network(routing_table, client_routing_table, acknowledgment, asio_service);
   PublicKeyHolder public_key_holder(asio_service, network);
 
   EXPECT_FALSE(public_key_holder.Find(NodeId(RandomString(NodeId::kSize))));
@@ -64,7 +64,7 @@ TEST(PublicKeyHolderTest, BEH_MultipleAddFindRemove) {
   RoutingTable routing_table(false, node_details.node_info.id, asymm::Keys());
   ClientRoutingTable client_routing_table(node_details.node_info.id);
   Acknowledgement acknowledgment(node_details.node_info.id, asio_service);
-  Network network(routing_table, client_routing_table, acknowledgment);
+  Network network(routing_table, client_routing_table, acknowledgment, asio_service);
   PublicKeyHolder public_key_holder(asio_service, network);
   std::vector<NodeInfoAndPrivateKey> nodes_details;
   const size_t kIterations(100);
@@ -139,7 +139,7 @@ TEST(PublicKeyHolderTest, BEH_MultipleAddFindTimeout) {
   RoutingTable routing_table(false, node_details.node_info.id, asymm::Keys());
   ClientRoutingTable client_routing_table(node_details.node_info.id);
   Acknowledgement acknowledgment(node_details.node_info.id, asio_service);
-  Network network(routing_table, client_routing_table, acknowledgment);
+  Network network(routing_table, client_routing_table, acknowledgment, asio_service);
   PublicKeyHolder public_key_holder(asio_service, network);
   std::vector<NodeInfoAndPrivateKey> nodes_details;
   const size_t kIterations(100);
@@ -0,0 +1,137 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "maidsafe/common/config.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/message.h"
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/utils.h"
+
+// Replacing the global operator new affects the whole executable, so these tests are built into
+// their own, test_routing_allocations, which starts no threads of its own: allocations are counted
+// while 'g_counting' is set, whichever thread makes them.
+namespace {
+
+bool g_counting(false);
+size_t g_allocations(0), g_bytes_allocated(0);
+
+}  // unnamed namespace
+
+void* operator new(size_t size) {
+  if (g_counting) {
+    ++g_allocations;
+    g_bytes_allocated += size;
+  }
+  if (void* memory = std::malloc(size ? size : 1))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) MAIDSAFE_NOEXCEPT { std::free(memory); }
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+struct AllocationCount {
+  size_t allocations, bytes;
+};
+
+template <typename Functor>
+AllocationCount CountAllocations(Functor functor) {
+  g_allocations = g_bytes_allocated = 0;
+  g_counting = true;
+  functor();
+  g_counting = false;
+  AllocationCount count = { g_allocations, g_bytes_allocated };
+  return count;
+}
+
+std::string SerialisedSingleToSingle(const std::string& payload) {
+  protobuf::Message message;
+  message.set_source_id(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_destination_id(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_routing_message(false);
+  message.add_data(payload);
+  message.set_direct(true);
+  message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(20);
+  message.set_id(1);
+  return message.SerializeAsString();
+}
+
+}  // unnamed namespace
+
+// Compares the allocations made between rudp handing a message to routing and routing handing its
+// payload to a typed message functor, as previously (copying rudp's buffer to post it, parsing the
+// copy then copying the payload into the typed message) and now.
+TEST(ReceivePathAllocationsTest, FUNC_ReceivePath) {
+  const size_t kPayloadSize(64 * 1024);
+  const std::string kSerialised(SerialisedSingleToSingle(RandomString(kPayloadSize)));
+
+  size_t payload_size(0);
+  auto copying(CountAllocations([&] {
+    std::shared_ptr<std::string> buffer(new std::string(kSerialised.data(), kSerialised.size()));
+    protobuf::Message message;
+    ASSERT_TRUE(message.ParseFromString(*buffer));
+    auto typed_message(CreateSingleToSingleMessage(message));
+    payload_size = typed_message.contents.size();
+  }));
+  ASSERT_EQ(kPayloadSize, payload_size);
+
+  payload_size = 0;
+  auto current(CountAllocations([&] {
+    auto message(ParseReceivedMessage(kSerialised));
+    ASSERT_TRUE(message != nullptr);
+    auto typed_message(TakeTypedMessage(*message, &CreateSingleToSingleMessage));
+    payload_size = typed_message.contents.size();
+  }));
+  ASSERT_EQ(kPayloadSize, payload_size);
+
+  std::cout << "Per received message of " << kSerialised.size() << " bytes - copying: "
+            << copying.allocations << " allocations, " << copying.bytes
+            << " bytes;  current: " << current.allocations << " allocations, " << current.bytes
+            << " bytes\n";
+  // The copy of rudp's buffer and the copy of the payload are both gone, leaving the payload
+  // allocated only once, by the parse.
+  EXPECT_LT(current.allocations, copying.allocations);
+  EXPECT_GT(copying.bytes, 3 * kPayloadSize);
+  EXPECT_LT(current.bytes, kSerialised.size() + kPayloadSize / 8);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
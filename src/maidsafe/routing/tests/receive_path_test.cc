@@ -0,0 +1,75 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/message.h"
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+std::string SerialisedSingleToSingle(const std::string& payload) {
+  protobuf::Message message;
+  message.set_source_id(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_destination_id(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_routing_message(false);
+  message.add_data(payload);
+  message.set_direct(true);
+  message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(20);
+  message.set_id(1);
+  return message.SerializeAsString();
+}
+
+}  // unnamed namespace
+
+TEST(ReceivePathTest, BEH_TakeTypedMessage) {
+  const std::string kPayload(RandomString(1024));
+  auto message(ParseReceivedMessage(SerialisedSingleToSingle(kPayload)));
+  ASSERT_TRUE(message != nullptr);
+  auto typed_message(TakeTypedMessage(*message, &CreateSingleToSingleMessage));
+  EXPECT_EQ(kPayload, typed_message.contents);
+  EXPECT_EQ(NodeId(message->source_id()), *typed_message.sender);
+  EXPECT_EQ(NodeId(message->destination_id()), *typed_message.receiver);
+  EXPECT_TRUE(message->data(0).empty());
+
+  message->clear_data();
+  EXPECT_THROW(TakeTypedMessage(*message, &CreateSingleToSingleMessage), maidsafe_error);
+
+  EXPECT_TRUE(ParseReceivedMessage("\xFF") == nullptr);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
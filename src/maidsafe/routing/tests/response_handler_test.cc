@@ -54,7 +54,8 @@ class ResponseHandlerTest : public testing::Test {
         network_utils_(node_id_, asio_service_),
         routing_table_(false, NodeId(RandomString(NodeId::kSize)), asymm::GenerateKeyPair()),
         client_routing_table_(routing_table_.kNodeId()),
-        network_(routing_table_, client_routing_table_, network_utils_.acknowledgement_),
+        network_(routing_table_, client_routing_table_, network_utils_.acknowledgement_,
+                 asio_service_),
         public_key_holder_(asio_service_, network_),
         response_handler_(new ResponseHandler(routing_table_, client_routing_table_, network_,
                                               public_key_holder_)) {}
@@ -0,0 +1,133 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/retry_scheduler.h"
+#include "maidsafe/routing/routing_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+RoutingConfig RetryConfig(std::chrono::milliseconds base_delay,
+                          std::chrono::milliseconds max_delay) {
+  RoutingConfig config;
+  config.retry_base_delay = base_delay;
+  config.retry_max_delay = max_delay;
+  config.max_retries_in_flight = 100;
+  config.retry_budget = 100;
+  return config;
+}
+
+}  // unnamed namespace
+
+TEST(RetrySchedulerTest, BEH_RunsRetryAfterBackoff) {
+  BoostAsioService asio_service(1);
+  RetryScheduler retry_scheduler(asio_service, RetryConfig(std::chrono::milliseconds(40),
+                                                           std::chrono::milliseconds(400)));
+  NodeId peer_id(RandomString(NodeId::kSize));
+  std::promise<void> retried;
+  auto scheduled_at(std::chrono::steady_clock::now());
+  EXPECT_TRUE(retry_scheduler.Schedule(peer_id, [&retried] { retried.set_value(); }));
+  EXPECT_EQ(1U, retry_scheduler.in_flight());
+  ASSERT_EQ(std::future_status::ready,
+            retried.get_future().wait_for(std::chrono::seconds(2)));
+  EXPECT_GE(std::chrono::steady_clock::now() - scheduled_at, std::chrono::milliseconds(20));
+  EXPECT_EQ(0U, retry_scheduler.in_flight());
+}
+
+TEST(RetrySchedulerTest, BEH_BackoffIsPerPeer) {
+  BoostAsioService asio_service(1);
+  const std::chrono::milliseconds kBaseDelay(1000), kMaxDelay(5000);
+  RetryScheduler retry_scheduler(asio_service, RetryConfig(kBaseDelay, kMaxDelay));
+  NodeId failing_peer(RandomString(NodeId::kSize)), other_peer(RandomString(NodeId::kSize));
+  EXPECT_EQ(kBaseDelay, retry_scheduler.Backoff(failing_peer));
+  for (auto expected : { 2000, 4000, 5000, 5000 }) {
+    EXPECT_TRUE(retry_scheduler.Schedule(failing_peer, [] {}));
+    EXPECT_EQ(std::chrono::milliseconds(expected), retry_scheduler.Backoff(failing_peer));
+  }
+  EXPECT_EQ(kBaseDelay, retry_scheduler.Backoff(other_peer));
+  retry_scheduler.Reset(failing_peer);
+  EXPECT_EQ(kBaseDelay, retry_scheduler.Backoff(failing_peer));
+}
+
+TEST(RetrySchedulerTest, BEH_LimitsRetriesInFlight) {
+  BoostAsioService asio_service(1);
+  auto config(RetryConfig(std::chrono::seconds(10), std::chrono::seconds(10)));
+  config.max_retries_in_flight = 2;
+  RetryScheduler retry_scheduler(asio_service, config);
+  std::atomic<int> run_count(0);
+  for (int i(0); i != 2; ++i)
+    EXPECT_TRUE(retry_scheduler.Schedule(NodeId(RandomString(NodeId::kSize)),
+                                         [&run_count] { ++run_count; }));
+  EXPECT_FALSE(retry_scheduler.Schedule(NodeId(RandomString(NodeId::kSize)),
+                                        [&run_count] { ++run_count; }));
+  EXPECT_EQ(2U, retry_scheduler.in_flight());
+  retry_scheduler.CancelAll();
+  EXPECT_EQ(0U, retry_scheduler.in_flight());
+  EXPECT_TRUE(retry_scheduler.Schedule(NodeId(RandomString(NodeId::kSize)),
+                                       [&run_count] { ++run_count; }));
+  Sleep(std::chrono::milliseconds(100));
+  EXPECT_EQ(0, run_count);
+}
+
+TEST(RetrySchedulerTest, BEH_EnforcesRetryBudget) {
+  BoostAsioService asio_service(1);
+  auto config(RetryConfig(std::chrono::seconds(10), std::chrono::seconds(10)));
+  config.retry_budget = 3;
+  RetryScheduler retry_scheduler(asio_service, config);
+  NodeId peer_id(RandomString(NodeId::kSize));
+  for (int i(0); i != 3; ++i)
+    EXPECT_TRUE(retry_scheduler.Schedule(peer_id, [] {}));
+  EXPECT_FALSE(retry_scheduler.Schedule(peer_id, [] {}));
+  // The budget refills at 3 per second.
+  Sleep(std::chrono::milliseconds(500));
+  EXPECT_TRUE(retry_scheduler.Schedule(peer_id, [] {}));
+}
+
+TEST(RetrySchedulerTest, BEH_DestructionCancelsPendingRetries) {
+  BoostAsioService asio_service(1);
+  std::atomic<bool> retried(false);
+  {
+    RetryScheduler retry_scheduler(asio_service, RetryConfig(std::chrono::milliseconds(50),
+                                                             std::chrono::milliseconds(50)));
+    EXPECT_TRUE(retry_scheduler.Schedule(NodeId(RandomString(NodeId::kSize)),
+                                         [&retried] { retried = true; }));
+  }
+  Sleep(std::chrono::milliseconds(200));
+  EXPECT_FALSE(retried);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -22,6 +22,8 @@
 #include <future>
 #include <memory>
 #include <mutex>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -73,6 +75,28 @@ MessageReceivedFunctor no_ops_message_received_functor = [](const std::string&,
                                                             ReplyFunctor) {};  // NOLINT
 }  // anonymous namespace
 
+TEST(APITest, BEH_API_SendOverloadsWithNullFunctors) {
+  // Only needs to compile: each call form, with null or empty functors, resolves to one overload.
+  Routing* routing(nullptr);
+  static_assert(std::is_same<void, decltype(routing->SendGroup(NodeId(), std::string(), false,
+                                                               2, nullptr))>::value, "");
+  static_assert(std::is_same<void, decltype(routing->SendGroup(NodeId(), std::string(), false,
+                                                               2, nullptr, nullptr))>::value, "");
+  static_assert(std::is_same<void, decltype(routing->SendGroup(NodeId(), std::string(), false,
+                                                               2, {}))>::value, "");
+  static_assert(std::is_same<void, decltype(routing->SendGroup(NodeId(), std::string(), false,
+                                                               nullptr))>::value, "");
+  static_assert(std::is_same<void, decltype(routing->SendDirect(NodeId(), std::string(), false,
+                                                                nullptr))>::value, "");
+  static_assert(std::is_same<PendingResponse,
+                             decltype(routing->SendGroupAsync(NodeId(), std::string(), false, 2,
+                                                              nullptr))>::value, "");
+  static_assert(std::is_same<PendingResponse,
+                             decltype(routing->SendDirectAsync(NodeId(), std::string(),
+                                                               false))>::value, "");
+  static_cast<void>(routing);
+}
+
 TEST(APITest, BEH_API_ZeroState) {
   Endpoint endpoint1(maidsafe::AsioToBoostAsio(maidsafe::GetLocalIp()),
                      maidsafe::test::GetRandomPort()),
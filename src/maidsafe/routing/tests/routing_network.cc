@@ -151,6 +151,29 @@ GenericNode::GenericNode(const passport::Pmid& pmid, bool has_symmetric_nat)
   id_ = next_node_id_++;
 }
 
+GenericNode::GenericNode(const passport::Pmid& pmid, const RoutingConfig& config)
+    : functors_(),
+      id_(0),
+      node_info_plus_(std::make_shared<NodeInfoAndPrivateKey>(MakeNodeInfoAndKeysWithFob(pmid))),
+      maid_(),
+      mutex_(),
+      client_mode_(false),
+      joined_(false),
+      expected_(0),
+      nat_type_(rudp::NatType::kUnknown),
+      has_symmetric_nat_(false),
+      endpoint_(),
+      messages_(),
+      routing_(),
+      health_(0) {
+  endpoint_.address(AsioToBoostAsio(GetLocalIp()));
+  endpoint_.port(maidsafe::test::GetRandomPort());
+  InitialiseFunctors();
+  routing_.reset(new Routing(pmid, config));
+  std::lock_guard<std::mutex> lock(mutex_);
+  id_ = next_node_id_++;
+}
+
 GenericNode::GenericNode(const passport::Maid& maid, bool has_symmetric_nat)
     : functors_(),
       id_(0),
@@ -224,7 +247,7 @@ bool GenericNode::IsClient() const { return client_mode_; }
 bool GenericNode::HasSymmetricNat() const { return has_symmetric_nat_; }
 
 std::vector<NodeInfo> GenericNode::RoutingTable() const {
-  return routing_->pimpl_->routing_table_->nodes_;
+  return routing_->pimpl_->routing_table_->Snapshot()->nodes();
 }
 
 bool GenericNode::IsConnectedVault(const NodeId& node_id) {
@@ -261,6 +284,10 @@ void GenericNode::SendMessage(const NodeId& destination_id, protobuf::Message& p
   routing_->pimpl_->SendMessage(destination_id, proto_message);
 }
 
+protobuf::Message GenericNode::CreateNodeLevelMessage(const SingleToSingleMessage& message) {
+  return routing_->pimpl_->CreateNodeLevelMessage(message);
+}
+
 void GenericNode::AddTask(const ResponseFunctor& response_functor, int expected_response_count,
                           TaskId task_id) {
   routing_->pimpl_->timer_.AddTask(Parameters::default_response_timeout, response_functor,
@@ -269,7 +296,8 @@ void GenericNode::AddTask(const ResponseFunctor& response_functor, int expected_
 
 void GenericNode::RudpSend(const NodeId& peer_node_id, const protobuf::Message& message,
                            rudp::MessageSentFunctor message_sent_functor) {
-  routing_->pimpl_->network_->RudpSend(peer_node_id, message, message_sent_functor);
+  routing_->pimpl_->network_->RudpSend(peer_node_id, OutboundMessage(message),
+                                       message_sent_functor);
 }
 
 void GenericNode::SendToClosestNode(const protobuf::Message& message) {
@@ -277,11 +305,7 @@ void GenericNode::SendToClosestNode(const protobuf::Message& message) {
 }
 
 bool GenericNode::RoutingTableHasNode(const NodeId& node_id) {
-  auto node(std::find_if(routing_->pimpl_->routing_table_->nodes_.begin(),
-                         routing_->pimpl_->routing_table_->nodes_.end(),
-                         [node_id](const NodeInfo& node_info) { return node_id == node_info.id; }));
-  bool result(node != routing_->pimpl_->routing_table_->nodes_.end());
-  return result;
+  return routing_->pimpl_->routing_table_->Contains(node_id);
 }
 
 bool GenericNode::ClientRoutingTableHasNode(const NodeId& node_id) {
@@ -297,11 +321,11 @@ NodeInfo GenericNode::GetNthClosestNode(const NodeId& target_id, unsigned int no
 }
 
 testing::AssertionResult GenericNode::DropNode(const NodeId& node_id) {
+  auto snapshot(routing_->pimpl_->routing_table_->Snapshot());
   auto iter =
-      std::find_if(routing_->pimpl_->routing_table_->nodes_.begin(),
-                   routing_->pimpl_->routing_table_->nodes_.end(),
+      std::find_if(snapshot->nodes().begin(), snapshot->nodes().end(),
                    [&node_id](const NodeInfo& node_info) { return (node_id == node_info.id); });
-  if (iter != routing_->pimpl_->routing_table_->nodes_.end()) {
+  if (iter != snapshot->nodes().end()) {
     routing_->pimpl_->routing_table_->DropNode(iter->connection_id, false);
   } else {
     testing::AssertionFailure() << DebugId(routing_->pimpl_->routing_table_->kNodeId_)
@@ -332,21 +356,24 @@ void GenericNode::PrintRoutingTable() {
 
 std::vector<NodeId> GenericNode::ReturnRoutingTable() {
   std::vector<NodeId> routing_nodes;
-  std::lock_guard<std::mutex> lock(routing_->pimpl_->routing_table_->mutex_);
-  for (const auto& node_info : routing_->pimpl_->routing_table_->nodes_)
+  for (const auto& node_info : routing_->pimpl_->routing_table_->Snapshot()->nodes())
     routing_nodes.push_back(node_info.id);
   return routing_nodes;
 }
 
 std::string GenericNode::SerializeRoutingTable() {
   std::vector<NodeId> node_list;
-  for (const auto& node_info : routing_->pimpl_->routing_table_->nodes_)
+  for (const auto& node_info : routing_->pimpl_->routing_table_->Snapshot()->nodes())
     node_list.push_back(node_info.id);
   return SerializeNodeIdList(node_list);
 }
 
 size_t GenericNode::MessagesSize() const { return messages_.size(); }
 
+uint64_t GenericNode::MessagesSent() const {
+  return routing_->pimpl_->network_->messages_sent();
+}
+
 void GenericNode::ClearMessages() {
   std::lock_guard<std::mutex> lock(mutex_);
   messages_.clear();
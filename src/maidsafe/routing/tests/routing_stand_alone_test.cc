@@ -16,6 +16,9 @@
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
 
+#include <cstdint>
+#include <ctime>
+#include <iostream>
 #include <vector>
 
 #include "boost/filesystem.hpp"
@@ -251,6 +254,33 @@ class ProportionedRoutingStandAloneTest : public GenericNetwork, public testing:
     GenericNetwork::TearDown();
   }
 
+ protected:
+  // Sends direct messages between all vaults, and group messages from some, over a network big
+  // enough for most to take several hops, and reports the messages sent and CPU time used, acks
+  // included.
+  void ReportAckCost(bool end_to_end_acks) {
+    const bool kOldEndToEndAcks(Parameters::end_to_end_acks);
+    Parameters::end_to_end_acks = end_to_end_acks;
+    SetUpNetwork(80, 0, 0, 0);
+    auto messages_sent([this]()->uint64_t {
+      uint64_t messages_sent(0);
+      for (const auto& node : nodes_)
+        messages_sent += node->MessagesSent();
+      return messages_sent;
+    });
+    const uint64_t kMessagesSentBefore(messages_sent());
+    const std::clock_t kStart(std::clock());
+    EXPECT_TRUE(SendDirect(2, 1024));
+    for (unsigned int index(0); index < nodes_.size(); index += 8)
+      EXPECT_TRUE(SendGroup(NodeId(RandomString(NodeId::kSize)), 1, index, 1024));
+    // Leaves time for any outstanding acks to be batched and sent.
+    Sleep(std::chrono::milliseconds(100) + Parameters::ack_batch_window * 2);
+    std::cout << (end_to_end_acks ? "End-to-end" : "Hop-by-hop") << " acks: "
+              << messages_sent() - kMessagesSentBefore << " messages sent, "
+              << (std::clock() - kStart) * 1000 / CLOCKS_PER_SEC << "ms CPU time" << std::endl;
+    Parameters::end_to_end_acks = kOldEndToEndAcks;
+  }
+
  private:
   unsigned int old_max_routing_table_size_;
   unsigned int old_routing_table_size_threshold_;
@@ -284,6 +314,15 @@ TEST_F(ProportionedRoutingStandAloneTest, DISABLED_FUNC_ExtendedMessagePassing)
   }
 }
 
+// The two tests below send the same messages, to compare the cost of the two ack modes.
+TEST_F(ProportionedRoutingStandAloneTest, DISABLED_FUNC_HopByHopAckCost) {
+  ReportAckCost(false);
+}
+
+TEST_F(ProportionedRoutingStandAloneTest, DISABLED_FUNC_EndToEndAckCost) {
+  ReportAckCost(true);
+}
+
 TEST_F(ProportionedRoutingStandAloneTest, DISABLED_FUNC_ExtendedMessagePassingSymmetricNat) {
   // Approx duration of test on Linux: 90mins
   SetUpNetwork(80, 0, 20, 0);
@@ -46,14 +46,8 @@ struct RoutingTableInfo {
 
 std::vector<NodeId> RoutingTableInfo::GetGroup(const NodeId& target) {
   std::vector<NodeId> group_ids;
-  std::partial_sort(
-      std::begin(routing_table->nodes_), std::begin(routing_table->nodes_) + Parameters::group_size,
-      std::end(routing_table->nodes_), [target](const NodeInfo& lhs, const NodeInfo& rhs) {
-        return NodeId::CloserToTarget(lhs.id, rhs.id, target);
-      });
-  for (auto iter(std::begin(routing_table->nodes_));
-       iter != std::begin(routing_table->nodes_) + Parameters::group_size; ++iter)
-    group_ids.push_back(iter->id);
+  for (const auto& node_info : routing_table->GetClosestNodes(target, Parameters::group_size))
+    group_ids.push_back(node_info.id);
   group_ids.push_back(routing_table->kNodeId());
   std::sort(std::begin(group_ids), std::end(group_ids),
             [target](const NodeId& lhs,
@@ -254,7 +248,7 @@ void RoutingTableNetwork::AddNewNode() {
       AddNode(*nodes_info_.rbegin(), nodes_info_.at(index));
     }
   } else if (RoutingTableInfo::ready_nodes != 0) {
-    while ((*nodes_info_.rbegin())->routing_table->nodes_.size() <
+    while ((*nodes_info_.rbegin())->routing_table->size() <
            static_cast<size_t>(Parameters::unidirectional_interest_range)) {
       AddNode(*nodes_info_.rbegin(),
               nodes_info_.at(RandomUint32() % RoutingTableInfo::ready_nodes));
@@ -265,7 +259,7 @@ void RoutingTableNetwork::AddNewNode() {
     for (size_t i(0); i < RoutingTableInfo::ready_nodes; ++i) {
       AddNode(*nodes_info_.rbegin(),
               nodes_info_.at((i + random_index) % RoutingTableInfo::ready_nodes));
-      if ((*nodes_info_.rbegin())->routing_table->nodes_.size() > 60)
+      if ((*nodes_info_.rbegin())->routing_table->size() > 60)
         break;
     }
   }
@@ -310,11 +304,7 @@ void RoutingTableNetwork::ValidateRoutingTable() {
     std::advance(last_close_iter, kNumberofClosestNode);
     for (auto node_ids_iter(std::begin(node_ids) + 1); node_ids_iter != last_close_iter;
          ++node_ids_iter) {
-      if (std::none_of(std::begin((*iter)->routing_table->nodes_),
-                       std::end((*iter)->routing_table->nodes_),
-                       [node_ids_iter](const NodeInfo& node_info) {
-            return node_info.id == *node_ids_iter;
-          })) {
+      if (!(*iter)->routing_table->Contains(*node_ids_iter)) {
         LOG(kError) << *node_ids_iter << " is not in close nodes of "
                     << (*iter)->routing_table->kNodeId() << " distance "
                     << std::distance(std::begin(node_ids), node_ids_iter);
@@ -362,11 +352,7 @@ void RoutingTableNetwork::ValidateRoutingTable(std::shared_ptr<RoutingTableInfo>
   auto last_close(std::begin(nodes_info_));
   std::advance(last_close, kNumberofClosestNode + 1);
   for (auto iter(std::begin(nodes_info_) + 1); iter != last_close; ++iter) {
-    EXPECT_FALSE(std::none_of(std::begin(info->routing_table->nodes_),
-                              std::end(info->routing_table->nodes_),
-                              [iter](const NodeInfo& node_info) {
-      return node_info.id == (*iter)->routing_table->kNodeId();
-    }))
+    EXPECT_TRUE(info->routing_table->Contains((*iter)->routing_table->kNodeId()))
         << info->routing_table->kNodeId() << " missing close " << (*iter)->routing_table->kNodeId();
   }
 }
@@ -403,14 +389,10 @@ void RoutingTableNetwork::GetCloseNodeIndexStats() {
   size_t max_close_index(0), total_close_index(0), close_index_count(0);
   for (auto iter(std::begin(nodes_info_)); iter != std::end(nodes_info_); ++iter) {
     NodeId node_id((*iter)->routing_table->kNodeId());
-    std::partial_sort(std::begin((*iter)->routing_table->nodes_),
-                      std::begin((*iter)->routing_table->nodes_) + kNumberofClosestNode,
-                      std::end((*iter)->routing_table->nodes_),
-                      [node_id](const NodeInfo& lhs, const NodeInfo& rhs) {
-      return NodeId::CloserToTarget(lhs.id, rhs.id, node_id);
-    });
+    auto closest_nodes((*iter)->routing_table->GetClosestNodes(
+        node_id, static_cast<unsigned int>(kNumberofClosestNode)));
     for (size_t index(0); index < kNumberofClosestNode; ++index) {
-      auto distance(GetClosenessIndex((*iter)->routing_table->nodes_.at(index).id, node_id));
+      auto distance(GetClosenessIndex(closest_nodes.at(index).id, node_id));
       max_close_index = (distance > max_close_index) ? distance : max_close_index;
       total_close_index += distance;
       close_index_count++;
@@ -16,8 +16,10 @@
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
 
+#include <algorithm>
 #include <bitset>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "maidsafe/common/log.h"
@@ -319,6 +321,376 @@ TEST(RoutingTableTest, FUNC_GetRandomExistingNode) {
     run_random_connected_node_test();
 }
 
+TEST(RoutingTableTest, BEH_SnapshotIsUnaffectedByChanges) {
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
+  auto empty_snapshot(routing_table.Snapshot());
+  EXPECT_EQ(0, empty_snapshot->size());
+
+  std::vector<NodeInfo> added_nodes;
+  while (routing_table.size() < Parameters::closest_nodes_size) {
+    NodeInfo node(MakeNode());
+    EXPECT_TRUE(routing_table.AddNode(node));
+    added_nodes.push_back(node);
+  }
+  auto full_snapshot(routing_table.Snapshot());
+  EXPECT_EQ(0, empty_snapshot->size());
+  EXPECT_EQ(added_nodes.size(), full_snapshot->size());
+  // A check which doesn't modify the table doesn't publish a new snapshot.
+  EXPECT_TRUE(routing_table.CheckNode(MakeNode()));
+  EXPECT_EQ(full_snapshot, routing_table.Snapshot());
+
+  NodeId target(RandomString(NodeId::kSize));
+  auto closest(full_snapshot->GetClosestNodes(target, Parameters::group_size));
+  EXPECT_EQ(routing_table.GetClosestNodes(target, Parameters::group_size).front().id,
+            closest.front().id);
+  EXPECT_EQ(closest.front().id, routing_table.DropNode(closest.front().id, true).id);
+  EXPECT_FALSE(routing_table.Contains(closest.front().id));
+  EXPECT_TRUE(full_snapshot->Contains(closest.front().id));
+  EXPECT_EQ(closest.front().id, full_snapshot->GetClosestNode(target).id);
+  EXPECT_EQ(added_nodes.size(), full_snapshot->size());
+  EXPECT_EQ(added_nodes.size() - 1, routing_table.size());
+}
+
+TEST(RoutingTableTest, BEH_NodesAreOrderedByDistanceToSelf) {
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
+  auto is_ordered([&node_id](const std::vector<NodeInfo>& nodes) {
+    return std::is_sorted(std::begin(nodes), std::end(nodes),
+                          [&node_id](const NodeInfo& lhs, const NodeInfo& rhs) {
+                            return NodeId::CloserToTarget(lhs.id, rhs.id, node_id);
+                          });
+  });
+
+  std::vector<NodeId> added_ids;
+  while (routing_table.size() < routing_table.kMaxSize()) {
+    NodeInfo node(MakeNode());
+    EXPECT_TRUE(routing_table.AddNode(node));
+    added_ids.push_back(node.id);
+    ASSERT_TRUE(is_ordered(routing_table.Snapshot()->nodes()));
+  }
+  for (size_t i(0); i < added_ids.size(); i += 3) {
+    routing_table.DropNode(added_ids.at(i), true);
+    ASSERT_TRUE(is_ordered(routing_table.Snapshot()->nodes()));
+  }
+  auto snapshot(routing_table.Snapshot());
+  auto closest(routing_table.GetClosestNodes(node_id, Parameters::closest_nodes_size));
+  for (size_t i(0); i < closest.size(); ++i)
+    EXPECT_EQ(snapshot->nodes().at(i).id, closest.at(i).id);
+}
+
+TEST(RoutingTableTest, BEH_FindByIdOrConnectionId) {
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
+  std::vector<NodeInfo> added_nodes;
+  while (routing_table.size() < routing_table.kMaxSize()) {
+    NodeInfo node(MakeNode());
+    node.connection_id = NodeId(RandomString(NodeId::kSize));
+    EXPECT_TRUE(routing_table.AddNode(node));
+    added_nodes.push_back(node);
+  }
+
+  NodeInfo node_info;
+  for (const auto& node : added_nodes) {
+    EXPECT_TRUE(routing_table.Contains(node.id));
+    EXPECT_TRUE(routing_table.Contains(node.connection_id));
+    ASSERT_TRUE(routing_table.GetNodeInfo(node.connection_id, node_info));
+    EXPECT_EQ(node.id, node_info.id);
+  }
+  EXPECT_FALSE(routing_table.Contains(NodeId(RandomString(NodeId::kSize))));
+
+  // Dropping nodes shifts the slots of those further away; every remaining lookup must follow.
+  for (size_t index(0); index < added_nodes.size(); index += 2) {
+    const auto& node(added_nodes.at(index));
+    EXPECT_EQ(node.id, routing_table.DropNode(node.connection_id, true).id);
+    EXPECT_FALSE(routing_table.Contains(node.id));
+    EXPECT_FALSE(routing_table.Contains(node.connection_id));
+  }
+  for (size_t index(1); index < added_nodes.size(); index += 2) {
+    ASSERT_TRUE(routing_table.GetNodeInfo(added_nodes.at(index).id, node_info));
+    EXPECT_EQ(added_nodes.at(index).connection_id, node_info.connection_id);
+  }
+}
+
+TEST(RoutingTableTest, BEH_DuplicatePublicKeyIsRejected) {
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
+  std::vector<NodeInfo> added_nodes;
+  while (added_nodes.size() < Parameters::closest_nodes_size) {
+    NodeInfo node(MakeNode());
+    EXPECT_TRUE(routing_table.AddNode(node));
+    added_nodes.push_back(node);
+  }
+
+  NodeInfo impostor(MakeNode());
+  impostor.public_key = added_nodes.back().public_key;
+  EXPECT_FALSE(routing_table.AddNode(impostor));
+  EXPECT_FALSE(routing_table.Contains(impostor.id));
+
+  routing_table.DropNode(added_nodes.back().id, true);
+  EXPECT_TRUE(routing_table.AddNode(impostor));
+  EXPECT_TRUE(routing_table.AddNode(MakeNode()));
+}
+
+TEST(RoutingTableTest, BEH_AddNodesFiresSingleChange) {
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
+  std::vector<RoutingTableChange> changes;
+  routing_table.InitialiseFunctors([&changes](const RoutingTableChange& routing_table_change) {
+    changes.push_back(routing_table_change);
+  });
+
+  std::vector<NodeInfo> peers;
+  for (unsigned int i(0); i != routing_table.kMaxSize(); ++i)
+    peers.push_back(MakeNode());
+  NodeInfo invalid_peer(MakeNode());
+  invalid_peer.id = node_id;
+  peers.push_back(invalid_peer);
+  peers.push_back(peers.front());
+
+  auto added(routing_table.AddNodes(peers));
+  ASSERT_EQ(peers.size(), added.size());
+  EXPECT_EQ(routing_table.kMaxSize(),
+            static_cast<unsigned int>(std::count(std::begin(added), std::end(added), true)));
+  EXPECT_FALSE(added.at(routing_table.kMaxSize()));
+  EXPECT_FALSE(added.back());
+  EXPECT_EQ(routing_table.kMaxSize(), routing_table.size());
+
+  ASSERT_EQ(1U, changes.size());
+  EXPECT_EQ(routing_table.kMaxSize(), changes.front().added_nodes.size());
+  EXPECT_TRUE(changes.front().removed_nodes.empty());
+  ASSERT_TRUE(changes.front().close_nodes_change != nullptr);
+  EXPECT_TRUE(changes.front().close_nodes_change->old_close_nodes().empty());
+  EXPECT_EQ(Parameters::closest_nodes_size,
+            changes.front().close_nodes_change->new_close_nodes().size());
+
+  // A second batch into the full table evicts nodes, all of which are reported in one change.
+  std::vector<NodeInfo> close_peers;
+  for (int i(0); i != 3; ++i) {
+    NodeInfo close_peer(MakeNode());
+    std::string close_id(node_id.string());
+    close_id.replace(NodeId::kSize - 2, 2, RandomString(2));
+    close_peer.id = NodeId(close_id);
+    close_peers.push_back(close_peer);
+  }
+  changes.clear();
+  added = routing_table.AddNodes(close_peers);
+  EXPECT_EQ(routing_table.kMaxSize(), routing_table.size());
+  ASSERT_EQ(1U, changes.size());
+  auto added_count(static_cast<size_t>(std::count(std::begin(added), std::end(added), true)));
+  EXPECT_EQ(added_count, changes.front().added_nodes.size());
+  EXPECT_EQ(added_count, changes.front().removed_nodes.size());
+  for (const auto& removed : changes.front().removed_nodes)
+    EXPECT_FALSE(routing_table.Contains(removed.node.id));
+
+  changes.clear();
+  EXPECT_EQ(std::vector<bool>(1, false),
+            routing_table.AddNodes(std::vector<NodeInfo>(1, routing_table.Snapshot()->nodes()[0])));
+  EXPECT_TRUE(changes.empty());
+}
+
+TEST(RoutingTableTest, BEH_AddNodesSkipsBadKey) {
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
+  std::vector<RoutingTableChange> changes;
+  routing_table.InitialiseFunctors([&changes](const RoutingTableChange& routing_table_change) {
+    changes.push_back(routing_table_change);
+  });
+
+  std::vector<NodeInfo> peers;
+  for (int i(0); i != 4; ++i)
+    peers.push_back(MakeNode());
+  peers[1].public_key = asymm::PublicKey();
+
+  std::vector<bool> added;
+  ASSERT_NO_THROW(added = routing_table.AddNodes(peers));
+  EXPECT_EQ(std::vector<bool>({true, false, true, true}), added);
+  EXPECT_EQ(3U, routing_table.size());
+  EXPECT_FALSE(routing_table.Contains(peers[1].id));
+  ASSERT_EQ(1U, changes.size());
+  EXPECT_EQ(3U, changes.front().added_nodes.size());
+}
+
+TEST(RoutingTableTest, BEH_PerInstanceConfig) {
+  RoutingConfig small_config;
+  small_config.max_routing_table_size = 12;
+  small_config.routing_table_size_threshold = 3;
+  small_config.closest_nodes_size = 4;
+  small_config.unidirectional_interest_range = 8;
+  RoutingTable small_table(false, NodeId(RandomString(NodeId::kSize)), asymm::GenerateKeyPair(),
+                           small_config);
+  RoutingTable default_table(false, NodeId(RandomString(NodeId::kSize)), asymm::GenerateKeyPair());
+  EXPECT_EQ(small_config.max_routing_table_size, small_table.kMaxSize());
+  EXPECT_EQ(Parameters::max_routing_table_size, default_table.kMaxSize());
+
+  std::vector<RoutingTableChange> changes;
+  small_table.InitialiseFunctors([&changes](const RoutingTableChange& routing_table_change) {
+    changes.push_back(routing_table_change);
+  });
+  for (int i(0); i != 100; ++i) {
+    NodeInfo node(MakeNode());
+    small_table.AddNode(node);
+    default_table.AddNode(node);
+  }
+  EXPECT_EQ(small_config.max_routing_table_size, small_table.size());
+  EXPECT_EQ(Parameters::max_routing_table_size, default_table.size());
+  size_t close_nodes_size(0);
+  for (const auto& change : changes) {
+    if (change.close_nodes_change)
+      close_nodes_size = change.close_nodes_change->new_close_nodes().size();
+  }
+  EXPECT_EQ(small_config.closest_nodes_size, close_nodes_size);
+}
+
+namespace {
+
+// Fills 'routing_table' with nodes sharing the bucket furthest from this node and returns those
+// beyond the interest range, ordered by distance.  Every one of these is nearby except the first,
+// and this node's own coordinate has been learnt from them.
+std::vector<NodeId> FillWithOneSlowMember(RoutingTable& routing_table) {
+  const std::string kRawNodeId(routing_table.kNodeId().string());
+  while (routing_table.size() < routing_table.kMaxSize()) {
+    NodeInfo node(MakeNode());
+    std::string raw_id(node.id.string());
+    raw_id[0] = static_cast<char>((raw_id[0] & 0x7F) | (~kRawNodeId[0] & 0x80));
+    node.id = NodeId(raw_id);
+    node.connection_id = node.id;
+    routing_table.AddNode(node);
+  }
+
+  auto nodes(routing_table.Snapshot()->nodes());
+  std::vector<NodeId> members;
+  for (size_t slot(routing_table.config().unidirectional_interest_range); slot < nodes.size();
+       ++slot) {
+    members.push_back(nodes[slot].id);
+  }
+  for (const auto& member : members) {
+    routing_table.SetCoordinates(member, member == members.front()
+                                             ? std::vector<int32_t>{ 900000, 0, 0, 100, 100 }
+                                             : std::vector<int32_t>{ 1000, 0, 0, 100, 100 });
+  }
+  for (int sample(0); sample != 20; ++sample)
+    routing_table.AddRttSample(members.back(), std::chrono::milliseconds(1));
+  return members;
+}
+
+// A node in the same bucket as 'member', a little closer to 'node_id'.
+NodeInfo MakeBucketmate(const NodeId& node_id, const NodeId& member) {
+  std::string raw_id(member.string());
+  const std::string kRawNodeId(node_id.string());
+  for (size_t index(NodeId::kSize); index-- != 0;) {
+    const unsigned char kDistance(static_cast<unsigned char>(raw_id[index] ^ kRawNodeId[index]));
+    if (kDistance != 0) {
+      raw_id[index] ^= static_cast<char>(kDistance & (~kDistance + 1));
+      break;
+    }
+  }
+  NodeInfo bucketmate(MakeNode());
+  bucketmate.id = NodeId(raw_id);
+  bucketmate.connection_id = bucketmate.id;
+  return bucketmate;
+}
+
+}  // unnamed namespace
+
+TEST(RoutingTableTest, BEH_EvictsSlowestNodeInBucket) {
+  RoutingConfig config;
+  config.max_routing_table_size = 12;
+  config.routing_table_size_threshold = 3;
+  config.closest_nodes_size = 2;
+  config.unidirectional_interest_range = 4;
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair(), config);
+  auto members(FillWithOneSlowMember(routing_table));
+  ASSERT_GE(members.size(), 2U);
+  // Coordinates are kept off the snapshot.
+  auto snapshot(routing_table.Snapshot());
+  routing_table.SetCoordinates(members.back(), std::vector<int32_t>{ 1000, 0, 0, 100, 100 });
+  EXPECT_EQ(snapshot, routing_table.Snapshot());
+  NodeId slow_node(members.front());
+  EXPECT_GT(routing_table.EstimateRtt(slow_node), routing_table.EstimateRtt(members.back()));
+
+  // A newcomer to the bucket expected to be slower still is refused.
+  NodeInfo bucketmate(MakeBucketmate(node_id, members.front()));
+  bucketmate.dimension_list = std::vector<int32_t>{ 2000000, 0, 0, 100, 100 };
+  EXPECT_FALSE(routing_table.AddNode(bucketmate));
+  EXPECT_TRUE(routing_table.Contains(slow_node));
+
+  // A faster one takes the slowest member's place.
+  bucketmate.dimension_list = std::vector<int32_t>{ 1000, 0, 0, 100, 100 };
+  EXPECT_TRUE(routing_table.AddNode(bucketmate));
+  EXPECT_EQ(routing_table.kMaxSize(), routing_table.size());
+  EXPECT_FALSE(routing_table.Contains(slow_node));
+  EXPECT_TRUE(routing_table.Contains(members.back()));
+  EXPECT_LT(routing_table.EstimateRtt(slow_node).count(), 0);
+}
+
+TEST(RoutingTableTest, BEH_SlowNodeForSparserBucketIsAdded) {
+  RoutingConfig config;
+  config.max_routing_table_size = 12;
+  config.routing_table_size_threshold = 3;
+  config.closest_nodes_size = 2;
+  config.unidirectional_interest_range = 4;
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair(), config);
+  auto members(FillWithOneSlowMember(routing_table));
+  ASSERT_GE(members.size(), 2U);
+
+  // Latency doesn't decide which buckets are kept: a slow node for the empty bucket closest to
+  // this node is taken, at the cost of the fullest bucket's furthest member.
+  NodeInfo close_node(MakeNode());
+  std::string close_id(node_id.string());
+  close_id[NodeId::kSize - 1] ^= 1;
+  close_node.id = NodeId(close_id);
+  close_node.connection_id = close_node.id;
+  close_node.dimension_list = std::vector<int32_t>{ 2000000, 0, 0, 100, 100 };
+  EXPECT_TRUE(routing_table.AddNode(close_node));
+  EXPECT_EQ(routing_table.kMaxSize(), routing_table.size());
+  EXPECT_TRUE(routing_table.Contains(members.front()));
+  EXPECT_FALSE(routing_table.Contains(members.back()));
+}
+
+TEST(RoutingTableTest, BEH_EstimateRtt) {
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
+  NodeInfo peer(MakeNode());
+  ASSERT_TRUE(routing_table.AddNode(peer));
+  EXPECT_LT(routing_table.EstimateRtt(NodeId(NodeId::IdType::kRandomId)).count(), 0);
+  EXPECT_LT(routing_table.EstimateRtt(peer.id).count(), 0);
+
+  // The peer's coordinate alone is not enough while this node's own is unknown.
+  routing_table.SetCoordinates(peer.id, std::vector<int32_t>{ 10000, 0, 0, 100, 100 });
+  EXPECT_LT(routing_table.EstimateRtt(peer.id).count(), 0);
+
+  for (int sample(0); sample != 20; ++sample)
+    routing_table.AddRttSample(peer.id, std::chrono::milliseconds(20));
+  auto rtt(routing_table.EstimateRtt(peer.id));
+  EXPECT_GT(rtt, std::chrono::milliseconds(10));
+  EXPECT_LT(rtt, std::chrono::milliseconds(30));
+}
+
+TEST(RoutingTableTest, BEH_AckTimeout) {
+  NodeId node_id(RandomString(NodeId::kSize));
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
+  const std::chrono::milliseconds kCeiling(
+      std::chrono::seconds(routing_table.config().ack_timeout));
+  NodeInfo peer(MakeNode());
+  NodeId stranger(NodeId::IdType::kRandomId);
+  ASSERT_TRUE(routing_table.AddNode(peer));
+  EXPECT_EQ(kCeiling, routing_table.AckTimeout(peer.id));
+
+  for (int sample(0); sample != 20; ++sample) {
+    routing_table.AddAckRttSample(peer.id, std::chrono::milliseconds(20));
+    routing_table.AddAckRttSample(stranger, std::chrono::milliseconds(20));
+  }
+  EXPECT_EQ(routing_table.config().min_ack_timeout, routing_table.AckTimeout(peer.id));
+  EXPECT_EQ(kCeiling, routing_table.AckTimeout(stranger));
+
+  // A dropped peer's estimate is forgotten.
+  routing_table.DropNode(peer.id, true);
+  EXPECT_EQ(kCeiling, routing_table.AckTimeout(peer.id));
+}
+
 }  // namespace test
 
 }  // namespace routing
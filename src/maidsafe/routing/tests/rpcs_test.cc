@@ -49,12 +49,12 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
 TEST(RpcsTest, BEH_PingMessageInitialised) {
   // check with assert in debug mode, should NEVER fail
   std::string destination = RandomString(64);
-  ASSERT_TRUE(rpcs::Ping(NodeId(destination), "me").IsInitialized());
+  ASSERT_TRUE(rpcs::Ping(RoutingConfig(), NodeId(destination), "me").IsInitialized());
 }
 
 TEST(RpcsTest, BEH_PingMessageNode) {
   std::string source(RandomString(64)), destination(RandomString(64));
-  protobuf::Message message = rpcs::Ping(NodeId(destination), source);
+  protobuf::Message message = rpcs::Ping(RoutingConfig(), NodeId(destination), source);
   protobuf::PingRequest ping_request;
   EXPECT_TRUE(ping_request.ParseFromString(message.data(0)));  // us
   EXPECT_TRUE(ping_request.ping());
@@ -77,8 +77,8 @@ TEST(RpcsTest, BEH_ConnectMessageInitialised) {
       Endpoint(boost::asio::ip::address_v4::loopback(), maidsafe::test::GetRandomPort());
   our_endpoint.external =
       Endpoint(boost::asio::ip::address_v4::loopback(), maidsafe::test::GetRandomPort());
-  ASSERT_TRUE(rpcs::Connect(NodeId(RandomString(64)), our_endpoint, NodeId(RandomString(64)),
-                            NodeId(RandomString(64))).IsInitialized());
+  ASSERT_TRUE(rpcs::Connect(RoutingConfig(), NodeId(RandomString(64)), our_endpoint,
+                            NodeId(RandomString(64)), NodeId(RandomString(64))).IsInitialized());
 }
 
 TEST(RpcsTest, BEH_ConnectMessageNode) {
@@ -89,7 +89,8 @@ TEST(RpcsTest, BEH_ConnectMessageNode) {
   endpoint.external =
       Endpoint(boost::asio::ip::address_v4::loopback(), maidsafe::test::GetRandomPort());
   std::string destination = RandomString(64);
-  protobuf::Message message = rpcs::Connect(NodeId(destination), endpoint, us.id, us.connection_id);
+  protobuf::Message message =
+      rpcs::Connect(RoutingConfig(), NodeId(destination), endpoint, us.id, us.connection_id);
   protobuf::ConnectRequest connect_request;
   EXPECT_TRUE(message.IsInitialized());
   EXPECT_TRUE(connect_request.ParseFromString(message.data(0)));  // us
@@ -118,8 +119,8 @@ TEST(RpcsTest, BEH_ConnectMessageNodeRelayMode) {
       Endpoint(boost::asio::ip::address_v4::loopback(), maidsafe::test::GetRandomPort());
   std::string destination = RandomString(64);
   protobuf::Message message =
-      rpcs::Connect(NodeId(destination), endpoint, us.id, us.connection_id, false,
-                    rudp::NatType::kUnknown, true, NodeId(destination));
+      rpcs::Connect(RoutingConfig(), NodeId(destination), endpoint, us.id, us.connection_id,
+                    false, rudp::NatType::kUnknown, true, NodeId(destination));
   protobuf::ConnectRequest connect_request;
   EXPECT_TRUE(message.IsInitialized());
   EXPECT_TRUE(connect_request.ParseFromString(message.data(0)));  // us
@@ -142,13 +143,15 @@ TEST(RpcsTest, BEH_ConnectMessageNodeRelayMode) {
 }
 
 TEST(RpcsTest, BEH_FindNodesMessageInitialised) {
-  ASSERT_TRUE(
-      rpcs::FindNodes(NodeId(RandomString(64)), NodeId(RandomString(64)), 8).IsInitialized());
+  ASSERT_TRUE(rpcs::FindNodes(RoutingConfig(), NodeId(RandomString(64)), NodeId(RandomString(64)),
+                              8).IsInitialized());
 }
 
 TEST(RpcsTest, BEH_FindNodesMessageNode) {
   NodeInfo us(MakeNode());
-  protobuf::Message message = rpcs::FindNodes(us.id, us.id, Parameters::closest_nodes_size);
+  RoutingConfig config;
+  config.hops_to_live = 7;
+  protobuf::Message message = rpcs::FindNodes(config, us.id, us.id, Parameters::closest_nodes_size);
   protobuf::FindNodesRequest find_nodes_request;
   EXPECT_TRUE(find_nodes_request.ParseFromString(message.data(0)));  // us
   EXPECT_EQ(static_cast<unsigned int>(find_nodes_request.num_nodes_requested()),
@@ -166,11 +169,13 @@ TEST(RpcsTest, BEH_FindNodesMessageNode) {
   EXPECT_TRUE(message.request());
   EXPECT_FALSE(message.client_node());
   EXPECT_FALSE(message.has_relay_id());
+  EXPECT_EQ(7, message.hops_to_live());
 }
 
 TEST(RpcsTest, BEH_FindNodesMessageNodeRelayMode) {
   NodeInfo us(MakeNode());
-  protobuf::Message message = rpcs::FindNodes(us.id, us.id, Parameters::closest_nodes_size, true,
+  protobuf::Message message = rpcs::FindNodes(RoutingConfig(), us.id, us.id,
+                                              Parameters::closest_nodes_size, true,
                                               NodeId(RandomString(NodeId::kSize)));
   protobuf::FindNodesRequest find_nodes_request;
   EXPECT_TRUE(find_nodes_request.ParseFromString(message.data(0)));  // us
@@ -0,0 +1,73 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/rtt_estimator.h"
+
+#include "maidsafe/common/test.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(RttEstimatorTest, BEH_FirstSample) {
+  RttEstimator estimator;
+  EXPECT_FALSE(estimator.HasSamples());
+  EXPECT_EQ(std::chrono::milliseconds(5000),
+            estimator.Timeout(std::chrono::milliseconds(200), std::chrono::milliseconds(5000)));
+  estimator.AddSample(std::chrono::milliseconds(100));
+  EXPECT_TRUE(estimator.HasSamples());
+  EXPECT_EQ(std::chrono::milliseconds(100), estimator.srtt());
+  EXPECT_EQ(std::chrono::milliseconds(50), estimator.rttvar());
+  EXPECT_EQ(std::chrono::milliseconds(300),
+            estimator.Timeout(std::chrono::milliseconds(200), std::chrono::milliseconds(5000)));
+  // Negative samples, e.g. from a clock change, are ignored.
+  estimator.AddSample(std::chrono::microseconds(-1));
+  EXPECT_EQ(std::chrono::milliseconds(100), estimator.srtt());
+}
+
+TEST(RttEstimatorTest, BEH_Smoothing) {
+  RttEstimator estimator;
+  estimator.AddSample(std::chrono::milliseconds(80));
+  estimator.AddSample(std::chrono::milliseconds(160));
+  // RTTVAR = 3/4 * 40 + 1/4 * 80, then SRTT = 7/8 * 80 + 1/8 * 160.
+  EXPECT_EQ(std::chrono::milliseconds(50), estimator.rttvar());
+  EXPECT_EQ(std::chrono::milliseconds(90), estimator.srtt());
+
+  for (int sample(0); sample != 100; ++sample)
+    estimator.AddSample(std::chrono::milliseconds(20));
+  EXPECT_LT(estimator.srtt(), std::chrono::milliseconds(21));
+  EXPECT_LT(estimator.rttvar(), std::chrono::milliseconds(1));
+}
+
+TEST(RttEstimatorTest, BEH_TimeoutBounds) {
+  RttEstimator estimator;
+  estimator.AddSample(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::chrono::milliseconds(200),
+            estimator.Timeout(std::chrono::milliseconds(200), std::chrono::milliseconds(5000)));
+  estimator.AddSample(std::chrono::seconds(20));
+  EXPECT_EQ(std::chrono::milliseconds(5000),
+            estimator.Timeout(std::chrono::milliseconds(200), std::chrono::milliseconds(5000)));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,288 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/outbound_message.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_config.h"
+#include "maidsafe/routing/send_coalescer.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+struct SentBatch {
+  NodeId peer_id;
+  std::string serialised;
+  rudp::MessageSentFunctor message_sent_functor;
+};
+
+// Records the sends a SendCoalescer makes in place of rudp.
+class SendRecorder {
+ public:
+  SendRecorder() : mutex_(), sends_() {}
+
+  SendCoalescer::Sender sender() {
+    return [this](const NodeId& peer_id, const std::string& serialised,
+                  const rudp::MessageSentFunctor& message_sent_functor) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sends_.push_back(SentBatch{peer_id, serialised, message_sent_functor});
+    };
+  }
+
+  std::vector<SentBatch> sends() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sends_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<SentBatch> sends_;
+};
+
+RoutingConfig CoalescingConfig(std::chrono::milliseconds window) {
+  RoutingConfig config;
+  config.coalescing_window = window;
+  config.max_coalesced_message_size = 1024;
+  config.max_batch_size = 4096;
+  return config;
+}
+
+protobuf::Message MakeMessage(const std::string& data) {
+  protobuf::Message message;
+  message.set_destination_id(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_routing_message(false);
+  message.add_data(data);
+  message.set_direct(true);
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(20);
+  return message;
+}
+
+}  // unnamed namespace
+
+TEST(SendCoalescerTest, BEH_CoalescesMessagesToSamePeer) {
+  BoostAsioService asio_service(1);
+  SendRecorder recorder;
+  SendCoalescer coalescer(asio_service, recorder.sender(),
+                          CoalescingConfig(std::chrono::milliseconds(50)));
+  NodeId peer_id(NodeId::IdType::kRandomId), other_peer_id(NodeId::IdType::kRandomId);
+  std::vector<protobuf::Message> messages;
+  std::vector<int> results;
+  std::mutex results_mutex;
+  for (int i(0); i != 3; ++i) {
+    messages.push_back(MakeMessage(RandomString(100)));
+    coalescer.Send(peer_id, messages.back().SerializeAsString(), [&, i](int result) {
+      std::lock_guard<std::mutex> lock(results_mutex);
+      results.push_back(result + i);
+    });
+  }
+  coalescer.Send(other_peer_id, MakeMessage("other").SerializeAsString(), nullptr);
+  EXPECT_EQ(4U, coalescer.waiting());
+  EXPECT_TRUE(recorder.sends().empty());
+
+  Sleep(std::chrono::milliseconds(250));
+  auto sends(recorder.sends());
+  ASSERT_EQ(2U, sends.size());
+  EXPECT_EQ(0U, coalescer.waiting());
+  auto sent_to_peer(sends[0].peer_id == peer_id ? sends[0] : sends[1]);
+  EXPECT_EQ(peer_id, sent_to_peer.peer_id);
+
+  // The batch parses as a MessageBatch, and unpacks to the messages in order.
+  protobuf::MessageBatch batch;
+  ASSERT_TRUE(batch.ParseFromString(sent_to_peer.serialised));
+  EXPECT_EQ(3, batch.messages_size());
+  auto received(ParseReceivedMessages(sent_to_peer.serialised));
+  ASSERT_EQ(3U, received.size());
+  for (size_t i(0); i != received.size(); ++i)
+    EXPECT_EQ(messages[i].SerializeAsString(), received[i]->SerializeAsString());
+
+  // Every message's functor gets the batch's result.
+  sent_to_peer.message_sent_functor(10);
+  std::lock_guard<std::mutex> lock(results_mutex);
+  EXPECT_EQ((std::vector<int>{10, 11, 12}), results);
+}
+
+TEST(SendCoalescerTest, BEH_SendsFullBatchAtOnce) {
+  BoostAsioService asio_service(1);
+  SendRecorder recorder;
+  auto config(CoalescingConfig(std::chrono::seconds(10)));
+  SendCoalescer coalescer(asio_service, recorder.sender(), config);
+  NodeId peer_id(NodeId::IdType::kRandomId);
+  const std::string kSerialised(MakeMessage(RandomString(900)).SerializeAsString());
+  size_t sent(0);
+  while (recorder.sends().empty()) {
+    coalescer.Send(peer_id, kSerialised, nullptr);
+    ASSERT_LE(++sent * kSerialised.size(), 2 * config.max_batch_size);
+  }
+  EXPECT_EQ(0U, coalescer.waiting());
+  auto sends(recorder.sends());
+  ASSERT_EQ(1U, sends.size());
+  EXPECT_GE(sends[0].serialised.size(), config.max_batch_size);
+  EXPECT_EQ(sent, ParseReceivedMessages(sends[0].serialised).size());
+}
+
+TEST(SendCoalescerTest, BEH_LargeMessagesSentAloneAfterWaitingBatch) {
+  BoostAsioService asio_service(1);
+  SendRecorder recorder;
+  auto config(CoalescingConfig(std::chrono::seconds(10)));
+  SendCoalescer coalescer(asio_service, recorder.sender(), config);
+  NodeId peer_id(NodeId::IdType::kRandomId);
+  const std::string kSmall(MakeMessage("small").SerializeAsString());
+  const std::string kLarge(MakeMessage(RandomString(2048)).SerializeAsString());
+  coalescer.Send(peer_id, kSmall, nullptr);
+  coalescer.Send(peer_id, kLarge, nullptr);
+  auto sends(recorder.sends());
+  ASSERT_EQ(2U, sends.size());
+  ASSERT_EQ(1U, ParseReceivedMessages(sends[0].serialised).size());
+  EXPECT_EQ(kSmall, ParseReceivedMessages(sends[0].serialised)[0]->SerializeAsString());
+  // The large message is sent as is, not framed in a batch.
+  EXPECT_EQ(kLarge, sends[1].serialised);
+  ASSERT_EQ(1U, ParseReceivedMessages(sends[1].serialised).size());
+}
+
+TEST(SendCoalescerTest, BEH_ZeroWindowDisablesCoalescing) {
+  BoostAsioService asio_service(1);
+  SendRecorder recorder;
+  SendCoalescer coalescer(asio_service, recorder.sender(),
+                          CoalescingConfig(std::chrono::milliseconds(0)));
+  const std::string kSerialised(MakeMessage("data").SerializeAsString());
+  coalescer.Send(NodeId(NodeId::IdType::kRandomId), kSerialised, nullptr);
+  auto sends(recorder.sends());
+  ASSERT_EQ(1U, sends.size());
+  EXPECT_EQ(kSerialised, sends[0].serialised);
+}
+
+TEST(SendCoalescerTest, BEH_ConcurrentSendsKeepOrderPerPeer) {
+  // Threads each send a mix of small and large messages to one peer; every thread's messages must
+  // reach the sender in the order that thread sent them, whether batched or sent alone.
+  BoostAsioService asio_service(1);
+  SendRecorder recorder;
+  auto config(CoalescingConfig(std::chrono::seconds(10)));
+  SendCoalescer coalescer(asio_service, recorder.sender(), config);
+  NodeId peer_id(NodeId::IdType::kRandomId);
+  const int kThreadCount(4), kMessageCount(500);
+  std::vector<std::thread> threads;
+  for (int thread_index(0); thread_index != kThreadCount; ++thread_index) {
+    threads.push_back(std::thread([&, thread_index] {
+      for (int index(0); index != kMessageCount; ++index) {
+        std::string data(std::to_string(thread_index) + ":" + std::to_string(index) + ":");
+        if (index % 3 == 0)
+          data += std::string(2048, 'x');
+        coalescer.Send(peer_id, MakeMessage(data).SerializeAsString(), nullptr);
+      }
+    }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+  coalescer.Flush(peer_id);
+
+  std::vector<int> next_index(kThreadCount, 0);
+  for (const auto& send : recorder.sends()) {
+    for (const auto& message : ParseReceivedMessages(send.serialised)) {
+      const std::string& data(message->data(0));
+      const size_t kFirst(data.find(':')), kSecond(data.find(':', kFirst + 1));
+      const int kThreadIndex(std::stoi(data.substr(0, kFirst)));
+      EXPECT_EQ(next_index[kThreadIndex]++,
+                std::stoi(data.substr(kFirst + 1, kSecond - kFirst - 1)));
+    }
+  }
+  for (int count : next_index)
+    EXPECT_EQ(kMessageCount, count);
+}
+
+TEST(SendCoalescerTest, BEH_DestructionDropsWaitingBatches) {
+  BoostAsioService asio_service(1);
+  SendRecorder recorder;
+  {
+    SendCoalescer coalescer(asio_service, recorder.sender(),
+                            CoalescingConfig(std::chrono::milliseconds(50)));
+    coalescer.Send(NodeId(NodeId::IdType::kRandomId), MakeMessage("data").SerializeAsString(),
+                   nullptr);
+  }
+  Sleep(std::chrono::milliseconds(200));
+  EXPECT_TRUE(recorder.sends().empty());
+}
+
+TEST(SendCoalescerTest, BEH_SendsMessageGivenInTwoParts) {
+  BoostAsioService asio_service(1);
+  NodeId peer_id(NodeId::IdType::kRandomId);
+  protobuf::Message message(MakeMessage(RandomString(100)));
+  message.add_route_history(NodeId(NodeId::IdType::kRandomId).string());
+  const OutboundMessage kOutbound(message);
+  ASSERT_FALSE(kOutbound.hop_fields().empty());
+
+  // Batched, the parts are framed as one entry.
+  SendRecorder batch_recorder;
+  SendCoalescer coalescer(asio_service, batch_recorder.sender(),
+                          CoalescingConfig(std::chrono::milliseconds(50)));
+  coalescer.Send(peer_id, kOutbound.body(), kOutbound.hop_fields(), nullptr);
+  coalescer.Send(peer_id, MakeMessage("other").SerializeAsString(), nullptr);
+  coalescer.Flush(peer_id);
+  auto sends(batch_recorder.sends());
+  ASSERT_EQ(1U, sends.size());
+  auto received(ParseReceivedMessages(sends[0].serialised));
+  ASSERT_EQ(2U, received.size());
+  EXPECT_EQ(message.SerializeAsString(), received[0]->SerializeAsString());
+
+  // Sent alone, the parts are joined.
+  SendRecorder alone_recorder;
+  SendCoalescer uncoalesced(asio_service, alone_recorder.sender(),
+                            CoalescingConfig(std::chrono::milliseconds(0)));
+  uncoalesced.Send(peer_id, kOutbound.body(), kOutbound.hop_fields(), nullptr);
+  sends = alone_recorder.sends();
+  ASSERT_EQ(1U, sends.size());
+  received = ParseReceivedMessages(sends[0].serialised);
+  ASSERT_EQ(1U, received.size());
+  EXPECT_EQ(message.SerializeAsString(), received[0]->SerializeAsString());
+}
+
+TEST(SendCoalescerTest, BEH_MalformedBatchKeepsParsedMessages) {
+  const std::string kFirst(MakeMessage("first").SerializeAsString());
+  std::string batch;
+  AppendToMessageBatch(kFirst, batch);
+  AppendToMessageBatch(MakeMessage("second").SerializeAsString(), batch);
+  batch.resize(batch.size() - 3);
+  auto received(ParseReceivedMessages(batch));
+  ASSERT_EQ(1U, received.size());
+  EXPECT_EQ(kFirst, received[0]->SerializeAsString());
+  EXPECT_TRUE(ParseReceivedMessages("garbage").empty());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
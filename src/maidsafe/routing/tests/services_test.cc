@@ -16,6 +16,7 @@
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -26,6 +27,7 @@
 #include "maidsafe/rudp/managed_connections.h"
 
 #include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/close_nodes_change.h"
 #include "maidsafe/routing/network_statistics.h"
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/parameters.h"
@@ -46,6 +48,54 @@ namespace {
 
 typedef boost::asio::ip::udp::endpoint Endpoint;
 
+// The parts of one node which handle a message, all tuned by 'config'.
+struct ServiceStack {
+  ServiceStack(const RoutingConfig& config, BoostAsioService& asio_service)
+      : node_id(RandomString(NodeId::kSize)),
+        routing_table(false, node_id, asymm::GenerateKeyPair(), config),
+        client_routing_table(node_id),
+        acknowledgement(node_id, asio_service, config),
+        network(routing_table, client_routing_table, acknowledgement, asio_service),
+        public_key_holder(asio_service, network),
+        service(routing_table, client_routing_table, network, public_key_holder),
+        close_nodes_change() {
+    routing_table.InitialiseFunctors([this](const RoutingTableChange& routing_table_change) {
+      if (routing_table_change.close_nodes_change)
+        close_nodes_change = routing_table_change.close_nodes_change;
+    });
+  }
+
+  NodeId node_id;
+  RoutingTable routing_table;
+  ClientRoutingTable client_routing_table;
+  Acknowledgement acknowledgement;
+  Network network;
+  PublicKeyHolder public_key_holder;
+  Service service;
+  std::shared_ptr<CloseNodesChange> close_nodes_change;
+};
+
+void CheckGroup(ServiceStack& stack, const NodeId& target) {
+  const RoutingConfig& config(stack.routing_table.config());
+  ASSERT_TRUE(stack.close_nodes_change != nullptr);
+  auto close_nodes(stack.close_nodes_change->new_close_nodes());
+  EXPECT_EQ(config.closest_nodes_size, close_nodes.size());
+  EXPECT_EQ(config.group_size, static_cast<unsigned int>(std::count_if(
+                                   std::begin(close_nodes), std::end(close_nodes),
+                                   [&](const NodeId& node_id) {
+                                     return stack.close_nodes_change->CheckIsHolder(target,
+                                                                                    node_id);
+                                   })));
+
+  protobuf::Message message(rpcs::GetGroup(config, target, NodeId(NodeId::IdType::kRandomId)));
+  EXPECT_EQ(config.hops_to_live, static_cast<unsigned int>(message.hops_to_live()));
+  stack.service.GetGroup(message);
+  protobuf::GetGroup get_group;
+  ASSERT_TRUE(get_group.ParseFromString(message.data(0)));
+  EXPECT_EQ(config.group_size, static_cast<unsigned int>(get_group.group_nodes_id_size()));
+  EXPECT_EQ(config.hops_to_live, static_cast<unsigned int>(message.hops_to_live()));
+}
+
 }  // unnamed namespace
 
 TEST(ServicesTest, BEH_Ping) {
@@ -54,14 +104,14 @@ TEST(ServicesTest, BEH_Ping) {
   ClientRoutingTable client_routing_table(routing_table.kNodeId());
   BoostAsioService asio_service(1);
   Acknowledgement acknowledgement(node_id, asio_service);
-  Network network(routing_table, client_routing_table, acknowledgement);
+  Network network(routing_table, client_routing_table, acknowledgement, asio_service);
   PublicKeyHolder public_key_holder(asio_service, network);
   Service service(routing_table, client_routing_table, network, public_key_holder);
   NodeInfo node;
   rudp::ManagedConnections rudp;
   protobuf::PingRequest ping_request;
   // somebody pings us
-  protobuf::Message message = rpcs::Ping(routing_table.kNodeId(), "me");
+  protobuf::Message message = rpcs::Ping(routing_table.config(), routing_table.kNodeId(), "me");
   EXPECT_EQ(message.destination_id(), routing_table.kNodeId().string());
   EXPECT_TRUE(ping_request.ParseFromString(message.data(0)));  // us
   EXPECT_TRUE(ping_request.IsInitialized());
@@ -86,10 +136,11 @@ TEST(ServicesTest, BEH_FindNodes) {
   ClientRoutingTable client_routing_table(routing_table.kNodeId());
   BoostAsioService asio_service(1);
   Acknowledgement acknowledgement(node_id, asio_service);
-  Network network(routing_table, client_routing_table, acknowledgement);
+  Network network(routing_table, client_routing_table, acknowledgement, asio_service);
   PublicKeyHolder public_key_holder(asio_service, network);
   Service service(routing_table, client_routing_table, network, public_key_holder);
-  protobuf::Message message = rpcs::FindNodes(this_node_id, this_node_id, 8);
+  protobuf::Message message =
+      rpcs::FindNodes(routing_table.config(), this_node_id, this_node_id, 8);
   service.FindNodes(message);
   protobuf::FindNodesResponse find_nodes_respose;
   EXPECT_TRUE(find_nodes_respose.ParseFromString(message.data(0)));
@@ -110,6 +161,28 @@ TEST(ServicesTest, BEH_FindNodes) {
   // EXPECT_FALSE(message.has_relay());
 }
 
+TEST(ServicesTest, BEH_PerInstanceConfig) {
+  RoutingConfig small_config;
+  small_config.closest_nodes_size = 4;
+  small_config.group_size = 2;
+  small_config.hops_to_live = 10;
+  RoutingConfig large_config;
+  large_config.closest_nodes_size = 12;
+  large_config.group_size = 6;
+  large_config.hops_to_live = 20;
+  BoostAsioService asio_service(1);
+  ServiceStack small_stack(small_config, asio_service), large_stack(large_config, asio_service);
+  for (int i(0); i != 30; ++i) {
+    NodeInfo node(MakeNode());
+    small_stack.routing_table.AddNode(node);
+    large_stack.routing_table.AddNode(node);
+  }
+
+  NodeId target(NodeId::IdType::kRandomId);
+  CheckGroup(small_stack, target);
+  CheckGroup(large_stack, target);
+}
+
 // TEST(ServicesTest, BEH_ProxyConnect) {
 //   asymm::Keys my_keys;
 //   my_keys.identity = RandomString(64);
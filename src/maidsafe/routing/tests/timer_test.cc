@@ -19,6 +19,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <future>
 #include <iterator>
 #include <map>
 #include <mutex>
@@ -245,6 +246,126 @@ TEST_F(TimerTest, BEH_CancelTask) {
   EXPECT_EQ(failed_response_count_, kGroupSize_ - 1);
 }
 
+TEST_F(TimerTest, BEH_QuorumInvalidParameters) {
+  EXPECT_THROW(timer_.AddQuorumTask(std::chrono::seconds(1), nullptr, 4, 3, nullptr,
+                                    timer_.NewTaskId()),
+               maidsafe_error);
+  EXPECT_THROW(timer_.AddQuorumTask(std::chrono::seconds(1), pass_response_functor_, 4, 0,
+                                    nullptr, timer_.NewTaskId()),
+               maidsafe_error);
+  EXPECT_THROW(timer_.AddQuorumTask(std::chrono::seconds(1), pass_response_functor_, 4, 5,
+                                    nullptr, timer_.NewTaskId()),
+               maidsafe_error);
+}
+
+TEST_F(TimerTest, BEH_QuorumReached) {
+  const std::string kOther(RandomAlphaNumericString(30));
+  pass_response_functor_ = [=](std::string response) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++pass_response_count_;
+    }
+    ASSERT_EQ(response, message_);
+    cond_var_.notify_one();
+  };
+  auto task_id(timer_.NewTaskId());
+  timer_.AddQuorumTask(std::chrono::seconds(10), pass_response_functor_, kGroupSize_, 2, nullptr,
+                       task_id);
+  timer_.AddResponse(task_id, message_);
+  timer_.AddResponse(task_id, kOther);
+  timer_.AddResponse(task_id, message_);
+  // The task is finished on reaching quorum, so a later response doesn't invoke the functor.
+  try {
+    timer_.AddResponse(task_id, message_);
+  }
+  catch (const maidsafe_error&) {}
+  std::unique_lock<std::mutex> lock(mutex_);
+  EXPECT_TRUE(cond_var_.wait_for(lock, std::chrono::seconds(2),
+                                 [&] { return pass_response_count_ == 1U; }));
+  EXPECT_FALSE(cond_var_.wait_for(lock, std::chrono::milliseconds(100),
+                                  [&] { return pass_response_count_ > 1U; }));
+  EXPECT_EQ(failed_response_count_, 0U);
+}
+
+TEST_F(TimerTest, BEH_QuorumMatchFunctor) {
+  // Responses agree if their first characters do.
+  auto match([](const std::string& lhs, const std::string& rhs) { return lhs[0] == rhs[0]; });
+  auto task_id(timer_.NewTaskId());
+  timer_.AddQuorumTask(std::chrono::seconds(10), pass_response_functor_, 4, 3, match, task_id);
+  timer_.AddResponse(task_id, "a1");
+  timer_.AddResponse(task_id, "a2");
+  timer_.AddResponse(task_id, "b1");
+  timer_.AddResponse(task_id, "a3");
+  std::unique_lock<std::mutex> lock(mutex_);
+  EXPECT_TRUE(cond_var_.wait_for(lock, std::chrono::seconds(2),
+                                 [&] { return pass_response_count_ == 1U; }));
+}
+
+TEST_F(TimerTest, BEH_QuorumUnreachable) {
+  auto task_id(timer_.NewTaskId());
+  timer_.AddQuorumTask(std::chrono::seconds(10), failed_response_functor_, 4, 3, nullptr,
+                       task_id);
+  timer_.AddResponse(task_id, "a");
+  timer_.AddResponse(task_id, "b");
+  // A third distinct response leaves at most two which could agree.
+  timer_.AddResponse(task_id, "c");
+  std::unique_lock<std::mutex> lock(mutex_);
+  EXPECT_TRUE(cond_var_.wait_for(lock, std::chrono::seconds(2),
+                                 [&] { return failed_response_count_ == 1U; }));
+  EXPECT_EQ(pass_response_count_, 0U);
+}
+
+TEST_F(TimerTest, BEH_QuorumTimedOut) {
+  auto task_id(timer_.NewTaskId());
+  timer_.AddQuorumTask(std::chrono::milliseconds(100), failed_response_functor_, kGroupSize_, 2,
+                       nullptr, task_id);
+  timer_.AddResponse(task_id, message_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  EXPECT_TRUE(cond_var_.wait_for(lock, std::chrono::milliseconds(500),
+                                 [&] { return failed_response_count_ == 1U; }));
+  // Only one failure is reported however many responses were outstanding.
+  EXPECT_FALSE(cond_var_.wait_for(lock, std::chrono::milliseconds(100),
+                                  [&] { return failed_response_count_ > 1U; }));
+  EXPECT_EQ(pass_response_count_, 0U);
+}
+
+TEST_F(TimerTest, BEH_FutureResponse) {
+  auto task_id(timer_.NewTaskId());
+  auto future(timer_.AddTask(std::chrono::seconds(10), task_id));
+  timer_.AddResponse(task_id, message_);
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(2)));
+  EXPECT_EQ(message_, future.get());
+}
+
+TEST_F(TimerTest, BEH_FutureTimedOut) {
+  auto future(timer_.AddTask(std::chrono::milliseconds(100), timer_.NewTaskId()));
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(2)));
+  EXPECT_TRUE(future.get().empty());
+}
+
+TEST_F(TimerTest, BEH_FutureCancelTask) {
+  auto task_id(timer_.NewTaskId());
+  auto future(timer_.AddQuorumTask(std::chrono::seconds(10), kGroupSize_, 2, nullptr, task_id));
+  timer_.AddResponse(task_id, message_);
+  timer_.CancelTask(task_id);
+  // The future is set by CancelTask itself.
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(0)));
+  EXPECT_TRUE(future.get().empty());
+}
+
+TEST_F(TimerTest, BEH_FutureQuorum) {
+  EXPECT_THROW(timer_.AddQuorumTask(std::chrono::seconds(1), 4, 5, nullptr, timer_.NewTaskId()),
+               maidsafe_error);
+  auto task_id(timer_.NewTaskId());
+  auto future(timer_.AddQuorumTask(std::chrono::seconds(10), kGroupSize_, 2, nullptr, task_id));
+  timer_.AddResponse(task_id, message_);
+  timer_.AddResponse(task_id, RandomAlphaNumericString(30));
+  EXPECT_EQ(std::future_status::timeout, future.wait_for(std::chrono::seconds(0)));
+  timer_.AddResponse(task_id, message_);
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(message_, future.get());
+}
+
 struct MessageDetails {
   MessageDetails()
       : message(RandomAlphaNumericString(30)),
@@ -0,0 +1,196 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/timing_wheel.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "boost/asio/error.hpp"
+#include "boost/asio/steady_timer.hpp"
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// Records, for each handler invoked, its index, the error it was given and when it ran.
+struct Recorder {
+  struct Call {
+    int index;
+    boost::system::error_code error;
+    std::chrono::steady_clock::time_point time;
+  };
+
+  TimingWheel::Handler Handler(int index) {
+    return [this, index](const boost::system::error_code& error) {
+      std::lock_guard<std::mutex> lock(mutex);
+      calls.push_back(Call{ index, error, std::chrono::steady_clock::now() });
+      cond_var.notify_one();
+    };
+  }
+
+  bool WaitFor(size_t count, std::chrono::seconds timeout = std::chrono::seconds(10)) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cond_var.wait_for(lock, timeout, [&] { return calls.size() >= count; });
+  }
+
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  std::vector<Call> calls;
+};
+
+}  // unnamed namespace
+
+TEST(TimingWheelTest, BEH_InvalidParameters) {
+  BoostAsioService asio_service(1);
+  TimingWheel timing_wheel(asio_service);
+  EXPECT_THROW(timing_wheel.Schedule(std::chrono::milliseconds(1), nullptr), std::exception);
+  EXPECT_FALSE(timing_wheel.Cancel(0));
+  asio_service.Stop();
+}
+
+TEST(TimingWheelTest, BEH_FiresInDeadlineOrder) {
+  BoostAsioService asio_service(2);
+  TimingWheel timing_wheel(asio_service);
+  Recorder recorder;
+  // Spans the first two levels of the wheel, and a deadline already passed.
+  const std::vector<std::chrono::milliseconds> kDelays{
+      std::chrono::milliseconds(300), std::chrono::milliseconds(5), std::chrono::milliseconds(70),
+      std::chrono::milliseconds(0), std::chrono::milliseconds(30) };
+  const auto kStart(std::chrono::steady_clock::now());
+  for (size_t index(0); index != kDelays.size(); ++index)
+    timing_wheel.Schedule(kDelays[index], recorder.Handler(static_cast<int>(index)));
+  EXPECT_EQ(kDelays.size(), timing_wheel.size());
+  ASSERT_TRUE(recorder.WaitFor(kDelays.size()));
+
+  std::vector<int> expected_order{ 3, 1, 4, 2, 0 };
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  for (size_t index(0); index != expected_order.size(); ++index) {
+    const auto& call(recorder.calls[index]);
+    EXPECT_EQ(expected_order[index], call.index);
+    EXPECT_FALSE(call.error);
+    EXPECT_GE(call.time - kStart, kDelays[call.index]);
+    EXPECT_LT(call.time - kStart, kDelays[call.index] + std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(0U, timing_wheel.size());
+  asio_service.Stop();
+}
+
+TEST(TimingWheelTest, BEH_Cascade) {
+  // With 1us ticks the deadlines sit in the upper levels and are cascaded down several times.
+  BoostAsioService asio_service(1);
+  TimingWheel timing_wheel(asio_service, std::chrono::microseconds(1));
+  Recorder recorder;
+  const auto kStart(std::chrono::steady_clock::now());
+  timing_wheel.Schedule(std::chrono::milliseconds(300), recorder.Handler(0));
+  timing_wheel.Schedule(std::chrono::milliseconds(20), recorder.Handler(1));
+  ASSERT_TRUE(recorder.WaitFor(2));
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  EXPECT_EQ(1, recorder.calls[0].index);
+  EXPECT_EQ(0, recorder.calls[1].index);
+  EXPECT_GE(recorder.calls[0].time - kStart, std::chrono::milliseconds(20));
+  EXPECT_GE(recorder.calls[1].time - kStart, std::chrono::milliseconds(300));
+  asio_service.Stop();
+}
+
+TEST(TimingWheelTest, BEH_Cancel) {
+  BoostAsioService asio_service(2);
+  TimingWheel timing_wheel(asio_service);
+  Recorder recorder;
+  auto cancelled(timing_wheel.Schedule(std::chrono::seconds(5), recorder.Handler(0)));
+  auto fired(timing_wheel.Schedule(std::chrono::milliseconds(10), recorder.Handler(1)));
+  EXPECT_TRUE(timing_wheel.Cancel(cancelled));
+  EXPECT_FALSE(timing_wheel.Cancel(cancelled));
+  ASSERT_TRUE(recorder.WaitFor(2));
+  EXPECT_FALSE(timing_wheel.Cancel(fired));
+
+  // Those left when CancelAll is called are all cancelled.
+  for (int index(2); index != 5; ++index)
+    timing_wheel.Schedule(std::chrono::seconds(index), recorder.Handler(index));
+  timing_wheel.CancelAll();
+  EXPECT_EQ(0U, timing_wheel.size());
+  ASSERT_TRUE(recorder.WaitFor(5));
+
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  for (const auto& call : recorder.calls) {
+    if (call.index == 1)
+      EXPECT_FALSE(call.error);
+    else
+      EXPECT_EQ(boost::asio::error::operation_aborted, call.error);
+  }
+  asio_service.Stop();
+}
+
+TEST(TimingWheelTest, FUNC_ScheduleAndCancelCost) {
+  // Compares the cost of scheduling then cancelling a deadline, as for an ack which arrives in
+  // time, on the wheel and on an asio timer of its own.
+  BoostAsioService asio_service(2);
+  TimingWheel timing_wheel(asio_service);
+  const int kDeadlines(100000);
+  auto handler([](const boost::system::error_code&) {});
+
+  auto start(std::chrono::steady_clock::now());
+  std::vector<std::unique_ptr<boost::asio::steady_timer>> timers;
+  timers.reserve(kDeadlines);
+  for (int index(0); index != kDeadlines; ++index) {
+    timers.emplace_back(new boost::asio::steady_timer(asio_service.service(),
+                                                      std::chrono::seconds(5 + index % 20)));
+    timers.back()->async_wait(handler);
+  }
+  for (auto& timer : timers)
+    timer->cancel();
+  timers.clear();
+  const auto kAsioCost(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  std::vector<TimingWheel::TimerId> timer_ids;
+  timer_ids.reserve(kDeadlines);
+  for (int index(0); index != kDeadlines; ++index)
+    timer_ids.push_back(timing_wheel.Schedule(std::chrono::seconds(5 + index % 20), handler));
+  for (const auto& timer_id : timer_ids)
+    EXPECT_TRUE(timing_wheel.Cancel(timer_id));
+  const auto kWheelCost(std::chrono::steady_clock::now() - start);
+
+  std::cout << "Per deadline scheduled and cancelled - asio timer: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(kAsioCost).count() /
+                   kDeadlines
+            << "ns;  timing wheel: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(kWheelCost).count() /
+                   kDeadlines
+            << "ns\n";
+  EXPECT_EQ(0U, timing_wheel.size());
+  asio_service.Stop();
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,313 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/timing_wheel.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "boost/asio/error.hpp"
+#include "boost/asio/steady_timer.hpp"
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// Four levels of 64 slots: with 1ms ticks, level 0 spans 64ms and level 3 over four and a half
+// hours.  Later deadlines wait in the last level and are placed again as it is cascaded.
+const unsigned int kSlotBits(6);
+const uint64_t kSlots(uint64_t(1) << kSlotBits);
+const uint64_t kSlotMask(kSlots - 1);
+const unsigned int kLevels(4);
+const uint64_t kSpan(uint64_t(1) << (kSlotBits * kLevels));
+const uint32_t kNone(~uint32_t(0));
+
+// Invokes a cancelled timer's handler, moved rather than copied into asio's queue.
+struct Aborted {
+  explicit Aborted(TimingWheel::Handler handler_in) : handler(std::move(handler_in)) {}
+  void operator()() const {
+    handler(boost::system::error_code(boost::asio::error::operation_aborted));
+  }
+  TimingWheel::Handler handler;
+};
+
+}  // unnamed namespace
+
+// Entries live in a pool reused as timers come and go, each slot being a doubly linked list of
+// pool indices, so neither scheduling nor cancelling allocates once the pool has grown.  A
+// TimerId holds the entry's index and its generation, which changes whenever the entry is reused.
+struct TimingWheel::State {
+  struct Entry {
+    Entry() : expiry(0), generation(0), slot(kNone), previous(kNone), next(kNone), handler() {}
+    uint64_t expiry;  // tick
+    uint32_t generation;
+    uint32_t slot;  // level * kSlots + index, or kNone while free
+    uint32_t previous, next;
+    Handler handler;
+  };
+
+  State(boost::asio::io_service& io_service, std::chrono::steady_clock::duration resolution)
+      : mutex(), timer(io_service), kStart(std::chrono::steady_clock::now()),
+        kResolution(std::max(resolution, std::chrono::steady_clock::duration(1))), entries(),
+        free_entries(), heads(), level_sizes(), size(0), current_tick(0), armed_tick(0),
+        armed(false) {
+    heads.fill(kNone);
+    level_sizes.fill(0);
+  }
+
+  uint64_t NowTick() const {
+    return static_cast<uint64_t>((std::chrono::steady_clock::now() - kStart) / kResolution);
+  }
+
+  static TimerId MakeId(uint32_t index, uint32_t generation) {
+    return (static_cast<TimerId>(generation) << 32) | (index + 1);
+  }
+
+  // The index of the pending entry 'timer_id' refers to, or kNone.
+  uint32_t Find(TimerId timer_id) const {
+    uint32_t index(static_cast<uint32_t>(timer_id & 0xFFFFFFFF) - 1);
+    if (index >= entries.size() || entries[index].slot == kNone ||
+        entries[index].generation != static_cast<uint32_t>(timer_id >> 32)) {
+      return kNone;
+    }
+    return index;
+  }
+
+  uint32_t Allocate() {
+    if (free_entries.empty()) {
+      entries.emplace_back();
+      return static_cast<uint32_t>(entries.size() - 1);
+    }
+    uint32_t index(free_entries.back());
+    free_entries.pop_back();
+    return index;
+  }
+
+  void Unlink(uint32_t index) {
+    Entry& entry(entries[index]);
+    if (entry.previous == kNone)
+      heads[entry.slot] = entry.next;
+    else
+      entries[entry.previous].next = entry.next;
+    if (entry.next != kNone)
+      entries[entry.next].previous = entry.previous;
+    --level_sizes[entry.slot / kSlots];
+    entry.slot = entry.previous = entry.next = kNone;
+  }
+
+  // Frees the unlinked entry 'index', returning its handler.
+  Handler Release(uint32_t index) {
+    Entry& entry(entries[index]);
+    Handler handler(std::move(entry.handler));
+    entry.handler = nullptr;
+    ++entry.generation;
+    free_entries.push_back(index);
+    --size;
+    return handler;
+  }
+
+  // Links the unlinked entry 'index' into the slot for its expiry, relative to current_tick.
+  void Place(uint32_t index) {
+    Entry& entry(entries[index]);
+    uint64_t delta(entry.expiry - current_tick);
+    uint64_t slot_tick(delta < kSpan ? entry.expiry : current_tick + kSpan - 1);
+    delta = std::min(delta, kSpan - 1);
+    unsigned int level(0);
+    while (level + 1 < kLevels && delta >= (uint64_t(1) << (kSlotBits * (level + 1))))
+      ++level;
+    entry.slot = static_cast<uint32_t>(level * kSlots +
+                                       ((slot_tick >> (kSlotBits * level)) & kSlotMask));
+    entry.previous = kNone;
+    entry.next = heads[entry.slot];
+    if (entry.next != kNone)
+      entries[entry.next].previous = index;
+    heads[entry.slot] = index;
+    ++level_sizes[level];
+  }
+
+  // Handles 'tick': cascades the higher levels at their boundaries, then releases the entries due,
+  // appending their handlers to 'expired'.
+  void ProcessTick(uint64_t tick, std::vector<Handler>& expired) {
+    current_tick = tick;
+    for (unsigned int level(1); level != kLevels; ++level) {
+      if ((tick & ((uint64_t(1) << (kSlotBits * level)) - 1)) != 0)
+        break;
+      uint32_t index(heads[level * kSlots + ((tick >> (kSlotBits * level)) & kSlotMask)]);
+      while (index != kNone) {
+        uint32_t next(entries[index].next);
+        Unlink(index);
+        Place(index);
+        index = next;
+      }
+    }
+    uint32_t index(heads[tick & kSlotMask]);
+    while (index != kNone) {
+      uint32_t next(entries[index].next);
+      Unlink(index);
+      expired.push_back(Release(index));
+      index = next;
+    }
+  }
+
+  // The earliest tick at which the wheel has work: a due level 0 slot or a cascade.
+  bool NextTick(uint64_t& next) const {
+    if (size == 0)
+      return false;
+    next = current_tick + kSlots;
+    if (level_sizes[0] != 0) {
+      for (uint64_t tick(current_tick); tick != current_tick + kSlots; ++tick) {
+        if (heads[tick & kSlotMask] != kNone) {
+          next = tick;
+          break;
+        }
+      }
+    }
+    if (size != level_sizes[0])
+      next = std::min(next, (current_tick + kSlotMask) & ~kSlotMask);
+    return true;
+  }
+
+  // Sets the asio timer for NextTick unless it is already set no later.  'self' refers to this.
+  void Arm(std::weak_ptr<State> self) {
+    uint64_t next(0);
+    if (!NextTick(next) || (armed && armed_tick <= next))
+      return;
+    armed = true;
+    armed_tick = next;
+    timer.expires_at(kStart + kResolution * static_cast<int64_t>(next));
+    timer.async_wait([self](const boost::system::error_code& error) {
+      if (error != boost::asio::error::operation_aborted)
+        TimingWheel::Advance(self);
+    });
+  }
+
+  std::mutex mutex;
+  boost::asio::steady_timer timer;
+  const std::chrono::steady_clock::time_point kStart;
+  const std::chrono::steady_clock::duration kResolution;
+  std::vector<Entry> entries;
+  std::vector<uint32_t> free_entries;
+  std::array<uint32_t, kLevels * kSlots> heads;
+  std::array<size_t, kLevels> level_sizes;
+  size_t size;
+  uint64_t current_tick;  // the next tick to be processed
+  uint64_t armed_tick;
+  bool armed;
+};
+
+TimingWheel::TimingWheel(BoostAsioService& asio_service,
+                         std::chrono::steady_clock::duration resolution)
+    : asio_service_(asio_service),
+      state_(std::make_shared<State>(asio_service.service(), resolution)) {}
+
+TimingWheel::~TimingWheel() {
+  CancelAll();
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->timer.cancel();
+}
+
+TimingWheel::TimerId TimingWheel::Schedule(const std::chrono::steady_clock::duration& timeout,
+                                           Handler handler) {
+  if (!handler) {
+    LOG(kError) << "TimingWheel::Schedule handler not initialised";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  // While the wheel is empty there is nothing to process, so it can skip straight to now.
+  if (state_->size == 0)
+    state_->current_tick = std::max(state_->current_tick, state_->NowTick());
+  const auto kDeadline((std::chrono::steady_clock::now() - state_->kStart) + timeout);
+  uint64_t expiry(0);
+  if (kDeadline.count() > 0) {
+    expiry = static_cast<uint64_t>(
+        (kDeadline + state_->kResolution - std::chrono::steady_clock::duration(1)) /
+        state_->kResolution);
+  }
+  uint32_t index(state_->Allocate());
+  State::Entry& entry(state_->entries[index]);
+  entry.expiry = std::max(expiry, state_->current_tick);
+  entry.handler = std::move(handler);
+  ++state_->size;
+  state_->Place(index);
+  state_->Arm(state_);
+  return State::MakeId(index, entry.generation);
+}
+
+bool TimingWheel::Cancel(TimerId timer_id) {
+  Handler handler;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    uint32_t index(state_->Find(timer_id));
+    if (index == kNone)
+      return false;
+    state_->Unlink(index);
+    handler = state_->Release(index);
+  }
+  asio_service_.service().post(Aborted(std::move(handler)));
+  return true;
+}
+
+void TimingWheel::CancelAll() {
+  std::vector<Handler> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    for (uint32_t index(0); index != state_->entries.size(); ++index) {
+      if (state_->entries[index].slot != kNone) {
+        state_->Unlink(index);
+        cancelled.push_back(state_->Release(index));
+      }
+    }
+  }
+  for (auto& handler : cancelled)
+    asio_service_.service().post(Aborted(std::move(handler)));
+}
+
+size_t TimingWheel::size() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->size;
+}
+
+void TimingWheel::Advance(std::weak_ptr<State> weak_state) {
+  auto state(weak_state.lock());
+  if (!state)
+    return;
+  std::vector<Handler> expired;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->armed = false;
+    const uint64_t kNow(state->NowTick());
+    for (uint64_t tick(state->current_tick); tick <= kNow && state->size != 0; ++tick)
+      state->ProcessTick(tick, expired);
+    state->current_tick = std::max(state->current_tick, kNow + 1);
+    state->Arm(weak_state);
+  }
+  for (const auto& handler : expired)
+    handler(boost::system::error_code());
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
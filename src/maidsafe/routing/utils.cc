@@ -46,11 +46,46 @@ namespace maidsafe {
 
 namespace routing {
 
-int AddToRudp(Network& network, const NodeId& this_node_id, const NodeId& this_connection_id,
-              const NodeId& peer_id, const NodeId& peer_connection_id,
-              rudp::EndpointPair peer_endpoint_pair, bool requestor, bool client) {
-  protobuf::Message connect_success(
-      rpcs::ConnectSuccess(peer_id, this_node_id, this_connection_id, requestor, client));
+namespace {
+
+// The tag of a protobuf::MessageBatch's entries: their field number and the length-delimited wire
+// type.
+const uint32_t kMessageBatchTag((protobuf::MessageBatch::kMessagesFieldNumber << 3) | 2);
+
+void AppendVarint(uint32_t value, std::string& output) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(const std::string& input, size_t& position, uint32_t& value) {
+  value = 0;
+  for (int shift(0); shift < 32 && position < input.size(); shift += 7) {
+    const uint8_t kByte(static_cast<uint8_t>(input[position++]));
+    value |= static_cast<uint32_t>(kByte & 0x7F) << shift;
+    if ((kByte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+bool IsMessageBatch(const std::string& serialised) {
+  size_t position(0);
+  uint32_t tag(0);
+  return ReadVarint(serialised, position, tag) && tag == kMessageBatchTag;
+}
+
+}  // unnamed namespace
+
+int AddToRudp(Network& network, const RoutingConfig& config, const NodeId& this_node_id,
+              const NodeId& this_connection_id, const NodeId& peer_id,
+              const NodeId& peer_connection_id, rudp::EndpointPair peer_endpoint_pair,
+              bool requestor, bool client, const std::vector<int32_t>& coordinates) {
+  protobuf::Message connect_success(rpcs::ConnectSuccess(config, peer_id, this_node_id,
+                                                         this_connection_id, requestor, client,
+                                                         coordinates));
   int result =
       network.Add(peer_connection_id, peer_endpoint_pair, connect_success.SerializeAsString());
   if (result == rudp::kConnectionAlreadyExists) {
@@ -65,7 +100,8 @@ int AddToRudp(Network& network, const NodeId& this_node_id, const NodeId& this_c
 bool ValidateAndAddToRoutingTable(Network& network, RoutingTable& routing_table,
                                   ClientRoutingTable& client_routing_table,
                                   const NodeId& peer_id, const NodeId& connection_id,
-                                  const asymm::PublicKey& public_key, bool client) {
+                                  const asymm::PublicKey& public_key, bool client,
+                                  const std::vector<int32_t>& coordinates) {
   if (network.MarkConnectionAsValid(connection_id) != kSuccess) {
     LOG(kError) << "[" << routing_table.kNodeId()
                 << "]  Rudp failed to validate connection with  Peer id : " << peer_id
@@ -77,11 +113,12 @@ bool ValidateAndAddToRoutingTable(Network& network, RoutingTable& routing_table,
   peer.id = peer_id;
   peer.public_key = public_key;
   peer.connection_id = connection_id;
+  peer.dimension_list = coordinates;
   bool routing_accepted_node(false);
   if (client) {
     NodeId furthest_close_node_id =
         routing_table.GetNthClosestNode(NodeId(routing_table.kNodeId()),
-                                        2 * Parameters::closest_nodes_size).id;
+                                        2 * routing_table.config().closest_nodes_size).id;
 
     if (client_routing_table.AddNode(peer, furthest_close_node_id))
       routing_accepted_node = true;
@@ -181,7 +218,7 @@ bool ValidateMessage(const protobuf::Message& message) {
     for (const auto& route : message.route_history())
       route_history += HexSubstr(route) + ", ";
     LOG(kError) << "Message has traversed more hops than expected. "
-                << Parameters::max_route_history
+                << message.route_history_size()
                 << " last hops in route history are: " << route_history
                 << " \nMessage source: " << HexSubstr(message.source_id())
                 << ", \nMessage destination: " << HexSubstr(message.destination_id())
@@ -407,6 +444,52 @@ GroupToGroupMessage CreateGroupToGroupMessage(const protobuf::Message& proto_mes
                              static_cast<Cacheable>(proto_message.cacheable()));
 }
 
+std::shared_ptr<protobuf::Message> ParseReceivedMessage(const std::string& serialised) {
+  auto message(std::make_shared<protobuf::Message>());
+  if (!message->ParseFromString(serialised))
+    return nullptr;
+  return message;
+}
+
+std::vector<std::shared_ptr<protobuf::Message>> ParseReceivedMessages(
+    const std::string& serialised) {
+  std::vector<std::shared_ptr<protobuf::Message>> messages;
+  if (!IsMessageBatch(serialised)) {
+    auto message(ParseReceivedMessage(serialised));
+    if (message)
+      messages.push_back(message);
+    return messages;
+  }
+
+  // Each entry is parsed where it lies in the batch rather than being copied out first.
+  size_t position(0);
+  uint32_t tag(0), size(0);
+  while (position < serialised.size()) {
+    if (!ReadVarint(serialised, position, tag) || tag != kMessageBatchTag ||
+        !ReadVarint(serialised, position, size) || size > serialised.size() - position) {
+      LOG(kWarning) << "Message batch is malformed; dropping the rest of it.";
+      break;
+    }
+    auto message(std::make_shared<protobuf::Message>());
+    if (message->ParseFromArray(serialised.data() + position, static_cast<int>(size)))
+      messages.push_back(message);
+    else
+      LOG(kWarning) << "Message in batch failed to parse.";
+    position += size;
+  }
+  return messages;
+}
+
+void AppendToMessageBatch(const std::string& serialised, std::string& batch) {
+  AppendToMessageBatch(serialised, std::string(), batch);
+}
+
+void AppendToMessageBatch(const std::string& head, const std::string& tail, std::string& batch) {
+  AppendVarint(kMessageBatchTag, batch);
+  AppendVarint(static_cast<uint32_t>(head.size() + tail.size()), batch);
+  batch.append(head).append(tail);
+}
+
 SingleToGroupRelayMessage CreateSingleToGroupRelayMessage(const protobuf::Message& proto_message) {
   SingleSource single_src(NodeId(proto_message.relay_id()));
   NodeId connection_id(proto_message.relay_connection_id());
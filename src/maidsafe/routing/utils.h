@@ -19,11 +19,13 @@
 #ifndef MAIDSAFE_ROUTING_UTILS_H_
 #define MAIDSAFE_ROUTING_UTILS_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "boost/asio/ip/udp.hpp"
 
+#include "maidsafe/common/error.h"
 #include "maidsafe/common/rsa.h"
 #include "maidsafe/common/node_id.h"
 
@@ -36,6 +38,7 @@
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/public_key_holder.h"
+#include "maidsafe/routing/routing_config.h"
 
 namespace maidsafe {
 
@@ -52,13 +55,17 @@ class Network;
 class ClientRoutingTable;
 class RoutingTable;
 
-int AddToRudp(Network& network, const NodeId& this_node_id, const NodeId& this_connection_id,
-              const NodeId& peer_id, const NodeId& peer_connection_id,
-              rudp::EndpointPair peer_endpoint_pair, bool requestor, bool client);
+int AddToRudp(Network& network, const RoutingConfig& config, const NodeId& this_node_id,
+              const NodeId& this_connection_id, const NodeId& peer_id,
+              const NodeId& peer_connection_id, rudp::EndpointPair peer_endpoint_pair,
+              bool requestor, bool client,
+              const std::vector<int32_t>& coordinates = std::vector<int32_t>());
 
+// 'coordinates' is the network coordinate advertised by the peer, if any.
 bool ValidateAndAddToRoutingTable(Network& network, RoutingTable& routing_table,
     ClientRoutingTable& client_routing_table, const NodeId& peer_id, const NodeId& connection_id,
-    const asymm::PublicKey& public_key, bool client);
+    const asymm::PublicKey& public_key, bool client,
+    const std::vector<int32_t>& coordinates = std::vector<int32_t>());
 
 void InformClientOfNewCloseNode(Network& network, const NodeInfo& client,
                                 const NodeInfo& new_close_node, const NodeId& this_node_id);
@@ -98,6 +105,33 @@ SingleToGroupMessage CreateSingleToGroupMessage(const protobuf::Message& proto_m
 GroupToSingleMessage CreateGroupToSingleMessage(const protobuf::Message& proto_message);
 GroupToGroupMessage CreateGroupToGroupMessage(const protobuf::Message& proto_message);
 SingleToGroupRelayMessage CreateSingleToGroupRelayMessage(const protobuf::Message& proto_message);
+// Parses a message straight from rudp's receive buffer, so that the buffer need not be copied to
+// be handed to another thread.  Returns null if 'serialised' does not parse.
+std::shared_ptr<protobuf::Message> ParseReceivedMessage(const std::string& serialised);
+// As above, but 'serialised' may also be a protobuf::MessageBatch, in which case each of its
+// messages which parses is returned, in order.
+std::vector<std::shared_ptr<protobuf::Message>> ParseReceivedMessages(
+    const std::string& serialised);
+// Appends 'serialised' to 'batch' as one entry of a protobuf::MessageBatch.
+void AppendToMessageBatch(const std::string& serialised, std::string& batch);
+// As above, for a message serialised in two parts, 'head' followed by 'tail'.
+void AppendToMessageBatch(const std::string& head, const std::string& tail, std::string& batch);
+
+// Creates a typed message using 'create', moving the payload out of 'proto_message' rather than
+// copying it.  'proto_message' is left with an empty payload.  Throws with
+// CommonErrors::parsing_error if 'proto_message' has no payload.
+template <typename TypedMessage>
+TypedMessage TakeTypedMessage(protobuf::Message& proto_message,
+                              TypedMessage (*create)(const protobuf::Message&)) {
+  if (proto_message.data_size() == 0)
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  std::string contents;
+  contents.swap(*proto_message.mutable_data(0));
+  TypedMessage typed_message(create(proto_message));
+  typed_message.contents.swap(contents);
+  return typed_message;
+}
+
 }  // namespace routing
 
 }  // namespace maidsafe